@@ -238,11 +238,34 @@ FSoundChan *SoundEngine::GetChannel(void *syschan)
 
 void SoundEngine::ReturnChannel(FSoundChan *chan)
 {
+	CountChannel(chan, -1);
 	UnlinkChannel(chan);
 	memset(chan, 0, sizeof(*chan));
 	LinkChannel(chan, &FreeChannels);
 }
 
+//==========================================================================
+//
+// S_CountChannel
+//
+// Keeps the per-sound channel counters in sync. Every channel holding
+// a sound must be tracked once after its sound IDs are set.
+//
+//==========================================================================
+
+void SoundEngine::CountChannel(FSoundChan *chan, int delta)
+{
+	auto count = [=](TMap<int, int> &counts, FSoundID id)
+	{
+		if (id.index() <= 0) return;
+		int &c = counts[id.index()];
+		c = max(c + delta, 0);
+		if (c == 0) counts.Remove(id.index());
+	};
+	count(SoundChannelCount, chan->SoundID);
+	count(OrgChannelCount, chan->OrgID);
+}
+
 //==========================================================================
 //
 // S_UnlinkChannel
@@ -612,6 +635,7 @@ FSoundChan *SoundEngine::StartSound(int type, const void *source,
 	{
 		chan->SoundID = sound_id;
 		chan->OrgID = org_id;
+		TrackChannel(chan);
 		chan->EntChannel = channel;
 		chan->Volume = float(volume);
 		chan->ChanFlags |= chanflags;
@@ -797,14 +821,7 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 
 bool SoundEngine::CheckSingular(FSoundID sound_id)
 {
-	for (FSoundChan *chan = Channels; chan != NULL; chan = chan->NextChan)
-	{
-		if (chan->OrgID == sound_id)
-		{
-			return true;
-		}
-	}
-	return false;
+	return OrgChannelCount.CheckKey(sound_id.index()) != nullptr;
 }
 
 //==========================================================================
@@ -830,6 +847,13 @@ bool SoundEngine::CheckSoundLimit(sfxinfo_t *sfx, const FVector3 &pos, int near_
 	FSoundChan *chan;
 	int count;
 
+	// Not enough copies of this sound exist to reach the limit, no matter where they are.
+	int *numchannels = SoundChannelCount.CheckKey(int(sfx - &S_sfx[0]));
+	if (numchannels == nullptr || *numchannels < near_limit)
+	{
+		return false;
+	}
+
 	for (chan = Channels, count = 0; chan != NULL && count < near_limit; chan = chan->NextChan)
 	{
 		if (chan->ChanFlags & CHANF_FORGETTABLE) continue;
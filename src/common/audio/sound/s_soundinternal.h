@@ -190,6 +190,11 @@ protected:
 	FSoundChan* Channels = nullptr;
 	FSoundChan* FreeChannels = nullptr;
 
+	// Number of channels in the active list per sound, so that the sound limit
+	// and singular checks only need to look at the channel list when it matters.
+	TMap<int, int> SoundChannelCount;
+	TMap<int, int> OrgChannelCount;
+
 	// the complete set of sound effects
 	TArray<sfxinfo_t> S_sfx;
 	FRolloffInfo S_Rolloff{};
@@ -204,6 +209,7 @@ private:
 	void UnlinkChannel(FSoundChan* chan);
 	void ReturnChannel(FSoundChan* chan);
 	void RestartChannel(FSoundChan* chan);
+	void CountChannel(FSoundChan* chan, int delta);
 	void RestoreEvictedChannel(FSoundChan* chan);
 
 	bool IsChannelUsed(int sourcetype, const void* actor, int channel, int* seen);
@@ -271,6 +277,7 @@ public:
 	void SetVolume(FSoundChan* chan, float vol);
 
 	FSoundChan* GetChannel(void* syschan);
+	void TrackChannel(FSoundChan* chan) { CountChannel(chan, 1); }
 	void RestoreEvictedChannels();
 	void CalcPosVel(FSoundChan* chan, FVector3* pos, FVector3* vel);
 
@@ -44,6 +44,7 @@
 #include <errno.h>
 #include "c_console.h"
 #include "c_dispatch.h"
+#include "c_cvars.h"
 #include "engineerrors.h"
 #include "printf.h"
 #include "files.h"
@@ -55,6 +56,7 @@
 #include "i_specialpaths.h"
 #include "i_system.h"
 #include "cmdlib.h"
+#include "stats.h"
 
 extern FILE* Logfile;
 
@@ -249,6 +251,45 @@ CCMD (wdir)
 	}
 }
 
+//==========================================================================
+//
+// Decompressed lump cache
+//
+//==========================================================================
+
+CUSTOM_CVAR(Int, fs_lumpcachesize, 32, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// in MB
+{
+	if (self < 0) self = 0;
+	else if (self > 1024) self = 1024;
+	else FileSys::SetLumpCacheBudget(size_t(self) << 20);
+}
+
+static FString LumpCacheInfo()
+{
+	auto stats = FileSys::GetLumpCacheStats();
+	uint64_t lookups = stats.Hits + stats.Misses;
+	FString out;
+	out.Format("Lump cache: %zu lumps, %zuK of %zuK  Hits: %llu (%.1f%%)  Misses: %llu  Evicted: %llu (%lluK)",
+		stats.Entries, stats.Used >> 10, stats.Budget >> 10,
+		(unsigned long long)stats.Hits, lookups ? stats.Hits * 100. / lookups : 0.,
+		(unsigned long long)stats.Misses, (unsigned long long)stats.Evictions, (unsigned long long)(stats.EvictedBytes >> 10));
+	return out;
+}
+
+ADD_STAT(lumpcache)
+{
+	return LumpCacheInfo();
+}
+
+CCMD(lumpcache)
+{
+	if (argv.argc() > 1 && !stricmp(argv[1], "clear"))
+	{
+		FileSys::ClearLumpCache();
+	}
+	Printf("%s\n", LumpCacheInfo().GetChars());
+}
+
 //==========================================================================
 //
 // CCMD md5sum
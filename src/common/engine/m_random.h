@@ -172,6 +172,19 @@ public:
 	static void StaticWriteRNGState (FSerializer &file);
 	static FRandom *StaticFindRNG(const char *name);
 
+	// Calls func(namecrc, index, value) for every named RNG, in the same order on every machine.
+	template<class Func> static void StaticIterateSeeds(Func func)
+	{
+		for (FRandom *rng = RNGList; rng != nullptr; rng = rng->Next)
+		{
+			if (rng->NameCRC != 0)
+			{
+				int i = rng->idx < SFMT::N32 ? rng->idx : 0;
+				func(rng->NameCRC, rng->idx, rng->sfmt.u[i]);
+			}
+		}
+	}
+
 #ifndef NDEBUG
 	static void StaticPrintSeeds ();
 #endif
@@ -124,12 +124,12 @@ const char *UnicodeToString(const char *cc)
 //
 //==========================================================================
 
-bool FSerializer::OpenWriter(bool pretty)
+bool FSerializer::OpenWriter(bool pretty, bool binary)
 {
 	if (w != nullptr || r != nullptr) return false;
 
 	mErrors = 0;
-	w = new FWriter(pretty);
+	w = new FWriter(pretty, binary);
 	BeginObject(nullptr);
 	return true;
 }
@@ -745,25 +745,19 @@ const char *FSerializer::GetOutput(unsigned *len)
 //
 //==========================================================================
 
-FCompressedBuffer FSerializer::GetCompressedOutput()
+// Deflates the data into a newly allocated buffer in zip-compatible form.
+// Leaves 'buff' alone if the data could not be compressed.
+static bool DeflateOutput(const char *data, size_t size, FCompressedBuffer &buff)
 {
-	if (isReading()) return{ 0,0,0,0,0,nullptr };
-	FCompressedBuffer buff;
-	WriteObjects();
-	EndObject();
-	buff.filename = nullptr;
-	buff.mSize = (unsigned)w->mOutString.GetSize();
-	buff.mCRC32 = crc32(0, (const Bytef*)w->mOutString.GetString(), buff.mSize);
-
-	uint8_t *compressbuf = new uint8_t[buff.mSize+1];
+	uint8_t *compressbuf = new uint8_t[size+1];
 
 	z_stream stream;
 	int err;
 
-	stream.next_in = (Bytef *)w->mOutString.GetString();
-	stream.avail_in = (unsigned)buff.mSize;
+	stream.next_in = (Bytef *)data;
+	stream.avail_in = (unsigned)size;
 	stream.next_out = (Bytef*)compressbuf;
-	stream.avail_out = (unsigned)buff.mSize;
+	stream.avail_out = (unsigned)size;
 	stream.zalloc = (alloc_func)0;
 	stream.zfree = (free_func)0;
 	stream.opaque = (voidpf)0;
@@ -772,34 +766,94 @@ FCompressedBuffer FSerializer::GetCompressedOutput()
 	err = deflateInit2(&stream, 8, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY);
 	if (err != Z_OK)
 	{
-		goto error;
+		delete[] compressbuf;
+		return false;
 	}
 
 	err = deflate(&stream, Z_FINISH);
 	if (err != Z_STREAM_END) 
 	{
 		deflateEnd(&stream);
-		goto error;
+		delete[] compressbuf;
+		return false;
 	}
-	buff.mCompressedSize = stream.total_out;
 
 	err = deflateEnd(&stream);
-	if (err == Z_OK)
+	if (err != Z_OK)
 	{
-		buff.mBuffer = new char[buff.mCompressedSize];
-		buff.mMethod = METHOD_DEFLATE;
-		memcpy(buff.mBuffer, compressbuf, buff.mCompressedSize);
 		delete[] compressbuf;
-		return buff;
+		return false;
 	}
+	buff.mCompressedSize = stream.total_out;
+	buff.mBuffer = new char[buff.mCompressedSize];
+	buff.mMethod = METHOD_DEFLATE;
+	memcpy(buff.mBuffer, compressbuf, buff.mCompressedSize);
+	delete[] compressbuf;
+	return true;
+}
 
-error:
-	memcpy(compressbuf, w->mOutString.GetString(), buff.mSize + 1);
-	buff.mCompressedSize = buff.mSize;
+FCompressedBuffer FSerializer::GetCompressedOutput()
+{
+	if (isReading()) return{ 0,0,0,0,0,nullptr };
+	FCompressedBuffer buff;
+	WriteObjects();
+	EndObject();
+	buff.filename = nullptr;
+	buff.mSize = (unsigned)w->mOutString.GetSize();
+	buff.mCRC32 = crc32(0, (const Bytef*)w->mOutString.GetString(), buff.mSize);
+
+	if (!DeflateOutput(w->mOutString.GetString(), buff.mSize, buff))
+	{
+		buff.mBuffer = new char[buff.mSize + 1];
+		memcpy(buff.mBuffer, w->mOutString.GetString(), buff.mSize + 1);
+		buff.mCompressedSize = buff.mSize;
+		buff.mMethod = METHOD_STORED;
+	}
+	return buff;
+}
+
+//==========================================================================
+//
+// Returns the output without compressing it. The CRC is left for
+// CompressOutput to calculate, so that the expensive parts of creating
+// the buffer can be done later, or on another thread.
+//
+//==========================================================================
+
+FCompressedBuffer FSerializer::GetStoredOutput()
+{
+	if (isReading()) return{ 0,0,0,0,0,nullptr };
+	FCompressedBuffer buff;
+	WriteObjects();
+	EndObject();
+	buff.filename = nullptr;
+	buff.mSize = buff.mCompressedSize = (unsigned)w->mOutString.GetSize();
+	buff.mCRC32 = 0;
 	buff.mMethod = METHOD_STORED;
+	buff.mBuffer = new char[buff.mSize + 1];
+	memcpy(buff.mBuffer, w->mOutString.GetString(), buff.mSize + 1);
 	return buff;
 }
 
+//==========================================================================
+//
+// Finishes a buffer returned by GetStoredOutput. This does not access
+// any serializer state and is safe to call from any thread.
+//
+//==========================================================================
+
+void FSerializer::CompressOutput(FCompressedBuffer &buff)
+{
+	if (buff.mMethod != METHOD_STORED || buff.mBuffer == nullptr) return;
+
+	buff.mCRC32 = crc32(0, (const Bytef*)buff.mBuffer, (unsigned)buff.mSize);
+	char *stored = buff.mBuffer;
+	if (DeflateOutput(stored, buff.mSize, buff))
+	{
+		delete[] stored;
+	}
+}
+
 //==========================================================================
 //
 //
@@ -25,6 +25,278 @@ struct FJSONObject
 	}
 };
 
+//==========================================================================
+//
+// Binary encoding of the JSON structure, for savegames and hub snapshots
+// where readability does not matter. The writer records the same events
+// the JSON writer gets, with key names interned, integers as varints and
+// doubles stored raw. The reader replays them into a RapidJSON document,
+// so reading works exactly like with JSON text, minus the parsing.
+//
+//==========================================================================
+
+enum EBinaryJSONTag : uint8_t
+{
+	BJ_Null,
+	BJ_False,
+	BJ_True,
+	BJ_Int,
+	BJ_Uint,
+	BJ_Int64,
+	BJ_Uint64,
+	BJ_Double,
+	BJ_String,
+	BJ_StartObject,
+	BJ_EndObject,
+	BJ_StartArray,
+	BJ_EndArray,
+	BJ_NewKey,		// followed by the key name, which gets the next key index
+	BJ_Key,			// followed by the index of a previously defined key
+};
+
+// JSON text cannot start with a 0 byte.
+static const char BinaryJSONMagic[4] = { 0, 'B', 'J', '1' };
+
+class FBinaryJSONWriter
+{
+	rapidjson::StringBuffer &mOut;
+	TArray<FString> mKeyNames;
+	TMap<FString, unsigned> mKeys;
+	TMap<const char *, unsigned> mKeyPointers;	// most keys are literals, so this avoids hashing their content.
+
+	void Tag(EBinaryJSONTag tag)
+	{
+		mOut.Put((char)tag);
+	}
+
+	void VarUint(uint64_t v)
+	{
+		while (v >= 0x80)
+		{
+			mOut.Put(char(v | 0x80));
+			v >>= 7;
+		}
+		mOut.Put(char(v));
+	}
+
+	void VarInt(int64_t v)
+	{
+		VarUint((uint64_t(v) << 1) ^ uint64_t(v >> 63));
+	}
+
+	void Bytes(const char *s, size_t len)
+	{
+		VarUint(len);
+		if (len > 0) memcpy(mOut.Push(len), s, len);
+	}
+
+public:
+	FBinaryJSONWriter(rapidjson::StringBuffer &out) : mOut(out)
+	{
+		memcpy(mOut.Push(sizeof(BinaryJSONMagic)), BinaryJSONMagic, sizeof(BinaryJSONMagic));
+	}
+
+	void StartObject() { Tag(BJ_StartObject); }
+	void EndObject() { Tag(BJ_EndObject); }
+	void StartArray() { Tag(BJ_StartArray); }
+	void EndArray() { Tag(BJ_EndArray); }
+	void Null() { Tag(BJ_Null); }
+	void Bool(bool b) { Tag(b ? BJ_True : BJ_False); }
+	void Int(int32_t i) { Tag(BJ_Int); VarInt(i); }
+	void Int64(int64_t i) { Tag(BJ_Int64); VarInt(i); }
+	void Uint(uint32_t u) { Tag(BJ_Uint); VarUint(u); }
+	void Uint64(uint64_t u) { Tag(BJ_Uint64); VarUint(u); }
+
+	void Double(double d)
+	{
+		uint64_t bits;
+		memcpy(&bits, &d, sizeof(bits));
+		Tag(BJ_Double);
+		char *p = mOut.Push(8);
+		for (int i = 0; i < 8; i++) p[i] = char(bits >> (i * 8));
+	}
+
+	void String(const char *str)
+	{
+		Tag(BJ_String);
+		Bytes(str, strlen(str));
+	}
+
+	void Key(const char *key)
+	{
+		unsigned *index = mKeyPointers.CheckKey(key);
+		if (index == nullptr || mKeyNames[*index].Compare(key) != 0)
+		{
+			index = mKeys.CheckKey(key);
+			if (index == nullptr)
+			{
+				unsigned newindex = mKeyNames.Push(key);
+				mKeys.Insert(key, newindex);
+				mKeyPointers.Insert(key, newindex);
+				Tag(BJ_NewKey);
+				Bytes(key, mKeyNames[newindex].Len());
+				return;
+			}
+			mKeyPointers.Insert(key, *index);
+		}
+		Tag(BJ_Key);
+		VarUint(*index);
+	}
+};
+
+class FBinaryJSONReader
+{
+	const uint8_t *mPos;
+	const uint8_t *mEnd;
+	TArray<std::pair<const char *, unsigned>> mKeys;
+
+	bool VarUint(uint64_t &v)
+	{
+		v = 0;
+		for (int shift = 0; shift < 64 && mPos < mEnd; shift += 7)
+		{
+			uint8_t b = *mPos++;
+			v |= uint64_t(b & 0x7f) << shift;
+			if (!(b & 0x80)) return true;
+		}
+		return false;
+	}
+
+	bool VarInt(int64_t &v)
+	{
+		uint64_t u;
+		if (!VarUint(u)) return false;
+		v = int64_t(u >> 1) ^ -int64_t(u & 1);
+		return true;
+	}
+
+	bool Bytes(const char *&s, unsigned &len)
+	{
+		uint64_t l;
+		if (!VarUint(l) || l > uint64_t(mEnd - mPos)) return false;
+		s = (const char *)mPos;
+		len = (unsigned)l;
+		mPos += l;
+		return true;
+	}
+
+public:
+	FBinaryJSONReader(const char *buffer, size_t length)
+	{
+		mPos = (const uint8_t *)buffer + sizeof(BinaryJSONMagic);
+		mEnd = (const uint8_t *)buffer + length;
+	}
+
+	static bool IsBinary(const char *buffer, size_t length)
+	{
+		return length >= sizeof(BinaryJSONMagic) && !memcmp(buffer, BinaryJSONMagic, sizeof(BinaryJSONMagic));
+	}
+
+	// Generator for rapidjson::Document::Populate.
+	template<class Handler> bool operator()(Handler &handler)
+	{
+		// Documents need the member and element counts when closing containers.
+		TArray<unsigned> counts;
+		TArray<bool> inobject;
+
+		while (mPos < mEnd)
+		{
+			auto tag = *mPos++;
+			if (tag != BJ_EndObject && tag != BJ_EndArray && tag != BJ_NewKey && tag != BJ_Key && counts.Size() > 0 && !inobject.Last())
+			{
+				counts.Last()++;
+			}
+
+			bool ok;
+			uint64_t u;
+			int64_t i;
+			const char *str;
+			unsigned len;
+
+			switch (tag)
+			{
+			case BJ_Null:
+				ok = handler.Null();
+				break;
+
+			case BJ_False:
+			case BJ_True:
+				ok = handler.Bool(tag == BJ_True);
+				break;
+
+			case BJ_Int:
+				ok = VarInt(i) && handler.Int(int(i));
+				break;
+
+			case BJ_Uint:
+				ok = VarUint(u) && handler.Uint(unsigned(u));
+				break;
+
+			case BJ_Int64:
+				ok = VarInt(i) && handler.Int64(i);
+				break;
+
+			case BJ_Uint64:
+				ok = VarUint(u) && handler.Uint64(u);
+				break;
+
+			case BJ_Double:
+			{
+				if (mEnd - mPos < 8) return false;
+				u = 0;
+				for (int b = 0; b < 8; b++) u |= uint64_t(mPos[b]) << (b * 8);
+				mPos += 8;
+				double d;
+				memcpy(&d, &u, sizeof(d));
+				ok = handler.Double(d);
+				break;
+			}
+
+			case BJ_String:
+				ok = Bytes(str, len) && handler.String(str, len, true);
+				break;
+
+			case BJ_StartObject:
+			case BJ_StartArray:
+				counts.Push(0);
+				inobject.Push(tag == BJ_StartObject);
+				ok = tag == BJ_StartObject ? handler.StartObject() : handler.StartArray();
+				break;
+
+			case BJ_EndObject:
+			case BJ_EndArray:
+			{
+				if (counts.Size() == 0 || inobject.Last() != (tag == BJ_EndObject)) return false;
+				unsigned count = counts.Last();
+				counts.Pop();
+				inobject.Pop();
+				ok = tag == BJ_EndObject ? handler.EndObject(count) : handler.EndArray(count);
+				if (ok && counts.Size() == 0) return true;	// the root is complete.
+				break;
+			}
+
+			case BJ_NewKey:
+				if (counts.Size() == 0 || !inobject.Last() || !Bytes(str, len)) return false;
+				mKeys.Push(std::make_pair(str, len));
+				counts.Last()++;
+				ok = handler.Key(str, len, true);
+				break;
+
+			case BJ_Key:
+				if (counts.Size() == 0 || !inobject.Last() || !VarUint(u) || u >= mKeys.Size()) return false;
+				counts.Last()++;
+				ok = handler.Key(mKeys[u].first, mKeys[u].second, true);
+				break;
+
+			default:
+				return false;
+			}
+			if (!ok) return false;
+		}
+		return false;
+	}
+};
+
 //==========================================================================
 //
 // some wrapper stuff to keep the RapidJSON dependencies out of the global headers.
@@ -39,21 +311,27 @@ struct FWriter
 
 	Writer *mWriter1;
 	PrettyWriter *mWriter2;
+	FBinaryJSONWriter *mWriter3;
 	TArray<bool> mInObject;
 	rapidjson::StringBuffer mOutString;
 	TArray<DObject *> mDObjects;
 	TMap<DObject *, int> mObjectMap;
 
-	FWriter(bool pretty)
+	FWriter(bool pretty, bool binary)
 	{
-		if (!pretty)
+		mWriter1 = nullptr;
+		mWriter2 = nullptr;
+		mWriter3 = nullptr;
+		if (binary)
+		{
+			mWriter3 = new FBinaryJSONWriter(mOutString);
+		}
+		else if (!pretty)
 		{
 			mWriter1 = new Writer(mOutString);
-			mWriter2 = nullptr;
 		}
 		else
 		{
-			mWriter1 = nullptr;
 			mWriter2 = new PrettyWriter(mOutString);
 		}
 	}
@@ -62,6 +340,7 @@ struct FWriter
 	{
 		if (mWriter1) delete mWriter1;
 		if (mWriter2) delete mWriter2;
+		if (mWriter3) delete mWriter3;
 	}
 
 
@@ -74,36 +353,42 @@ struct FWriter
 	{
 		if (mWriter1) mWriter1->StartObject();
 		else if (mWriter2) mWriter2->StartObject();
+		else if (mWriter3) mWriter3->StartObject();
 	}
 
 	void EndObject()
 	{
 		if (mWriter1) mWriter1->EndObject();
 		else if (mWriter2) mWriter2->EndObject();
+		else if (mWriter3) mWriter3->EndObject();
 	}
 
 	void StartArray()
 	{
 		if (mWriter1) mWriter1->StartArray();
 		else if (mWriter2) mWriter2->StartArray();
+		else if (mWriter3) mWriter3->StartArray();
 	}
 
 	void EndArray()
 	{
 		if (mWriter1) mWriter1->EndArray();
 		else if (mWriter2) mWriter2->EndArray();
+		else if (mWriter3) mWriter3->EndArray();
 	}
 
 	void Key(const char *k)
 	{
 		if (mWriter1) mWriter1->Key(k);
 		else if (mWriter2) mWriter2->Key(k);
+		else if (mWriter3) mWriter3->Key(k);
 	}
 
 	void Null()
 	{
 		if (mWriter1) mWriter1->Null();
 		else if (mWriter2) mWriter2->Null();
+		else if (mWriter3) mWriter3->Null();
 	}
 
 	void StringU(const char *k, bool encode)
@@ -111,6 +396,7 @@ struct FWriter
 		if (encode) k = StringToUnicode(k);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k);
 	}
 
 	void String(const char *k)
@@ -118,6 +404,7 @@ struct FWriter
 		k = StringToUnicode(k);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k);
 	}
 
 	void String(const char *k, int size)
@@ -125,36 +412,42 @@ struct FWriter
 		k = StringToUnicode(k, size);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k);
 	}
 
 	void Bool(bool k)
 	{
 		if (mWriter1) mWriter1->Bool(k);
 		else if (mWriter2) mWriter2->Bool(k);
+		else if (mWriter3) mWriter3->Bool(k);
 	}
 
 	void Int(int32_t k)
 	{
 		if (mWriter1) mWriter1->Int(k);
 		else if (mWriter2) mWriter2->Int(k);
+		else if (mWriter3) mWriter3->Int(k);
 	}
 
 	void Int64(int64_t k)
 	{
 		if (mWriter1) mWriter1->Int64(k);
 		else if (mWriter2) mWriter2->Int64(k);
+		else if (mWriter3) mWriter3->Int64(k);
 	}
 
 	void Uint(uint32_t k)
 	{
 		if (mWriter1) mWriter1->Uint(k);
 		else if (mWriter2) mWriter2->Uint(k);
+		else if (mWriter3) mWriter3->Uint(k);
 	}
 
 	void Uint64(int64_t k)
 	{
 		if (mWriter1) mWriter1->Uint64(k);
 		else if (mWriter2) mWriter2->Uint64(k);
+		else if (mWriter3) mWriter3->Uint64(k);
 	}
 
 	void Double(double k)
@@ -167,6 +460,10 @@ struct FWriter
 		{
 			mWriter2->Double(k);
 		}
+		else if (mWriter3)
+		{
+			mWriter3->Double(k);
+		}
 	}
 
 };
@@ -187,7 +484,15 @@ struct FReader
 
 	FReader(const char *buffer, size_t length)
 	{
-		mDoc.Parse(buffer, length);
+		if (FBinaryJSONReader::IsBinary(buffer, length))
+		{
+			FBinaryJSONReader reader(buffer, length);
+			mDoc.Populate(reader);
+		}
+		else
+		{
+			mDoc.Parse(buffer, length);
+		}
 		mObjects.Push(FJSONObject(&mDoc));
 	}
 
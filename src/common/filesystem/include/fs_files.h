@@ -247,6 +247,7 @@ public:
 	}
 
 	bool OpenFile(const char *filename, Size start = 0, Size length = -1, bool buffered = false);
+	bool OpenMappedFile(const char *filename);	// maps the entire file into memory. Fails if the system cannot do that.
 	bool OpenFilePart(FileReader &parent, Size start, Size length);
 	bool OpenMemory(const void *mem, Size length);	// read directly from the buffer
 	bool OpenMemoryArray(FileData& data);	// take the given array
@@ -410,6 +411,7 @@ public:
 
 	BufferWriter() {}
 	virtual size_t Write(const void *buffer, size_t len) override;
+	virtual ptrdiff_t Tell() override { return (ptrdiff_t)mBuffer.size(); }
 	std::vector<unsigned char> *GetBuffer() { return &mBuffer; }
 	std::vector<unsigned char>&& TakeBuffer() { return std::move(mBuffer); }
 };
@@ -173,10 +173,15 @@ protected:
 	int MaxIwadIndex = -1;
 
 	StringPool* stringpool = nullptr;
+	int NextSkinNamespace = ns_firstskin;
 
 private:
+	struct PreparedFile;
+
 	void DeleteAll();
 	void MoveLumpsInFolder(const char *);
+	static void PrepareFile(PreparedFile &prep, const char* filename, FileReader* filer, LumpFilterInfo* filter, FileSystemMessageFunc Printf, bool hash, StringPool* sp);
+	void AddPreparedFile(PreparedFile &prep, LumpFilterInfo* filter, FileSystemMessageFunc Printf, FILE* hashfile);
 
 };
 
@@ -27,6 +27,7 @@ struct LumpFilterInfo
 	std::vector<std::string> blockednames;			// File names that will never be accepted (e.g. dehacked.exe for Doom)
 	std::function<bool(const char*, const char*)> filenamecheck;	// for scanning directories, this allows to eliminate unwanted content.
 	std::function<void()> postprocessFunc;
+	bool mapfiles = false;		// map resource files into memory so that stored entries can be accessed without copying them.
 };
 
 enum class FSMessageLevel
@@ -109,6 +110,22 @@ struct FResourceEntry
 
 void SetMainThread();
 
+// Recently used decompressed lumps are kept in memory, up to a given size.
+struct LumpCacheStats
+{
+	size_t Budget;
+	size_t Used;
+	size_t Entries;
+	uint64_t Hits;
+	uint64_t Misses;
+	uint64_t Evictions;
+	uint64_t EvictedBytes;
+};
+
+void SetLumpCacheBudget(size_t bytes);
+void ClearLumpCache();
+LumpCacheStats GetLumpCacheStats();
+
 class FResourceFile
 {
 public:
@@ -40,6 +40,7 @@
 #include "fs_findfile.h"
 #include "unicode.h"
 #include "critsec.h"
+#include "fs_lumpcache.h"
 #include <mutex>
 
 
@@ -175,6 +176,8 @@ class F7ZFile : public FResourceFile
 	C7zArchive *Archive;
 	FCriticalSection critsec;
 
+	FileData Extract(uint32_t entry);
+
 public:
 	F7ZFile(const char * filename, FileReader &filer, StringPool* sp);
 	bool Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf);
@@ -314,16 +317,35 @@ F7ZFile::~F7ZFile()
 //
 //==========================================================================
 
+FileData F7ZFile::Extract(uint32_t entry)
+{
+	FileData buffer;
+	auto p = buffer.allocate(Entries[entry].Length);
+	// There is no realistic way to keep multiple references to a 7z file open without massive overhead so to make this thread-safe a mutex is the only option.
+	std::lock_guard<FCriticalSection> lock(critsec);
+	SRes code = Archive->Extract((UInt32)Entries[entry].Position, (char*)p);
+	if (code != SZ_OK) buffer.clear();
+	return buffer;
+}
+
 FileData F7ZFile::Read(uint32_t entry)
 {
 	FileData buffer;
 	if (entry < NumLumps && Entries[entry].Length > 0)
 	{
-		auto p = buffer.allocate(Entries[entry].Length);
-		// There is no realistic way to keep multiple references to a 7z file open without massive overhead so to make this thread-safe a mutex is the only option.
-		std::lock_guard<FCriticalSection> lock(critsec);
-		SRes code = Archive->Extract((UInt32)Entries[entry].Position, (char*)p);
-		if (code != SZ_OK) buffer.clear();
+		// Extracting from a solid archive is slow so the lump cache is checked first.
+		FileReader cached;
+		bool cacheable = LumpCache_Accepts(Entries[entry].Length);
+		if (cacheable && LumpCache_Find(this, entry, cached))
+		{
+			return cached.Read(Entries[entry].Length);
+		}
+		buffer = Extract(entry);
+		if (cacheable && buffer.size() > 0)
+		{
+			FileData copy = buffer;
+			LumpCache_Insert(this, entry, copy);
+		}
 	}
 	return buffer;
 }
@@ -337,10 +359,18 @@ FileData F7ZFile::Read(uint32_t entry)
 FileReader F7ZFile::GetEntryReader(uint32_t entry, int, int)
 {
 	FileReader fr;
-	if (entry < 0 || entry >= NumLumps) return fr;
-	auto buffer = Read(entry);
+	if (entry < 0 || entry >= NumLumps || Entries[entry].Length == 0) return fr;
+	bool cacheable = LumpCache_Accepts(Entries[entry].Length);
+	if (cacheable && LumpCache_Find(this, entry, fr))
+	{
+		return fr;
+	}
+	auto buffer = Extract(entry);
 	if (buffer.size() > 0)
-		fr.OpenMemoryArray(buffer);
+	{
+		if (cacheable) fr = LumpCache_Insert(this, entry, buffer);
+		else fr.OpenMemoryArray(buffer);
+	}
 	return fr;
 }
 
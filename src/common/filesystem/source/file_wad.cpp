@@ -348,8 +348,8 @@ void FWadFile::SetNamespace(const char *startmarker, const char *endmarker, name
 
 void FWadFile::SkinHack (FileSystemMessageFunc Printf)
 {
-	// this being static is not a problem. The only relevant thing is that each skin gets a different number.
-	static int namespc = ns_firstskin;
+	// Wads may be opened on several threads at once, so every skin gets ns_firstskin here.
+	// FileSystem gives each skin its own number when the lumps get merged into the directory.
 	bool skinned = false;
 	bool hasmap = false;
 	uint32_t i;
@@ -368,9 +368,8 @@ void FWadFile::SkinHack (FileSystemMessageFunc Printf)
 
 				for (j = 0; j < NumLumps; j++)
 				{
-					Entries[j].Namespace = namespc;
+					Entries[j].Namespace = ns_firstskin;
 				}
-				namespc++;
 			}
 		}
 		// needless to say, this check is entirely useless these days as map names can be more diverse..
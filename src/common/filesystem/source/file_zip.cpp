@@ -363,8 +363,17 @@ void FZipFile::SetEntryAddress(uint32_t entry)
 	FZipLocalFileHeader localHeader;
 	int skiplen;
 
-	Reader.Seek(Entries[entry].Position, FileReader::SeekSet);
-	Reader.Read(&localHeader, sizeof(localHeader));
+	// With a mapped file the header can be taken directly from memory, which leaves the shared reader's position alone.
+	auto buf = Reader.GetBuffer();
+	if (buf != nullptr && Entries[entry].Position + sizeof(localHeader) <= (size_t)Reader.GetLength())
+	{
+		memcpy(&localHeader, buf + Entries[entry].Position, sizeof(localHeader));
+	}
+	else
+	{
+		Reader.Seek(Entries[entry].Position, FileReader::SeekSet);
+		Reader.Read(&localHeader, sizeof(localHeader));
+	}
 	skiplen = LittleShort(localHeader.NameLength) + LittleShort(localHeader.ExtraLength);
 	Entries[entry].Position += sizeof(localHeader) + skiplen;
 	Entries[entry].Flags &= ~RESFF_NEEDFILESTART;
@@ -38,8 +38,19 @@
 #include <algorithm>
 #include <assert.h>
 #include <string.h>
+#include <stdint.h>
 #include "files_internal.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 namespace FileSys {
 	
 #ifdef _WIN32
@@ -358,6 +369,76 @@ char* BufferingReader::Gets(char* strbuf, ptrdiff_t len)
 	return MemoryReader::Gets(strbuf, len);
 }
 
+//==========================================================================
+//
+// MappedFileReader
+//
+// reads from a file that has been mapped into memory. Resource files
+// using this reader hand out views into the mapping for all stored
+// entries instead of copying them.
+//
+// The mapping is copy-on-write so that code which modifies the data
+// it got from a view only changes its own private copy of the page.
+//
+//==========================================================================
+
+// A 32 bit process cannot afford to give its address space to large files.
+static const uint64_t MaxMappedSize = sizeof(void*) >= 8 ? UINT64_C(1) << 40 : 256 << 20;
+
+class MappedFileReader : public MemoryReader
+{
+public:
+	~MappedFileReader()
+	{
+		if (bufptr == nullptr) return;
+#ifdef _WIN32
+		UnmapViewOfFile(bufptr);
+#else
+		munmap((void*)bufptr, Length);
+#endif
+	}
+
+	bool Open(const char *filename)
+	{
+		void *mem = nullptr;
+		uint64_t size = 0;
+#ifdef _WIN32
+		auto widename = toWide(filename);
+		HANDLE file = CreateFileW(widename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER filesize;
+		if (GetFileSizeEx(file, &filesize) && filesize.QuadPart > 0 && (uint64_t)filesize.QuadPart <= MaxMappedSize)
+		{
+			size = filesize.QuadPart;
+			HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+			if (mapping != nullptr)
+			{
+				// The view keeps the mapping alive.
+				mem = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+#else
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && (uint64_t)st.st_size <= MaxMappedSize)
+		{
+			size = st.st_size;
+			mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			if (mem == MAP_FAILED) mem = nullptr;
+		}
+		close(fd);
+#endif
+		if (mem == nullptr) return false;
+		bufptr = (const char*)mem;
+		Length = (ptrdiff_t)size;
+		FilePos = 0;
+		return true;
+	}
+};
+
 //==========================================================================
 //
 // FileReader
@@ -380,6 +461,19 @@ bool FileReader::OpenFile(const char *filename, FileReader::Size start, FileRead
 	return true;
 }
 
+bool FileReader::OpenMappedFile(const char *filename)
+{
+	auto reader = new MappedFileReader;
+	if (!reader->Open(filename))
+	{
+		delete reader;
+		return false;
+	}
+	Close();
+	mReader = reader;
+	return true;
+}
+
 bool FileReader::OpenFilePart(FileReader &parent, FileReader::Size start, FileReader::Size length)
 {
 	auto reader = new FileReaderRedirect(parent, start, length);
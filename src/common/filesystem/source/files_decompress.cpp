@@ -251,7 +251,7 @@ public:
 //==========================================================================
 
 class DecompressorBZ2;
-static DecompressorBZ2 * stupidGlobal;	// Why does that dumb global error callback not pass the decompressor state?
+static thread_local DecompressorBZ2 * stupidGlobal;	// Why does that dumb global error callback not pass the decompressor state?
 										// Thanks to that brain-dead interface we have to use a global variable to get the error to the proper handler.
 
 class DecompressorBZ2 : public DecompressorBase
@@ -41,6 +41,11 @@
 #include <ctype.h>
 #include <string.h>
 #include <inttypes.h>
+#include <stdarg.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include "resourcefile.h"
 #include "fs_filesystem.h"
@@ -53,6 +58,7 @@ namespace FileSys {
 // MACROS ------------------------------------------------------------------
 
 #define NULL_INDEX		(0xffffffff)
+#define MAX_PREPARE_THREADS	((size_t)8)
 
 static void UpperCopy(char* to, const char* from)
 {
@@ -221,6 +227,140 @@ void FileSystem::DeleteAll ()
 	stringpool = nullptr;
 }
 
+//==========================================================================
+//
+// PrepareFile
+//
+// Opens a file and reads its directory. This does not touch the FileSystem
+// so it can run on a worker thread. Messages are passed to Printf which
+// for worker threads collects them for the main thread.
+//
+//==========================================================================
+
+struct FileSystem::PreparedFile
+{
+	std::string FileName;
+	FResourceFile* ResFile = nullptr;
+	std::vector<std::pair<FSMessageLevel, std::string>> Messages;
+	std::string HashLines;		// written to the hash file when the file gets merged
+	double IndexTime = 0;
+	double HashTime = 0;
+};
+
+static thread_local std::vector<std::pair<FSMessageLevel, std::string>>* CapturedMessages;
+
+static int CapturePrintf(FSMessageLevel level, const char* fmt, ...)
+{
+	char buffer[1024];
+	va_list ap;
+	va_start(ap, fmt);
+	int len = vsnprintf(buffer, sizeof(buffer), fmt, ap);
+	va_end(ap);
+	if (CapturedMessages) CapturedMessages->emplace_back(level, buffer);
+	return len;
+}
+
+static double MilliSecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void HashResourceFile(FResourceFile* resfile, const char* filename, std::string& out)
+{
+	uint8_t cksum[16];
+	char cksumout[33];
+	char line[1024];
+	memset(cksumout, 0, sizeof(cksumout));
+
+	auto filereader = resfile->GetContainerReader();
+	if (filereader != nullptr)
+	{
+		filereader->Seek(0, FileReader::SeekSet);
+		md5Hash(*filereader, cksum);
+
+		for (size_t j = 0; j < sizeof(cksum); ++j)
+		{
+			snprintf(cksumout + (j * 2), 3, "%02X", cksum[j]);
+		}
+
+		snprintf(line, sizeof(line), "file: %s, hash: %s, size: %td\n", filename, cksumout, filereader->GetLength());
+	}
+
+	else
+		snprintf(line, sizeof(line), "file: %s, Directory structure\n", filename);
+	out += line;
+
+	for (int i = 0; i < resfile->EntryCount(); i++)
+	{
+		int flags = resfile->GetEntryFlags(i);
+		if (!(flags & RESFF_EMBEDDED))
+		{
+			auto reader = resfile->GetEntryReader(i, READER_SHARED, 0);
+			md5Hash(reader, cksum);
+
+			for (size_t j = 0; j < sizeof(cksum); ++j)
+			{
+				snprintf(cksumout + (j * 2), 3, "%02X", cksum[j]);
+			}
+
+			snprintf(line, sizeof(line), "file: %s, lump: %s, hash: %s, size: %zu\n", filename, resfile->getName(i), cksumout, (size_t)resfile->Length(i));
+			out += line;
+		}
+	}
+}
+
+void FileSystem::PrepareFile(PreparedFile& prep, const char* filename, FileReader* filer, LumpFilterInfo* filter, FileSystemMessageFunc Printf, bool hash, StringPool* sp)
+{
+	bool isdir = false;
+	FileReader filereader;
+
+	prep.FileName = filename;
+	auto starttime = std::chrono::steady_clock::now();
+
+	if (filer == nullptr)
+	{
+		// Does this exist? If so, is it a directory?
+		if (!FS_DirEntryExists(filename, &isdir))
+		{
+			if (Printf)
+			{
+				Printf(FSMessageLevel::Error, "%s: File or Directory not found\n", filename);
+				PrintLastError(Printf);
+			}
+			return;
+		}
+
+		if (!isdir)
+		{
+			// If the file cannot be mapped it is read as usual.
+			bool mapped = filter != nullptr && filter->mapfiles && filereader.OpenMappedFile(filename);
+			if (!mapped && !filereader.OpenFile(filename))
+			{ // Didn't find file
+				if (Printf)
+				{
+					Printf(FSMessageLevel::Error, "%s: File not found\n", filename);
+					PrintLastError(Printf);
+				}
+				return;
+			}
+		}
+	}
+	else filereader = std::move(*filer);
+
+	if (!isdir)
+		prep.ResFile = FResourceFile::OpenResourceFile(filename, filereader, false, filter, Printf, sp);
+	else
+		prep.ResFile = FResourceFile::OpenDirectory(filename, filter, Printf, sp);
+	prep.IndexTime = MilliSecondsSince(starttime);
+
+	if (prep.ResFile != nullptr && hash)
+	{
+		starttime = std::chrono::steady_clock::now();
+		HashResourceFile(prep.ResFile, filename, prep.HashLines);
+		prep.HashTime = MilliSecondsSince(starttime);
+	}
+}
+
 //==========================================================================
 //
 // InitMultipleFiles
@@ -267,9 +407,34 @@ bool FileSystem::InitMultipleFiles (std::vector<std::string>& filenames, LumpFil
 		}
 	}
 
+	auto starttime = std::chrono::steady_clock::now();
+
+	// Reading the directories and hashing is independent for each file, so this is spread across
+	// several threads. The string pool is not thread safe, so each file gets a private one then.
+	std::vector<PreparedFile> prepared(filenames.size());
+	size_t numthreads = std::min<size_t>({ std::max(std::thread::hardware_concurrency(), 1u), MAX_PREPARE_THREADS, filenames.size() });
+	if (numthreads > 1)
+	{
+		std::atomic<size_t> next = 0;
+		auto worker = [&]()
+		{
+			size_t i;
+			while ((i = next++) < filenames.size())
+			{
+				CapturedMessages = &prepared[i].Messages;
+				PrepareFile(prepared[i], filenames[i].c_str(), nullptr, filter, CapturePrintf, hashfile != nullptr, nullptr);
+			}
+		};
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < numthreads; i++) threads.emplace_back(worker);
+		for (auto& t : threads) t.join();
+	}
+
+	// The merge is done in order so that the lump directory is the same as when loading the files one by one.
 	for(size_t i=0;i<filenames.size(); i++)
 	{
-		AddFile(filenames[i].c_str(), nullptr, filter, Printf, hashfile);
+		if (numthreads <= 1) PrepareFile(prepared[i], filenames[i].c_str(), nullptr, filter, Printf, hashfile != nullptr, stringpool);
+		AddPreparedFile(prepared[i], filter, Printf, hashfile);
 
 		if (i == (unsigned)MaxIwadIndex) MoveLumpsInFolder("after_iwad/");
 		std::string path = "filter/%s";
@@ -286,6 +451,17 @@ bool FileSystem::InitMultipleFiles (std::vector<std::string>& filenames, LumpFil
 
 	// [RH] Set up hash table
 	InitHashChains ();
+
+	if (Printf)
+	{
+		for (auto& prep : prepared)
+		{
+			if (prep.ResFile == nullptr) continue;
+			if (hashfile) Printf(FSMessageLevel::DebugNotify, "%s: indexed in %.2f ms, hashed in %.2f ms\n", prep.FileName.c_str(), prep.IndexTime, prep.HashTime);
+			else Printf(FSMessageLevel::DebugNotify, "%s: indexed in %.2f ms\n", prep.FileName.c_str(), prep.IndexTime);
+		}
+		Printf(FSMessageLevel::DebugNotify, "File system set up in %.2f ms using %d thread%s\n", MilliSecondsSince(starttime), (int)numthreads, numthreads == 1 ? "" : "s");
+	}
 	return true;
 }
 
@@ -329,47 +505,30 @@ int FileSystem::AddFromBuffer(const char* name, char* data, int size, int id, in
 
 void FileSystem::AddFile (const char *filename, FileReader *filer, LumpFilterInfo* filter, FileSystemMessageFunc Printf, FILE* hashfile)
 {
-	int startlump;
-	bool isdir = false;
-	FileReader filereader;
+	PreparedFile prep;
+	PrepareFile(prep, filename, filer, filter, Printf, hashfile != nullptr, stringpool);
+	AddPreparedFile(prep, filter, Printf, hashfile);
+}
 
-	if (filer == nullptr)
-	{
-		// Does this exist? If so, is it a directory?
-		if (!FS_DirEntryExists(filename, &isdir))
-		{
-			if (Printf)
-			{
-				Printf(FSMessageLevel::Error, "%s: File or Directory not found\n", filename);
-				PrintLastError(Printf);
-			}
-			return;
-		}
+//==========================================================================
+//
+// AddPreparedFile
+//
+// Adds an opened file's lumps to the directory. Must be called on the
+// main thread and in load order.
+//
+//==========================================================================
 
-		if (!isdir)
-		{
-			if (!filereader.OpenFile(filename))
-			{ // Didn't find file
-				if (Printf)
-				{
-					Printf(FSMessageLevel::Error, "%s: File not found\n", filename);
-					PrintLastError(Printf);
-				}
-				return;
-			}
-		}
+void FileSystem::AddPreparedFile(PreparedFile& prep, LumpFilterInfo* filter, FileSystemMessageFunc Printf, FILE* hashfile)
+{
+	if (Printf)
+	{
+		for (auto& msg : prep.Messages) Printf(msg.first, "%s", msg.second.c_str());
 	}
-	else filereader = std::move(*filer);
+	prep.Messages.clear();
 
-	startlump = NumEntries;
-
-	FResourceFile *resfile;
-
-
-	if (!isdir)
-		resfile = FResourceFile::OpenResourceFile(filename, filereader, false, filter, Printf, stringpool);
-	else
-		resfile = FResourceFile::OpenDirectory(filename, filter, Printf, stringpool);
+	FResourceFile *resfile = prep.ResFile;
+	const char* filename = prep.FileName.c_str();
 
 	if (resfile != NULL)
 	{
@@ -377,6 +536,7 @@ void FileSystem::AddFile (const char *filename, FileReader *filer, LumpFilterInf
 			Printf(FSMessageLevel::Message, "adding %s, %d lumps\n", filename, resfile->EntryCount());
 
 		uint32_t lumpstart = (uint32_t)FileInfo.size();
+		int skinnamespace = -1;
 
 		resfile->SetFirstLump(lumpstart);
 		Files.push_back(resfile);
@@ -385,6 +545,13 @@ void FileSystem::AddFile (const char *filename, FileReader *filer, LumpFilterInf
 			FileInfo.resize(FileInfo.size() + 1);
 			FileSystem::LumpRecord* lump_p = &FileInfo.back();
 			lump_p->SetFromLump(resfile, i, (int)Files.size() - 1, stringpool);
+
+			// Each skin needs its own namespace. These are given out here so that the numbers follow the load order.
+			if (lump_p->Namespace == ns_firstskin)
+			{
+				if (skinnamespace < 0) skinnamespace = NextSkinNamespace++;
+				lump_p->Namespace = skinnamespace;
+			}
 		}
 
 		for (int i = 0; i < resfile->EntryCount(); i++)
@@ -402,44 +569,8 @@ void FileSystem::AddFile (const char *filename, FileReader *filer, LumpFilterInf
 
 		if (hashfile)
 		{
-			uint8_t cksum[16];
-			char cksumout[33];
-			memset(cksumout, 0, sizeof(cksumout));
-
-			if (filereader.isOpen())
-			{
-				filereader.Seek(0, FileReader::SeekSet);
-				md5Hash(filereader, cksum);
-
-				for (size_t j = 0; j < sizeof(cksum); ++j)
-				{
-					snprintf(cksumout + (j * 2), 3, "%02X", cksum[j]);
-				}
-
-				fprintf(hashfile, "file: %s, hash: %s, size: %td\n", filename, cksumout, filereader.GetLength());
-			}
-
-			else
-				fprintf(hashfile, "file: %s, Directory structure\n", filename);
-
-			for (int i = 0; i < resfile->EntryCount(); i++)
-			{
-				int flags = resfile->GetEntryFlags(i);
-				if (!(flags & RESFF_EMBEDDED))
-				{
-					auto reader = resfile->GetEntryReader(i, READER_SHARED, 0);
-					md5Hash(filereader, cksum);
-
-					for (size_t j = 0; j < sizeof(cksum); ++j)
-					{
-						snprintf(cksumout + (j * 2), 3, "%02X", cksum[j]);
-					}
-
-					fprintf(hashfile, "file: %s, lump: %s, hash: %s, size: %zu\n", filename, resfile->getName(i), cksumout, (uint64_t)resfile->Length(i));
-				}
-			}
+			fputs(prep.HashLines.c_str(), hashfile);
 		}
-		return;
 	}
 }
 
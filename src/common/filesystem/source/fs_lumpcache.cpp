@@ -0,0 +1,194 @@
+/*
+** fs_lumpcache.cpp
+** Keeps recently used decompressed lumps in memory
+**
+**---------------------------------------------------------------------------
+** Copyright (C) 2026 Redemption Development Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Compressed lumps like MAPINFO, LANGUAGE or ZScript sources get read many
+** times during startup and on every map change. Decompressing them over and
+** over again is a lot more expensive than keeping them around, so the most
+** recently used ones are kept up to a configurable size.
+**
+** The readers handed out share ownership of the data, so evicting an entry
+** never invalidates a reader that is still open.
+**
+*/
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "resourcefile.h"
+#include "files_internal.h"
+#include "fs_lumpcache.h"
+
+namespace FileSys {
+
+class SharedMemoryReader : public MemoryReader
+{
+	std::shared_ptr<const FileData> data;
+
+public:
+	SharedMemoryReader(std::shared_ptr<const FileData> buffer)
+		: MemoryReader(buffer->string(), buffer->size()), data(std::move(buffer))
+	{
+	}
+};
+
+struct FCachedLumpKey
+{
+	FResourceFile* File;
+	uint32_t Entry;
+
+	bool operator==(const FCachedLumpKey& other) const { return File == other.File && Entry == other.Entry; }
+};
+
+struct FCachedLumpKeyHash
+{
+	size_t operator()(const FCachedLumpKey& key) const { return std::hash<void*>()(key.File) ^ (size_t(key.Entry) * 0x9e3779b9); }
+};
+
+struct FCachedLump
+{
+	FCachedLumpKey Key;
+	std::shared_ptr<const FileData> Data;
+};
+
+static std::mutex CacheMutex;
+static std::list<FCachedLump> CacheList;	// most recently used first
+static std::unordered_map<FCachedLumpKey, std::list<FCachedLump>::iterator, FCachedLumpKeyHash> CacheMap;
+static LumpCacheStats Stats = { 32 * 1024 * 1024 };
+
+//==========================================================================
+//
+// Must be called with the mutex held.
+//
+//==========================================================================
+
+static void Evict(size_t budget)
+{
+	while (Stats.Used > budget && !CacheList.empty())
+	{
+		auto& last = CacheList.back();
+		size_t size = last.Data->size();
+		Stats.Used -= size;
+		Stats.Evictions++;
+		Stats.EvictedBytes += size;
+		CacheMap.erase(last.Key);
+		CacheList.pop_back();
+	}
+	Stats.Entries = CacheList.size();
+}
+
+//==========================================================================
+//
+// A single lump may take up an eighth of the cache at most.
+// Anything larger would push out everything else.
+//
+//==========================================================================
+
+bool LumpCache_Accepts(size_t length)
+{
+	std::lock_guard<std::mutex> lock(CacheMutex);
+	return length > 0 && length <= Stats.Budget / 8;
+}
+
+bool LumpCache_Find(FResourceFile* file, uint32_t entry, FileReader& reader)
+{
+	std::lock_guard<std::mutex> lock(CacheMutex);
+	auto it = CacheMap.find({ file, entry });
+	if (it == CacheMap.end())
+	{
+		Stats.Misses++;
+		return false;
+	}
+	Stats.Hits++;
+	CacheList.splice(CacheList.begin(), CacheList, it->second);
+	reader = FileReader(new SharedMemoryReader(it->second->Data));
+	return true;
+}
+
+FileReader LumpCache_Insert(FResourceFile* file, uint32_t entry, FileData& data)
+{
+	auto shared = std::make_shared<const FileData>(std::move(data));
+	FileReader reader(new SharedMemoryReader(shared));
+
+	std::lock_guard<std::mutex> lock(CacheMutex);
+	FCachedLumpKey key = { file, entry };
+	if (CacheMap.find(key) == CacheMap.end())	// another thread may have been faster.
+	{
+		CacheList.push_front({ key, shared });
+		CacheMap[key] = CacheList.begin();
+		Stats.Used += shared->size();
+		Evict(Stats.Budget);
+	}
+	return reader;
+}
+
+void LumpCache_RemoveFile(FResourceFile* file)
+{
+	std::lock_guard<std::mutex> lock(CacheMutex);
+	for (auto it = CacheList.begin(); it != CacheList.end();)
+	{
+		if (it->Key.File == file)
+		{
+			Stats.Used -= it->Data->size();
+			CacheMap.erase(it->Key);
+			it = CacheList.erase(it);
+		}
+		else ++it;
+	}
+	Stats.Entries = CacheList.size();
+}
+
+//==========================================================================
+//
+// Public interface
+//
+//==========================================================================
+
+void SetLumpCacheBudget(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(CacheMutex);
+	Stats.Budget = bytes;
+	Evict(bytes);
+}
+
+void ClearLumpCache()
+{
+	std::lock_guard<std::mutex> lock(CacheMutex);
+	Evict(0);
+}
+
+LumpCacheStats GetLumpCacheStats()
+{
+	std::lock_guard<std::mutex> lock(CacheMutex);
+	return Stats;
+}
+
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "fs_files.h"
+
+namespace FileSys {
+
+class FResourceFile;
+
+// Internal interface of the decompressed lump cache. All functions are thread safe.
+bool LumpCache_Accepts(size_t length);
+bool LumpCache_Find(FResourceFile* file, uint32_t entry, FileReader& reader);
+FileReader LumpCache_Insert(FResourceFile* file, uint32_t entry, FileData& data);
+void LumpCache_RemoveFile(FResourceFile* file);
+
+}
@@ -42,6 +42,7 @@
 #include "unicode.h"
 #include "fs_findfile.h"
 #include "fs_decompress.h"
+#include "fs_lumpcache.h"
 #include "wildcards.hpp"
 
 namespace FileSys {
@@ -210,6 +211,7 @@ FResourceFile::FResourceFile(const char *filename, FileReader &r, StringPool* sp
 
 FResourceFile::~FResourceFile()
 {
+	LumpCache_RemoveFile(this);
 	if (!stringpool->shared) delete stringpool;
 }
 
@@ -699,13 +701,29 @@ FileReader FResourceFile::GetEntryReader(uint32_t entry, int readertype, int rea
 		}
 		else
 		{
+			// Small enough lumps are kept for the next time they get read, but only
+			// readers that get decompressed in full anyway are used to fill the cache.
+			bool cacheable = LumpCache_Accepts(Entries[entry].Length);
+			if (cacheable && LumpCache_Find(this, entry, fr))
+			{
+				return fr;
+			}
+			bool fill = cacheable && readertype == READER_CACHED;
 			FileReader fri;
 			if (readertype == READER_NEW || !mainThread) fri.OpenFile(FileName, Entries[entry].Position, Entries[entry].CompressedSize);
 			else fri.OpenFilePart(Reader, Entries[entry].Position, Entries[entry].CompressedSize);
 			int flags = DCF_TRANSFEROWNER | DCF_EXCEPTIONS;
-			if (readertype == READER_CACHED) flags |= DCF_CACHED;
-			else if (readerflags & READERFLAG_SEEKABLE) flags |= DCF_SEEKABLE;
+			if (!fill)
+			{
+				if (readertype == READER_CACHED) flags |= DCF_CACHED;
+				else if (readerflags & READERFLAG_SEEKABLE) flags |= DCF_SEEKABLE;
+			}
 			OpenDecompressor(fr, fri, Entries[entry].Length, Entries[entry].Method, flags);
+			if (fill)
+			{
+				auto data = fr.Read(Entries[entry].Length);
+				fr = LumpCache_Insert(this, entry, data);
+			}
 		}
 	}
 	return fr;
@@ -723,7 +741,9 @@ FileData FResourceFile::Read(uint32_t entry)
 		}
 	}
 
-	auto fr = GetEntryReader(entry, READER_SHARED, 0);
+	// Compressed lumps get read in full here, so let them go through the lump cache.
+	int readertype = entry < NumLumps && (Entries[entry].Flags & RESFF_COMPRESSED) ? READER_CACHED : READER_SHARED;
+	auto fr = GetEntryReader(entry, readertype, 0);
 	return fr.Read(entry < NumLumps ? Entries[entry].Length : 0);
 }
 
@@ -306,6 +306,10 @@ void DObject::Release()
 			}
 		}
 	}
+	if (ObjectFlags & (OF_Old | OF_Remembered))
+	{
+		GC::Forget(this);
+	}
 	ObjNext = nullptr;
 	GCNext = nullptr;
 	ObjectFlags |= OF_Released;
@@ -393,7 +393,7 @@ static inline void GC::WriteBarrier(DObject *pointing, DObject *pointed)
 
 static inline void GC::WriteBarrier(DObject *pointed)
 {
-	if (pointed != NULL && State == GCS_Propagate && pointed->IsWhite())
+	if (pointed != NULL && (State == GCS_Propagate || Generational) && pointed->IsWhite())
 	{
 		Barrier(NULL, pointed);
 	}
@@ -59,6 +59,7 @@
 #include "dobject.h"
 
 #include "c_dispatch.h"
+#include "c_cvars.h"
 #include "menu.h"
 #include "stats.h"
 #include "printf.h"
@@ -135,6 +136,14 @@ struct FStepStats
 	void Reset();
 };
 
+struct FGenStats
+{
+	unsigned Swept;			// Objects visited by the sweep
+	unsigned Freed;			// Objects deleted by the sweep
+	unsigned Promoted;		// Objects moved to the old generation
+	unsigned Remembered;	// Objects in the remembered set when the cycle started
+};
+
 // EXTERNAL FUNCTION PROTOTYPES --------------------------------------------
 
 // PUBLIC FUNCTION PROTOTYPES ----------------------------------------------
@@ -147,6 +156,16 @@ static size_t CalcStepSize();
 
 // PUBLIC DATA DEFINITIONS -------------------------------------------------
 
+// In generational mode, objects that survive a collection become old: they
+// stay black and are neither marked nor swept again until the next major
+// collection. Minor collections only mark from the roots and the remembered
+// set, and only sweep the nursery, i.e. the objects that were created since
+// the last collection and therefore sit at the head of the Root list.
+CVAR(Bool, gc_generational, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+// Number of minor collections between two major collections.
+CVAR(Int, gc_majorinterval, 8, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
 namespace GC
 {
 size_t AllocBytes;
@@ -167,12 +186,24 @@ FStepStats StepStats;
 FStepStats PrevStepStats;
 bool FinalGC;
 bool HadToDestroy;
+bool Generational;
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
 static FAveragizer AllocHistory;// Tracks allocation rate over time
 static cycle_t GCTime;			// Track time spent in GC
 
+static TArray<DObject *> Remembered;	// Young objects stored since the last collection started
+static TMap<DObject *, unsigned> RememberedIndex;	// Their position in Remembered, for Forget
+static bool MinorCycle;			// Old objects are not marked in this collection
+static bool SweepAll;			// The sweep covers the old objects, too
+static bool Promote;			// Survivors of the sweep become old
+static bool FullCollection;		// FullGC is running and wants everything collected
+static int MinorCount;			// Minor collections since the last major one
+static int MinorCycles, MajorCycles;
+static size_t OldObjects;
+static FGenStats GenStats, PrevGenStats;
+
 // CODE --------------------------------------------------------------------
 
 //==========================================================================
@@ -235,19 +266,39 @@ size_t PropagateMark()
 //
 //==========================================================================
 
+// Minor collections stop at the first old object, since everything behind
+// it was already there when the previous collection finished.
+static inline bool SweepFinished()
+{
+	DObject *curr = *SweepPos;
+	return curr == nullptr || (!SweepAll && (curr->ObjectFlags & OF_Old));
+}
+
 static size_t SweepObjects(size_t count)
 {
 	DObject *curr;
 	int deadmask = OtherWhite();
 	size_t swept = 0;
 
-	while ((curr = *SweepPos) != nullptr && count-- > 0)
+	while (!SweepFinished() && count-- > 0)
 	{
+		curr = *SweepPos;
 		swept += curr->GetClass()->Size;
+		GenStats.Swept++;
 		if ((curr->ObjectFlags ^ OF_WhiteBits) & deadmask)	// not dead?
 		{
 			assert(!curr->IsDead() || (curr->ObjectFlags & OF_Fixed));
-			curr->MakeWhite();	// make it white (for next cycle)
+			// Objects created after the mark phase are still white and stay young.
+			if (Promote && (curr->IsBlack() || (curr->ObjectFlags & OF_Fixed)))
+			{
+				curr->ObjectFlags = (curr->ObjectFlags & ~OF_WhiteBits) | OF_Black | OF_Old;
+				GenStats.Promoted++;
+			}
+			else
+			{
+				curr->MakeWhite();	// make it white (for next cycle)
+				curr->ObjectFlags &= ~OF_Old;
+			}
 			SweepPos = &curr->ObjNext;
 		}
 		else
@@ -262,9 +313,11 @@ static size_t SweepObjects(size_t count)
 			else
 			{	// must erase 'curr'
 				*SweepPos = curr->ObjNext;
+				if (curr->ObjectFlags & OF_Remembered) Forget(curr);
 				curr->ObjectFlags |= OF_Cleanup;
 				delete curr;
 				swept += GCDELETECOST;
+				GenStats.Freed++;
 			}
 		}
 	}
@@ -380,6 +433,53 @@ void AddMarkerFunc(GCMarkerFunc func)
 		markers.Push(func);
 }
 
+static void StartCycle()
+{
+	PrevGenStats = GenStats;
+	GenStats = {};
+	GenStats.Remembered = RememberedIndex.CountUsed();
+
+	// If old objects are still black from the last collection, only the
+	// young ones can be marked and the remembered set has to stand in for
+	// the old objects pointing at them.
+	MinorCycle = Generational;
+	if (MinorCycle)
+	{
+		// A major collection starts with a minor one that returns every
+		// survivor to white, followed by a full collection.
+		bool major = !gc_generational || FullCollection || MinorCount >= gc_majorinterval;
+		SweepAll = major;
+		Promote = !major;
+		if (!major)
+		{
+			MinorCount++;
+			MinorCycles++;
+		}
+	}
+	else
+	{
+		SweepAll = true;
+		Promote = gc_generational && !FullCollection;
+		if (Promote)
+		{
+			Generational = true;
+			MinorCount = 0;
+			MajorCycles++;
+		}
+	}
+
+	for (auto &obj : Remembered)
+	{
+		if (obj != nullptr)
+		{
+			obj->ObjectFlags &= ~OF_Remembered;
+			if (MinorCycle) Mark(&obj);
+		}
+	}
+	Remembered.Clear();
+	RememberedIndex.Clear();
+}
+
 static void MarkRoot()
 {
 	PrevStepStats = StepStats;
@@ -387,6 +487,8 @@ static void MarkRoot()
 
 	Gray = nullptr;
 
+	StartCycle();
+
 	for (auto func : markers) func();
 
 	// Mark soft roots.
@@ -436,6 +538,17 @@ static void Atomic()
 
 static void SweepDone()
 {
+	// Without promotion every survivor is white again, so the next
+	// collection has to mark everything.
+	if (Promote)
+	{
+		OldObjects = (SweepAll ? 0 : OldObjects) + GenStats.Promoted;
+	}
+	else
+	{
+		OldObjects = 0;
+	}
+	Generational = Promote;
 	HadToDestroy = ToDestroy != nullptr;
 	State = HadToDestroy ? GCS_Destroy : GCS_Done;
 }
@@ -471,7 +584,7 @@ static size_t SingleStep()
 		RunningDeallocBytes = 0;
 		size_t swept = SweepObjects(GCSWEEPGRANULARITY);
 		Estimate -= RunningDeallocBytes;
-		if (*SweepPos == nullptr)
+		if (SweepFinished())
 		{ // Nothing more to sweep?
 			SweepDone();
 		}
@@ -560,25 +673,42 @@ void Step()
 //
 //==========================================================================
 
+static void SweepToWhite()
+{
+	// Reset sweep mark to sweep all elements (returning them to white)
+	SweepPos = &Root;
+	SweepAll = true;
+	Promote = false;
+	// Reset other collector lists
+	Gray = nullptr;
+	State = GCS_Sweep;
+}
+
 void FullGC()
 {
 	bool ContinueCheck = true;
+	FullCollection = true;
 	while (ContinueCheck)
 	{
 		ContinueCheck = false;
 		if (State <= GCS_Propagate)
 		{
-			// Reset sweep mark to sweep all elements (returning them to white)
-			SweepPos = &Root;
-			// Reset other collector lists
-			Gray = nullptr;
-			State = GCS_Sweep;
+			SweepToWhite();
 		}
 		// Finish any pending GC stages
 		while (State != GCS_Pause)
 		{
 			SingleStep();
 		}
+		// Old objects must be white before everything can be marked.
+		if (Generational)
+		{
+			SweepToWhite();
+			while (State != GCS_Pause)
+			{
+				SingleStep();
+			}
+		}
 		// Loop until everything that can be destroyed and freed is
 		do
 		{
@@ -590,6 +720,7 @@ void FullGC()
 			ContinueCheck |= HadToDestroy;
 		} while (HadToDestroy);
 	}
+	FullCollection = false;
 }
 
 //==========================================================================
@@ -605,7 +736,7 @@ void Barrier(DObject *pointing, DObject *pointed)
 {
 	assert(pointing == nullptr || (pointing->IsBlack() && !pointing->IsDead()));
 	assert(pointed->IsWhite() && !pointed->IsDead());
-	assert(State != GCS_Destroy && State != GCS_Pause);
+	assert(Generational || (State != GCS_Destroy && State != GCS_Pause));
 	assert(!(pointed->ObjectFlags & OF_Released));	// if a released object gets here, something must be wrong.
 	if (pointed->ObjectFlags & OF_Released) return;	// don't do anything with non-GC'd objects.
 	// The invariant only needs to be maintained in the propagate state.
@@ -615,6 +746,16 @@ void Barrier(DObject *pointing, DObject *pointed)
 		pointed->GCNext = Gray;
 		Gray = pointed;
 	}
+	// Old objects are not marked by minor collections, so the young object
+	// needs to be marked from the remembered set instead.
+	else if (Generational)
+	{
+		if (!(pointed->ObjectFlags & OF_Remembered))
+		{
+			pointed->ObjectFlags |= OF_Remembered;
+			RememberedIndex[pointed] = Remembered.Push(pointed);
+		}
+	}
 	// In other states, we can mark the pointing object white so this
 	// barrier won't be triggered again, saving a few cycles in the future.
 	else if (pointing != nullptr)
@@ -623,6 +764,46 @@ void Barrier(DObject *pointing, DObject *pointed)
 	}
 }
 
+//==========================================================================
+//
+// ObjPtrBarrier
+//
+// TObjPtr does not know which object holds it, so in generational mode
+// every young object stored in one gets remembered.
+//
+//==========================================================================
+
+void ObjPtrBarrier(DObject *pointed)
+{
+	WriteBarrier(pointed);
+}
+
+//==========================================================================
+//
+// Forget
+//
+// Called when an object leaves the GC list outside the sweep.
+//
+//==========================================================================
+
+void Forget(DObject *obj)
+{
+	if (obj->ObjectFlags & OF_Old)
+	{
+		if (OldObjects > 0) OldObjects--;
+	}
+	if (obj->ObjectFlags & OF_Remembered)
+	{
+		// Only clear the slot, so that the other indices stay valid.
+		if (auto index = RememberedIndex.CheckKey(obj))
+		{
+			Remembered[*index] = nullptr;
+			RememberedIndex.Remove(obj);
+		}
+	}
+	obj->ObjectFlags &= ~(OF_Old | OF_Remembered);
+}
+
 void DelSoftRootHead()
 {
 	if (SoftRoots != nullptr)
@@ -694,6 +875,12 @@ void DelSoftRoot(DObject *obj)
 		return;
 	}
 	obj->ObjectFlags &= ~OF_Rooted;
+	// Old objects must stay behind the nursery. MarkRoot checks the flag,
+	// so the object can stay where it is.
+	if (Generational)
+	{
+		return;
+	}
 	// Move object out of the soft roots part of the list.
 	probe = &SoftRoots;
 	while (*probe != nullptr && *probe != obj)
@@ -787,6 +974,13 @@ ADD_STAT(gc)
 		(GC::AllocBytes + 1023) >> 10,
 		(GC::Estimate + 1023) >> 10,
 		(GC::Threshold + 1023) >> 10);
+	if (gc_generational || GC::Generational)
+	{
+		auto &gen = GC::PrevGenStats;
+		out.AppendFormat("\nMinor:%d Major:%d  Old:%zu  Last cycle: Swept:%u Freed:%u Promoted:%u Remembered:%u",
+			GC::MinorCycles, GC::MajorCycles, GC::OldObjects,
+			gen.Swept, gen.Freed, gen.Promoted, gen.Remembered);
+	}
 	return out;
 }
 
@@ -27,6 +27,10 @@ enum EObjectFlags
 	OF_Spawned			= 1 << 12,      // Thinker was spawned at all (some thinkers get deleted before spawning)
 	OF_Released			= 1 << 13,		// Object was released from the GC system and should not be processed by GC function
 	OF_Networked		= 1 << 14,		// Object has a unique network identifier that makes it synchronizable between all clients.
+
+	// Generational GC flags
+	OF_Old				= 1 << 15,		// Object survived a generational collection and is only swept by major collections
+	OF_Remembered		= 1 << 16,		// Object is in the remembered set for the next minor collection
 };
 
 template<class T> class TObjPtr;
@@ -80,6 +84,10 @@ namespace GC
 	// Is this the final collection just before exit?
 	extern bool FinalGC;
 
+	// Are old objects kept black between collections? While this is set,
+	// stores of young objects must be remembered for the next minor collection.
+	extern bool Generational;
+
 	// Current white value for known-dead objects.
 	static inline uint32_t OtherWhite()
 	{
@@ -101,6 +109,12 @@ namespace GC
 	// Handles a write barrier for a pointer that isn't inside an object.
 	static inline void WriteBarrier(DObject *pointed);
 
+	// Handles a write barrier for a pointer stored through a TObjPtr.
+	void ObjPtrBarrier(DObject *pointed);
+
+	// Removes a released object from the generational bookkeeping.
+	void Forget(DObject *obj);
+
 	// Handles a read barrier.
 	template<class T> inline T *ReadBarrier(T *&obj)
 	{
@@ -204,8 +218,12 @@ namespace GC
 }
 
 // A template class to help with handling read barriers. It does not
-// handle write barriers, because those can be handled more efficiently
-// with knowledge of the object that holds the pointer.
+// handle regular write barriers, because those can be handled more efficiently
+// with knowledge of the object that holds the pointer. In generational mode
+// it does report stored objects, so that young objects are not lost when
+// they are only referenced from old ones. Copies between TObjPtrs stay
+// trivial so that the structs holding them can be copied with memcpy; the
+// barrier is only run when a new pointer is stored.
 template<class T>
 class TObjPtr
 {
@@ -217,15 +235,19 @@ class TObjPtr
 public:
 	TObjPtr() = default;
 
-	TObjPtr(T t) : pp(t) {}
+	TObjPtr(T t) : pp(t)
+	{
+		if (GC::Generational) GC::ObjPtrBarrier(o);
+	}
 
-	constexpr TObjPtr<T>& operator=(T q) noexcept
+	TObjPtr<T>& operator=(T q) noexcept
 	{
 		pp = q;
+		if (GC::Generational) GC::ObjPtrBarrier(o);
 		return *this;
 	}
 
-	constexpr TObjPtr<T>& operator=(std::nullptr_t nul) noexcept
+	TObjPtr<T>& operator=(std::nullptr_t nul) noexcept
 	{
 		o = nullptr;
 		return *this;
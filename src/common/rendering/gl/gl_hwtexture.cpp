@@ -37,6 +37,7 @@
 
 #include "c_cvars.h"
 #include "hw_material.h"
+#include "hw_texturedecoder.h"
 
 #include "gl_interface.h"
 #include "hw_cvars.h"
@@ -303,8 +304,8 @@ bool FHardwareTexture::BindOrCreate(FTexture *tex, int texunit, int clampmode, i
 {
 	bool needmipmap = (clampmode <= CLAMP_XY) && !forcenofilter;
 
-	// Bind it to the system.
-	if (!Bind(texunit, needmipmap))
+	// Bind it to the system. A placeholder gets replaced as soon as the decoder has the real data.
+	if (!Bind(texunit, needmipmap) || (placeholder && TexDecoder_IsReady(tex, translation, flags | CTF_ProcessData)))
 	{
 		if (flags & CTF_Indexed)
 		{
@@ -320,7 +321,7 @@ bool FHardwareTexture::BindOrCreate(FTexture *tex, int texunit, int clampmode, i
 
 		if (!tex->isHardwareCanvas())
 		{
-			texbuffer = tex->CreateTexBuffer(translation, flags | CTF_ProcessData);
+			texbuffer = TexDecoder_CreateTexBuffer(tex, translation, flags | CTF_ProcessData, placeholder);
 			w = texbuffer.mWidth;
 			h = texbuffer.mHeight;
 		}
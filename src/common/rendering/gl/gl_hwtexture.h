@@ -45,6 +45,7 @@ private:
 	unsigned int glBufferID = 0;
 	int glTextureBytes;
 	bool mipmapped = false;
+	bool placeholder = false;	// the real data is still being decoded
 
 	int GetDepthBuffer(int w, int h);
 
@@ -46,6 +46,7 @@ private:
 
 	int glTextureBytes;
 	bool mipmapped = false;
+	bool placeholder = false;	// the real data is still being decoded
 
 	int GetDepthBuffer(int w, int h);
 
@@ -53,8 +53,9 @@ glcycle_t twoD, Flush3D;
 glcycle_t MTWait, WTTotal;
 int vertexcount, flatvertices, flatprimitives;
 
-int rendered_lines,rendered_flats,rendered_sprites,render_vertexsplit,render_texsplit,rendered_decals, rendered_portals, rendered_commandbuffers;
-int iter_dlightf, iter_dlight, draw_dlight, draw_dlightf;
+std::atomic<int> rendered_lines,rendered_flats,rendered_sprites,render_texsplit,rendered_decals;
+int render_vertexsplit, rendered_portals, rendered_commandbuffers;
+std::atomic<int> iter_dlightf, iter_dlight, draw_dlight, draw_dlightf;
 
 void ResetProfilingData()
 {
@@ -113,13 +114,13 @@ static void AppendRenderStats(FString &out)
 	out.AppendFormat("Walls: %d (%d splits, %d t-splits, %d vertices)\n"
 		"Flats: %d (%d primitives, %d vertices)\n"
 		"Sprites: %d, Decals=%d, Portals: %d, Command buffers: %d\n",
-		rendered_lines, render_vertexsplit, render_texsplit, vertexcount, rendered_flats, flatprimitives, flatvertices, rendered_sprites,rendered_decals, rendered_portals, rendered_commandbuffers );
+		rendered_lines.load(), render_vertexsplit, render_texsplit.load(), vertexcount, rendered_flats.load(), flatprimitives, flatvertices, rendered_sprites.load(), rendered_decals.load(), rendered_portals, rendered_commandbuffers );
 }
 
 static void AppendLightStats(FString &out)
 {
 	out.AppendFormat("DLight - Walls: %d processed, %d rendered - Flats: %d processed, %d rendered\n", 
-		iter_dlight, draw_dlight, iter_dlightf, draw_dlightf );
+		iter_dlight.load(), draw_dlight.load(), iter_dlightf.load(), draw_dlightf.load() );
 }
 
 ADD_STAT(rendertimes)
@@ -151,6 +152,7 @@ ADD_STAT(lightstats)
 }
 
 static int printstats;
+static bool benchclocks;
 static bool switchfps;
 static uint64_t waitstart;
 EXTERN_CVAR(Bool, vid_fps)
@@ -206,6 +208,12 @@ bool glcycle_t::active = false;
 void  checkBenchActive()
 {
 	FStat *stat = FStat::FindStat("rendertimes");
-	glcycle_t::active = ((stat != NULL && stat->isActive()) || printstats);
+	glcycle_t::active = ((stat != NULL && stat->isActive()) || printstats || benchclocks);
+}
+
+// Keeps the render clocks running for an external consumer, e.g. timedemo benchmarks
+void SetBenchmarkClocks(bool on)
+{
+	benchclocks = on;
 }
 
@@ -23,6 +23,7 @@
 
 #include "c_cvars.h"
 #include "hw_material.h"
+#include "hw_texturedecoder.h"
 #include "hw_cvars.h"
 #include "hw_renderstate.h"
 #include <zvulkan/vulkanobjects.h>
@@ -61,9 +62,30 @@ void VkHardwareTexture::Reset()
 
 		mImage.Reset(fb);
 		mDepthStencil.Reset(fb);
+		ClearPlaceholder();
 	}
 }
 
+void VkHardwareTexture::ClearPlaceholder()
+{
+	if (mPlaceholderTex)
+	{
+		mPlaceholderTex = nullptr;
+		fb->GetTextureManager()->NumPlaceholders--;
+	}
+}
+
+// Drops the placeholder image once the real data can be uploaded. The image gets created again on its next use.
+bool VkHardwareTexture::ReplacePlaceholder()
+{
+	if (!mPlaceholderTex || !TexDecoder_IsReady(mPlaceholderTex, mPlaceholderTranslation, mPlaceholderFlags))
+		return false;
+
+	mImage.Reset(fb);
+	ClearPlaceholder();
+	return true;
+}
+
 VkTextureImage *VkHardwareTexture::GetImage(FTexture *tex, int translation, int flags)
 {
 	if (!mImage.Image)
@@ -107,7 +129,15 @@ void VkHardwareTexture::CreateImage(FTexture *tex, int translation, int flags)
 {
 	if (!tex->isHardwareCanvas())
 	{
-		FTextureBuffer texbuffer = tex->CreateTexBuffer(translation, flags | CTF_ProcessData);
+		bool placeholder;
+		FTextureBuffer texbuffer = TexDecoder_CreateTexBuffer(tex, translation, flags | CTF_ProcessData, placeholder);
+		if (placeholder)
+		{
+			mPlaceholderTex = tex;
+			mPlaceholderTranslation = translation;
+			mPlaceholderFlags = flags | CTF_ProcessData;
+			fb->GetTextureManager()->NumPlaceholders++;
+		}
 		bool indexed = flags & CTF_Indexed;
 		CreateTexture(texbuffer.mWidth, texbuffer.mHeight,indexed? 1 : 4, indexed? VK_FORMAT_R8_UNORM : VK_FORMAT_B8G8R8A8_UNORM, texbuffer.mBuffer, !indexed);
 	}
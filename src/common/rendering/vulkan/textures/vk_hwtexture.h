@@ -41,6 +41,7 @@ public:
 
 	VkTextureImage *GetImage(FTexture *tex, int translation, int flags);
 	VkTextureImage *GetDepthStencil(FTexture *tex);
+	bool ReplacePlaceholder();
 
 	VulkanRenderDevice* fb = nullptr;
 	std::list<VkHardwareTexture*>::iterator it;
@@ -51,9 +52,16 @@ private:
 	void CreateTexture(int w, int h, int pixelsize, VkFormat format, const void *pixels, bool mipmap);
 	static int GetMipLevels(int w, int h);
 
+	void ClearPlaceholder();
+
 	VkTextureImage mImage;
 	int mTexelsize = 4;
 
+	// Set while mImage only holds a placeholder because the decoder is still working on the real data.
+	FTexture *mPlaceholderTex = nullptr;
+	int mPlaceholderTranslation = 0;
+	int mPlaceholderFlags = 0;
+
 	VkTextureImage mDepthStencil;
 
 	uint8_t* mappedSWFB = nullptr;
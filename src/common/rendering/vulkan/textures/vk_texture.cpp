@@ -25,6 +25,7 @@
 #include "vk_pptexture.h"
 #include "vk_renderbuffers.h"
 #include "vulkan/renderer/vk_postprocess.h"
+#include "vulkan/renderer/vk_descriptorset.h"
 #include "hw_cvars.h"
 
 VkTextureManager::VkTextureManager(VulkanRenderDevice* fb) : fb(fb)
@@ -57,6 +58,17 @@ void VkTextureManager::BeginFrame()
 		Shadowmap.Reset(fb);
 		CreateShadowmap();
 	}
+
+	if (NumPlaceholders > 0)
+	{
+		// The descriptor sets still reference the placeholder images so all of them need to be recreated.
+		bool replaced = false;
+		for (auto texture : Textures)
+		{
+			if (texture->ReplacePlaceholder()) replaced = true;
+		}
+		if (replaced) fb->GetDescriptorSetManager()->ResetHWTextureSets();
+	}
 }
 
 void VkTextureManager::AddTexture(VkHardwareTexture* texture)
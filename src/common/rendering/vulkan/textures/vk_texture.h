@@ -40,6 +40,8 @@ public:
 	VkTextureImage Shadowmap;
 	VkTextureImage Lightmap;
 
+	int NumPlaceholders = 0;
+
 private:
 	void CreateNullTexture();
 	void CreateShadowmap();
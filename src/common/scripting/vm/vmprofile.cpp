@@ -0,0 +1,350 @@
+/*
+** vmprofile.cpp
+** Instrumenting profiler for script functions
+**
+**---------------------------------------------------------------------------
+** Copyright (C) 2026 Redemption Development Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** While the profiler runs, the ScriptCall entry point of every script
+** function is replaced by a wrapper that times the call. Since the
+** interpreter, the JIT and VMCall all enter script functions through
+** ScriptCall, this catches every script-to-script call without touching
+** the generated code. Native functions are not wrapped, so their time
+** counts towards the script function calling them.
+**
+** Times are collected in a call tree, so the same function reached through
+** different callers gets separate entries. The tree can be printed as a
+** flat list per function or class, or written as collapsed stacks for
+** flame graph tools.
+**
+*/
+
+#include <algorithm>
+#include <stdio.h>
+#include "dobject.h"
+#include "c_dispatch.h"
+#include "i_time.h"
+#include "v_text.h"
+#include "printf.h"
+#include "vmintern.h"
+#include "types.h"
+
+struct FVMProfileNode
+{
+	VMFunction *Func;
+	int Parent;
+	TMap<VMFunction *, int> Children;
+	uint64_t Calls = 0;
+	uint64_t TotalTime = 0;	// in ns, including callees
+	uint64_t SelfTime = 0;	// in ns, excluding callees
+};
+
+struct FVMProfileFrame
+{
+	int Node;
+	uint64_t Start;
+	uint64_t ChildTime;
+};
+
+static TDeletingArray<FVMProfileNode *> ProfileNodes;	// allocated separately so that growing the array does not move the child maps
+static TArray<FVMProfileFrame> ProfileStack;
+static int ProfileCurrent;
+static unsigned ProfileGeneration;
+static bool ProfileRunning;
+
+static int ProfiledScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret);
+
+//==========================================================================
+//
+// Call tree management
+//
+//==========================================================================
+
+static int ProfileEnter(VMFunction *func)
+{
+	auto &children = ProfileNodes[ProfileCurrent]->Children;
+	int *child = children.CheckKey(func);
+	int node;
+	if (child != nullptr)
+	{
+		node = *child;
+	}
+	else
+	{
+		auto newnode = new FVMProfileNode;
+		newnode->Func = func;
+		newnode->Parent = ProfileCurrent;
+		node = ProfileNodes.Push(newnode);
+		children.Insert(func, node);
+	}
+	ProfileNodes[node]->Calls++;
+	ProfileStack.Push({ node, I_nsTime(), 0 });
+	ProfileCurrent = node;
+	return node;
+}
+
+static void ProfileLeave()
+{
+	FVMProfileFrame frame = {};
+	if (!ProfileStack.Pop(frame)) return;
+
+	uint64_t elapsed = I_nsTime() - frame.Start;
+	auto &node = *ProfileNodes[frame.Node];
+	node.TotalTime += elapsed;
+	node.SelfTime += elapsed - min(frame.ChildTime, elapsed);
+	if (ProfileStack.Size() > 0) ProfileStack.Last().ChildTime += elapsed;
+	ProfileCurrent = node.Parent;
+}
+
+// Pops the frame on the way out, even if the call is aborted by an exception.
+struct FVMProfileScope
+{
+	unsigned Generation;
+	FVMProfileScope(VMFunction *func) : Generation(ProfileGeneration) { ProfileEnter(func); }
+	~FVMProfileScope() { if (Generation == ProfileGeneration) ProfileLeave(); }
+};
+
+//==========================================================================
+//
+// The wrapper placed in VMFunction::ScriptCall
+//
+//==========================================================================
+
+static int ProfiledScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret)
+{
+	auto sfunc = static_cast<VMScriptFunction *>(func);
+	auto call = sfunc->UnprofiledScriptCall;
+	FVMProfileScope scope(func);
+
+	int result = call(func, params, numparams, ret, numret);
+
+	// The first call of a function replaces ScriptCall with the compiled code.
+	if (ProfileRunning && func->ScriptCall != ProfiledScriptCall)
+	{
+		sfunc->UnprofiledScriptCall = func->ScriptCall;
+		func->ScriptCall = ProfiledScriptCall;
+	}
+	return result;
+}
+
+static void VMProfileReset()
+{
+	ProfileGeneration++;
+	ProfileNodes.DeleteAndClear();
+	ProfileStack.Clear();
+
+	auto root = new FVMProfileNode;
+	root->Func = nullptr;
+	root->Parent = -1;
+	ProfileNodes.Push(root);
+	ProfileCurrent = 0;
+}
+
+static void VMProfileStart()
+{
+	if (ProfileRunning) return;
+
+	VMProfileReset();
+	for (auto f : VMFunction::AllFunctions)
+	{
+		if (!(f->VarFlags & VARF_Native) && f->ScriptCall != nullptr)
+		{
+			auto sfunc = static_cast<VMScriptFunction *>(f);
+			sfunc->UnprofiledScriptCall = f->ScriptCall;
+			f->ScriptCall = ProfiledScriptCall;
+		}
+	}
+	ProfileRunning = true;
+}
+
+static void VMProfileStop()
+{
+	if (!ProfileRunning) return;
+
+	for (auto f : VMFunction::AllFunctions)
+	{
+		if (f->ScriptCall == ProfiledScriptCall)
+		{
+			auto sfunc = static_cast<VMScriptFunction *>(f);
+			f->ScriptCall = sfunc->UnprofiledScriptCall;
+			sfunc->UnprofiledScriptCall = nullptr;
+		}
+	}
+	// Calls still on the stack must not touch the tree anymore.
+	ProfileGeneration++;
+	ProfileStack.Clear();
+	ProfileCurrent = 0;
+	ProfileRunning = false;
+}
+
+//==========================================================================
+//
+// Reports
+//
+//==========================================================================
+
+struct FVMProfileEntry
+{
+	FString Name;
+	uint64_t Calls = 0;
+	uint64_t TotalTime = 0;
+	uint64_t SelfTime = 0;
+};
+
+static FString ProfileClassName(VMFunction *func)
+{
+	FString name = func->QualifiedName ? func->QualifiedName : func->PrintableName;
+	auto dot = name.IndexOf('.');
+	return dot >= 0 ? name.Left(dot) : name;
+}
+
+// Sums all nodes per function or per class. Total time is only counted for
+// the outermost occurrence on a stack so that recursion does not inflate it.
+static void ProfileCollect(TArray<FVMProfileEntry> &entries, bool byclass)
+{
+	TMap<FString, unsigned> index;
+
+	for (unsigned i = 1; i < ProfileNodes.Size(); i++)
+	{
+		auto &node = *ProfileNodes[i];
+		FString name = byclass ? ProfileClassName(node.Func) : FString(node.Func->PrintableName);
+
+		unsigned *idx = index.CheckKey(name);
+		if (idx == nullptr)
+		{
+			idx = &index.Insert(name, entries.Reserve(1));
+			new (&entries[*idx]) FVMProfileEntry;
+			entries[*idx].Name = name;
+		}
+		auto &entry = entries[*idx];
+		entry.Calls += node.Calls;
+		entry.SelfTime += node.SelfTime;
+
+		bool nested = false;
+		for (int p = node.Parent; p > 0 && !nested; p = ProfileNodes[p]->Parent)
+		{
+			auto pfunc = ProfileNodes[p]->Func;
+			nested = byclass ? ProfileClassName(pfunc) == name : pfunc == node.Func;
+		}
+		if (!nested) entry.TotalTime += node.TotalTime;
+	}
+}
+
+static void ProfilePrint(int count, bool byclass, bool bytotal)
+{
+	TArray<FVMProfileEntry> entries;
+	ProfileCollect(entries, byclass);
+
+	std::sort(entries.begin(), entries.end(), [=](const FVMProfileEntry &a, const FVMProfileEntry &b)
+	{
+		return bytotal ? a.TotalTime > b.TotalTime : a.SelfTime > b.SelfTime;
+	});
+
+	Printf(TEXTCOLOR_YELLOW "%12s %12s %10s  %s\n", "Self (ms)", "Total (ms)", "Calls", byclass ? "Class" : "Function");
+	for (unsigned i = 0; i < entries.Size() && (int)i < count; i++)
+	{
+		auto &entry = entries[i];
+		Printf("%12.3f %12.3f %10llu  %s\n", entry.SelfTime / 1e6, entry.TotalTime / 1e6, (unsigned long long)entry.Calls, entry.Name.GetChars());
+	}
+}
+
+// Writes one line per call tree node in the collapsed stack format used by
+// flamegraph.pl, speedscope and similar tools: "outer;inner;leaf <self time in us>"
+static bool ProfileDump(const char *filename)
+{
+	FILE *f = fopen(filename, "w");
+	if (f == nullptr) return false;
+
+	TArray<int> path;
+	for (unsigned i = 1; i < ProfileNodes.Size(); i++)
+	{
+		uint64_t selfus = ProfileNodes[i]->SelfTime / 1000;
+		if (selfus == 0) continue;
+
+		path.Clear();
+		for (int p = i; p > 0; p = ProfileNodes[p]->Parent) path.Push(p);
+
+		FString line;
+		for (int j = path.Size() - 1; j >= 0; j--)
+		{
+			FString name = ProfileNodes[path[j]]->Func->PrintableName;
+			name.Substitute(" ", "_");
+			name.Substitute(";", "_");
+			line << name;
+			if (j > 0) line << ';';
+		}
+		fprintf(f, "%s %llu\n", line.GetChars(), (unsigned long long)selfus);
+	}
+	fclose(f);
+	return true;
+}
+
+//==========================================================================
+//
+// CCMD vmprofile
+//
+//==========================================================================
+
+CCMD(vmprofile)
+{
+	const char *cmd = argv.argc() > 1 ? argv[1] : "";
+
+	if (!stricmp(cmd, "start"))
+	{
+		VMProfileStart();
+		Printf("Script profiler started\n");
+	}
+	else if (!stricmp(cmd, "stop"))
+	{
+		VMProfileStop();
+		Printf("Script profiler stopped\n");
+	}
+	else if (!stricmp(cmd, "reset"))
+	{
+		VMProfileReset();
+	}
+	else if (!stricmp(cmd, "print") || !stricmp(cmd, "classes"))
+	{
+		int count = argv.argc() > 2 ? atoi(argv[2]) : 20;
+		bool bytotal = argv.argc() > 3 && !stricmp(argv[3], "total");
+		ProfilePrint(count, !stricmp(cmd, "classes"), bytotal);
+	}
+	else if (!stricmp(cmd, "dump") && argv.argc() > 2)
+	{
+		if (ProfileDump(argv[2]))
+			Printf("Collapsed stacks written to %s\n", argv[2]);
+		else
+			Printf(TEXTCOLOR_RED "Unable to write %s\n", argv[2]);
+	}
+	else
+	{
+		Printf("Usage: vmprofile start|stop|reset\n"
+			"       vmprofile print|classes [count] [self|total]\n"
+			"       vmprofile dump <filename>\n");
+	}
+}
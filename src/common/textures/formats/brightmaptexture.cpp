@@ -44,6 +44,7 @@ public:
 	FBrightmapTexture (FImageSource *source);
 
 	int CopyPixels(FBitmap *bmp, int conversion, int frame = 0) override;
+	void PrepareForDecode() override { SourcePic->PrepareForDecode(); }
 
 protected:
 	FImageSource *SourcePic;
@@ -337,6 +337,20 @@ int FMultiPatchTexture::CopyPixels(FBitmap *bmp, int conversion, int frame)
 //
 //==========================================================================
 
+void FMultiPatchTexture::PrepareForDecode()
+{
+	for (int i = 0; i < NumParts; ++i)
+	{
+		Parts[i].Image->PrepareForDecode();
+	}
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
 void FMultiPatchTexture::CollectForPrecache(PrecacheInfo &info, bool requiretruecolor)
 {
 	FImageSource::CollectForPrecache(info, requiretruecolor);
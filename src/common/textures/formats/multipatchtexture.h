@@ -77,6 +77,7 @@ protected:
 	int CopyPixels(FBitmap *bmp, int conversion, int frame = 0) override;
 	PalettedPixels CreatePalettedPixels(int conversion, int frame = 0) override;
 	void CopyToBlock(uint8_t *dest, int dwidth, int dheight, FImageSource *source, int xpos, int ypos, int rotate, const uint8_t *translation, int style);
+	void PrepareForDecode() override;
 	void CollectForPrecache(PrecacheInfo &info, bool requiretruecolor) override;
 
 };
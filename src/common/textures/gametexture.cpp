@@ -34,6 +34,7 @@
 **
 */
 
+#include <mutex>
 #include "printf.h"
 #include "files.h"
 #include "filesystem.h"
@@ -51,6 +52,8 @@
 #include "hw_material.h"
 #include "cmdlib.h"
 
+static std::mutex SpriteDataMutex;
+
 FTexture *CreateBrightmapTexture(FImageSource*);
 
 
@@ -331,12 +334,17 @@ bool FGameTexture::ShouldExpandSprite()
 
 void FGameTexture::SetupSpriteData()
 {
+	// The hardware renderer's BSP workers may ask for the same sprite at the same time,
+	// so the data is built under a lock and only published once it is complete.
+	std::lock_guard<std::mutex> lock(SpriteDataMutex);
+	if (spi.load(std::memory_order_relaxed) != nullptr) return;
+
 	// Since this is only needed for real sprites it gets allocated on demand.
 	// It also allocates from the image memory arena because it has the same lifetime and to reduce maintenance.
-	if (spi == nullptr) spi = (SpritePositioningInfo*)ImageArena.Alloc(2 * sizeof(SpritePositioningInfo));
+	auto info = (SpritePositioningInfo*)ImageArena.Alloc(2 * sizeof(SpritePositioningInfo));
 	for (int i = 0; i < 2; i++)
 	{
-		auto& spi = this->spi[i];
+		auto& spi = info[i];
 		spi.mSpriteU[0] = spi.mSpriteV[0] = 0.f;
 		spi.mSpriteU[1] = spi.mSpriteV[1] = 1.f;
 		spi.spriteWidth = GetTexelWidth();
@@ -349,7 +357,8 @@ void FGameTexture::SetupSpriteData()
 			spi.spriteHeight += 2;
 		}
 	}
-	SetSpriteRect();
+	SetSpriteRect(info);
+	spi.store(info, std::memory_order_release);
 }
 
 //===========================================================================
@@ -360,8 +369,12 @@ void FGameTexture::SetupSpriteData()
 
 void FGameTexture::SetSpriteRect()
 {
+	auto info = spi.load(std::memory_order_acquire);
+	if (info) SetSpriteRect(info);
+}
 
-	if (!spi) return;
+void FGameTexture::SetSpriteRect(SpritePositioningInfo *info)
+{
 	auto leftOffset = GetTexelLeftOffset(r_spriteadjustHW);
 	auto topOffset = GetTexelTopOffset(r_spriteadjustHW);
 
@@ -370,7 +383,7 @@ void FGameTexture::SetSpriteRect()
 
 	for (int i = 0; i < 2; i++)
 	{
-		auto& spi = this->spi[i];
+		auto& spi = info[i];
 
 		// mSpriteRect is for positioning the sprite in the scene.
 		spi.mSpriteRect.left = -leftOffset / fxScale;
@@ -1,6 +1,7 @@
 #pragma once
 #include <stdint.h>
 #include <memory>
+#include <atomic>
 #include "vectors.h"
 #include "floatrect.h"
 #include "refcounted.h"
@@ -97,7 +98,7 @@ class FGameTexture
 
 	int8_t shouldUpscaleFlag = 1;
 	ETextureType UseType = ETextureType::Wall;	// This texture's primary purpose
-	SpritePositioningInfo* spi = nullptr;
+	std::atomic<SpritePositioningInfo*> spi = nullptr;	// published with release once complete, see SetupSpriteData
 
 	ISoftwareTexture* SoftwareTexture = nullptr;
 	FMaterial* Material[5] = {  };
@@ -142,6 +143,7 @@ public:
 	bool ShouldExpandSprite();
 	void SetupSpriteData();
 	void SetSpriteRect();
+	void SetSpriteRect(SpritePositioningInfo* info);
 
 	ETextureType GetUseType() const { return UseType; }
 	void SetUpscaleFlag(int what, bool manual = false) 
@@ -310,7 +312,16 @@ public:
 		DisplayHeight = TexelHeight / y;
 	}
 
-	const SpritePositioningInfo& GetSpritePositioning(int which) { if (spi == nullptr) SetupSpriteData(); return spi[which]; }
+	const SpritePositioningInfo& GetSpritePositioning(int which)
+	{
+		auto info = spi.load(std::memory_order_acquire);
+		if (info == nullptr)
+		{
+			SetupSpriteData();
+			info = spi.load(std::memory_order_acquire);
+		}
+		return info[which];
+	}
 	int GetAreas(FloatRect** pAreas) const;
 
 	bool GetTranslucency()
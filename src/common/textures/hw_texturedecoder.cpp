@@ -0,0 +1,411 @@
+/*
+** hw_texturedecoder.cpp
+** Background decoding of hardware texture data
+**
+**---------------------------------------------------------------------------
+** Copyright (C) 2026 Redemption Development Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Decoding an image, smoothing its edges and upscaling it can take long
+** enough to cause a visible hitch when a texture is first seen. Untranslated
+** image-backed textures are therefore decoded on a small thread pool. Until
+** the data is ready the backend gets a 1x1 placeholder, and once it is
+** ready the texture gets recreated, limited by a per-frame upload budget.
+**
+** Everything except the decoding itself happens on the main thread. The
+** job list is only touched there; the workers only change the state of
+** the job they work on. Anything the decoding finds out about the texture
+** itself is kept in the job and published when the buffer is collected.
+**
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "hw_texturedecoder.h"
+#include "image.h"
+#include "c_cvars.h"
+#include "stats.h"
+#include "ctpl.h"
+
+CVAR(Bool, gl_texture_asyncdecode, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVAR(Int, gl_texture_decodethreads, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)		// 0 picks a value from the number of cores
+CVAR(Int, gl_texture_uploadbudget, 8192, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)		// in KB per frame, 0 means unlimited
+CVAR(Float, gl_texture_hitchtime, 4.f, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)		// in ms
+
+enum
+{
+	JOB_Queued,
+	JOB_Running,
+	JOB_Done,
+	JOB_Failed,
+	JOB_Cancelled,
+
+	MAX_JOB_AGE = 300,	// frames a decoded buffer is kept around if nobody asks for it
+};
+
+struct FTexDecodeJob
+{
+	FTexture *Texture;
+	int Translation;
+	int Flags;
+	int Age = 0;
+	bool Granted = false;	// already counted against the upload budget
+	std::atomic<int> State { JOB_Queued };
+	FTexBufferState Info;	// the texture's state when the job was queued, updated by the decoding
+	FTextureBuffer Buffer;
+};
+
+using FTexDecodeJobPtr = std::shared_ptr<FTexDecodeJob>;
+
+struct FTexDecoder
+{
+	ctpl::thread_pool Pool;
+	std::mutex Mutex;
+	std::condition_variable Finished;
+	// The backends look up a texture's job on every bind. A texture rarely has more than one, so the per-texture lists are searched linearly.
+	std::unordered_map<FTexture *, std::vector<FTexDecodeJobPtr>> Jobs;
+
+	FTexDecoder(int threads) : Pool(threads) {}
+};
+
+static FTexDecoder *Decoder;
+static int64_t UploadBudget = INT64_MAX;
+static cycle_t SyncDecodeTime;
+static std::atomic<unsigned> DecodedCount;
+static unsigned UploadedCount, DeferredCount, SyncCount, HitchCount;
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static int GetDecodeThreadCount()
+{
+	if (gl_texture_decodethreads > 0) return min<int>(gl_texture_decodethreads, 16);
+	return clamp<int>(std::thread::hardware_concurrency() / 2, 1, 4);
+}
+
+static bool CanDecodeAsync(FTexture *tex, int translation, int flags)
+{
+	// Translated and indexed textures are cheap or depend on data that can change at any time.
+	// The precacher fills all textures in one go and shares image data between them, so it must not be interfered with.
+	return gl_texture_asyncdecode && translation <= 0 && !(flags & (CTF_Indexed | CTF_CheckOnly)) &&
+		tex->GetImage() != nullptr && !FImageSource::IsPrecaching();
+}
+
+static FTexDecodeJobPtr FindJob(FTexture *tex, int translation, int flags)
+{
+	if (Decoder == nullptr) return nullptr;
+	auto it = Decoder->Jobs.find(tex);
+	if (it == Decoder->Jobs.end()) return nullptr;
+	for (auto &job : it->second)
+	{
+		if (job->Translation == translation && job->Flags == flags) return job;
+	}
+	return nullptr;
+}
+
+static void RemoveJob(FTexDecodeJobPtr job)
+{
+	auto it = Decoder->Jobs.find(job->Texture);
+	auto &list = it->second;
+	list.erase(std::find(list.begin(), list.end(), job));
+	if (list.empty()) Decoder->Jobs.erase(it);
+}
+
+// Waits for a job that is already running. Queued jobs get cancelled instead.
+static void StopJob(const FTexDecodeJobPtr &job)
+{
+	int expected = JOB_Queued;
+	if (!job->State.compare_exchange_strong(expected, JOB_Cancelled))
+	{
+		std::unique_lock<std::mutex> lock(Decoder->Mutex);
+		Decoder->Finished.wait(lock, [&] { return job->State != JOB_Running; });
+	}
+}
+
+static bool ConsumeBudget(const FTextureBuffer &buffer)
+{
+	// At least one texture is let through per frame, no matter how large it is.
+	if (UploadBudget <= 0) return false;
+	UploadBudget -= (int64_t)buffer.mWidth * buffer.mHeight * 4;
+	return true;
+}
+
+//==========================================================================
+//
+// Runs on the decoder threads
+//
+//==========================================================================
+
+static void DecodeTexture(FTexDecodeJobPtr job)
+{
+	int expected = JOB_Queued;
+	if (!job->State.compare_exchange_strong(expected, JOB_Running)) return;
+
+	FTextureBuffer buffer;
+	try
+	{
+		buffer = job->Texture->CreateTexBuffer(job->Translation, job->Flags, &job->Info);
+	}
+	catch (...)
+	{
+		// The main thread will decode this again and report the error there.
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(Decoder->Mutex);
+		job->Buffer = std::move(buffer);
+		job->State = job->Buffer.mBuffer != nullptr ? JOB_Done : JOB_Failed;
+	}
+	DecodedCount++;
+	Decoder->Finished.notify_all();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static FTextureBuffer CreatePlaceholder(FTexture *tex)
+{
+	FTextureBuffer result;
+	// The backends expect one spare line at the end of the buffer.
+	result.mBuffer = new uint8_t[8];
+	memset(result.mBuffer, 0, 8);
+	if (!tex->isMasked())
+	{
+		result.mBuffer[0] = result.mBuffer[1] = result.mBuffer[2] = 0x40;
+		result.mBuffer[3] = 0xff;
+	}
+	result.mWidth = result.mHeight = 1;
+	return result;
+}
+
+static FTextureBuffer CreateSync(FTexture *tex, int translation, int flags)
+{
+	// Time spent in the precacher is part of loading the level and no hitch.
+	if (FImageSource::IsPrecaching()) return tex->CreateTexBuffer(translation, flags);
+
+	SyncCount++;
+	SyncDecodeTime.Clock();
+	auto buffer = tex->CreateTexBuffer(translation, flags);
+	SyncDecodeTime.Unclock();
+	return buffer;
+}
+
+FTextureBuffer TexDecoder_CreateTexBuffer(FTexture *tex, int translation, int flags, bool &placeholder)
+{
+	placeholder = false;
+	if (!CanDecodeAsync(tex, translation, flags)) return CreateSync(tex, translation, flags);
+
+	auto job = FindJob(tex, translation, flags);
+	if (job == nullptr)
+	{
+		if (Decoder == nullptr) Decoder = new FTexDecoder(GetDecodeThreadCount());
+
+		tex->GetImage()->PrepareForDecode();
+		auto newjob = std::make_shared<FTexDecodeJob>();
+		newjob->Texture = tex;
+		newjob->Translation = translation;
+		newjob->Flags = flags;
+		newjob->Info = tex->GetTexBufferState();
+		Decoder->Jobs[tex].push_back(newjob);
+		Decoder->Pool.push([=](int) { DecodeTexture(newjob); });
+	}
+	else if (job->State == JOB_Failed)
+	{
+		RemoveJob(job);
+		return CreateSync(tex, translation, flags);
+	}
+	else if (job->State == JOB_Done)
+	{
+		if (job->Granted || ConsumeBudget(job->Buffer))
+		{
+			FTextureBuffer buffer = std::move(job->Buffer);
+			RemoveJob(job);
+			tex->SetTexBufferState(job->Info);
+			if (tex->isMasked()) tex->FindHoles(buffer.mBuffer, buffer.mWidth, buffer.mHeight);
+			UploadedCount++;
+			return buffer;
+		}
+		DeferredCount++;
+	}
+	placeholder = true;
+	return CreatePlaceholder(tex);
+}
+
+bool TexDecoder_IsReady(FTexture *tex, int translation, int flags)
+{
+	if (Decoder == nullptr) return false;
+	auto job = FindJob(tex, translation, flags);
+	if (job == nullptr)
+	{
+		// The buffer was dropped for getting too old, so let the backend start a new job.
+		return true;
+	}
+	int state = job->State;
+	if (state == JOB_Failed) return true;
+	if (state != JOB_Done) return false;
+
+	// The budget is taken here already so that the backend does not drop the placeholder just to get another one.
+	if (!job->Granted)
+	{
+		if (!ConsumeBudget(job->Buffer))
+		{
+			DeferredCount++;
+			return false;
+		}
+		job->Granted = true;
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// Waits for the texture's running jobs and drops all of them.
+//
+//==========================================================================
+
+void TexDecoder_Cancel(FTexture *tex)
+{
+	if (Decoder == nullptr) return;
+
+	auto it = Decoder->Jobs.find(tex);
+	if (it == Decoder->Jobs.end()) return;
+	for (auto &job : it->second)
+	{
+		StopJob(job);
+	}
+	Decoder->Jobs.erase(it);
+}
+
+//==========================================================================
+//
+// Drops all jobs. The precacher does this before it changes the image
+// sources' precache data, which the decoding reads.
+//
+//==========================================================================
+
+void TexDecoder_CancelAll()
+{
+	if (Decoder == nullptr) return;
+
+	for (auto &pair : Decoder->Jobs)
+	{
+		for (auto &job : pair.second)
+		{
+			StopJob(job);
+		}
+	}
+	Decoder->Jobs.clear();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void TexDecoder_BeginFrame()
+{
+	if (SyncDecodeTime.TimeMS() > gl_texture_hitchtime) HitchCount++;
+	SyncDecodeTime.Reset();
+	UploadBudget = gl_texture_uploadbudget > 0 ? (int64_t)gl_texture_uploadbudget * 1024 : INT64_MAX;
+	DeferredCount = 0;
+
+	if (Decoder == nullptr) return;
+
+	auto &jobs = Decoder->Jobs;
+	for (auto it = jobs.begin(); it != jobs.end();)
+	{
+		auto &list = it->second;
+		list.erase(std::remove_if(list.begin(), list.end(), [](const FTexDecodeJobPtr &job)
+		{
+			return job->State == JOB_Done && ++job->Age > MAX_JOB_AGE;
+		}), list.end());
+		if (list.empty()) it = jobs.erase(it);
+		else ++it;
+	}
+	if (jobs.empty())
+	{
+		int threads = GetDecodeThreadCount();
+		if (Decoder->Pool.size() != threads) Decoder->Pool.resize(threads);
+	}
+}
+
+void TexDecoder_Shutdown()
+{
+	if (Decoder == nullptr) return;
+
+	for (auto &pair : Decoder->Jobs)
+	{
+		for (auto &job : pair.second)
+		{
+			int expected = JOB_Queued;
+			job->State.compare_exchange_strong(expected, JOB_Cancelled);
+		}
+	}
+	Decoder->Pool.stop(true);
+	delete Decoder;
+	Decoder = nullptr;
+}
+
+//==========================================================================
+//
+// STAT texdecode
+//
+//==========================================================================
+
+ADD_STAT(texdecode)
+{
+	FString out;
+	unsigned pending = 0, ready = 0;
+	if (Decoder != nullptr)
+	{
+		for (auto &pair : Decoder->Jobs)
+		{
+			for (auto &job : pair.second)
+			{
+				int state = job->State;
+				if (state == JOB_Done) ready++;
+				else if (state == JOB_Queued || state == JOB_Running) pending++;
+			}
+		}
+	}
+	out.Format("Pending: %u, Ready: %u, Decoded: %u, Uploaded: %u, Deferred: %u\nSync: %u (%.2f ms), Hitches: %u",
+		pending, ready, DecodedCount.load(), UploadedCount, DeferredCount, SyncCount, SyncDecodeTime.TimeMS(), HitchCount);
+	return out;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "textures.h"
+
+// Creates the buffer for a hardware texture. If the texture can be decoded in the background and
+// its data is not ready yet, a 1x1 placeholder is returned and 'placeholder' gets set.
+FTextureBuffer TexDecoder_CreateTexBuffer(FTexture *tex, int translation, int flags, bool &placeholder);
+
+// Checks whether a texture that got a placeholder can be recreated with the real data in this frame.
+bool TexDecoder_IsReady(FTexture *tex, int translation, int flags);
+
+void TexDecoder_Cancel(FTexture *tex);
+void TexDecoder_CancelAll();
+void TexDecoder_BeginFrame();
+void TexDecoder_Shutdown();
@@ -40,11 +40,13 @@
 #include "files.h"
 #include "cmdlib.h"
 #include "palettecontainer.h"
+#include "hw_texturedecoder.h"
 
 FMemArena ImageArena(32768);
 TArray<FImageSource *>FImageSource::ImageForLump;
 int FImageSource::NextID;
 static PrecacheInfo precacheInfo;
+static bool precaching;
 
 struct PrecacheDataPaletted
 {
@@ -295,13 +297,24 @@ void FImageSource::CollectForPrecache(PrecacheInfo &info, bool requiretruecolor)
 
 void FImageSource::BeginPrecaching()
 {
+	// Decoder jobs read precacheInfo, so none may be running while it gets refilled.
+	TexDecoder_CancelAll();
 	precacheInfo.Clear();
+	precaching = true;
 }
 
 void FImageSource::EndPrecaching()
 {
+	// Nothing may be left behind here. The texture decoder threads rely on these being empty outside the precaching block.
+	precacheInfo.Clear();
 	precacheDataPaletted.Clear();
 	precacheDataRgba.Clear();
+	precaching = false;
+}
+
+bool FImageSource::IsPrecaching()
+{
+	return precaching;
 }
 
 void FImageSource::RegisterForPrecache(FImageSource *img, bool requiretruecolor)
@@ -340,28 +353,49 @@ FImageSource *AutomapImage_TryCreate(FileReader &, int lumpnum);
 FImageSource *StartupPageImage_TryCreate(FileReader &, int lumpnum);
 
 
+static TexCreateInfo CreateInfo[] = {
+	{ IMGZImage_TryCreate,			false },
+	{ PNGImage_TryCreate,			false },
+	{ DDSImage_TryCreate,			false },
+	{ PCXImage_TryCreate,			false },
+	{ StbImage_TryCreate,			false },
+	{ QOIImage_TryCreate, 			false },
+	{ WebPImage_TryCreate,			false },
+	{ TGAImage_TryCreate,			false },
+	{ AnmImage_TryCreate,			false },
+	{ StartupPageImage_TryCreate,	false },
+	{ RawPageImage_TryCreate,		false },
+	{ FlatImage_TryCreate,			true },	// flat detection is not reliable, so only consider this for real flats.
+	{ PatchImage_TryCreate,			false },
+	{ EmptyImage_TryCreate,			false },
+	{ AutomapImage_TryCreate,		false },
+};
+
+FImageSource *ImageInfoCache_Find(int lumpnum, bool isflat, bool &found);
+void ImageInfoCache_Store(int lumpnum, bool isflat, int format, FImageSource *image);
+void ImageInfoCache_Reset();
+
+void FImageSource::ClearImages()
+{
+	ImageArena.FreeAll();
+	ImageForLump.Clear();
+	NextID = 0;
+	ImageInfoCache_Reset();
+}
+
+// Creates the image for a lump whose format is already known from the image info cache.
+FImageSource *CreateImageFromFormat(int format, int lumpnum)
+{
+	if ((unsigned)format >= countof(CreateInfo)) return nullptr;
+	auto data = fileSystem.OpenFileReader(lumpnum);
+	if (!data.isOpen()) return nullptr;
+	return CreateInfo[format].TryCreate(data, lumpnum);
+}
+
 // Examines the lump contents to decide what type of texture to create,
 // and creates the texture.
 FImageSource * FImageSource::GetImage(int lumpnum, bool isflat)
 {
-	static TexCreateInfo CreateInfo[] = {
-		{ IMGZImage_TryCreate,			false },
-		{ PNGImage_TryCreate,			false },
-		{ DDSImage_TryCreate,			false },
-		{ PCXImage_TryCreate,			false },
-		{ StbImage_TryCreate,			false },
-		{ QOIImage_TryCreate, 			false },
-		{ WebPImage_TryCreate,			false },
-		{ TGAImage_TryCreate,			false },
-		{ AnmImage_TryCreate,			false },
-		{ StartupPageImage_TryCreate,	false },
-		{ RawPageImage_TryCreate,		false },
-		{ FlatImage_TryCreate,			true },	// flat detection is not reliable, so only consider this for real flats.
-		{ PatchImage_TryCreate,			false },
-		{ EmptyImage_TryCreate,			false },
-		{ AutomapImage_TryCreate,		false },
-	};
-
 	if (lumpnum == -1) return nullptr;
 
 	unsigned size = ImageForLump.Size();
@@ -374,6 +408,15 @@ FImageSource * FImageSource::GetImage(int lumpnum, bool isflat)
 	// An image for this lump already exists. We do not need another one.
 	if (ImageForLump[lumpnum] != nullptr) return ImageForLump[lumpnum];
 
+	// If an earlier run already probed this lump, the lump data does not need to be looked at now.
+	bool found;
+	auto cached = ImageInfoCache_Find(lumpnum, isflat, found);
+	if (found)
+	{
+		ImageForLump[lumpnum] = cached;
+		return cached;
+	}
+
 	auto data = fileSystem.OpenFileReader(lumpnum);
 	if (!data.isOpen()) 
 		return nullptr;
@@ -386,9 +429,11 @@ FImageSource * FImageSource::GetImage(int lumpnum, bool isflat)
 			if (image != nullptr)
 			{
 				ImageForLump[lumpnum] = image;
+				ImageInfoCache_Store(lumpnum, isflat, (int)i, image);
 				return image;
 			}
 		}
 	}
+	ImageInfoCache_Store(lumpnum, isflat, -1, nullptr);
 	return nullptr;
 }
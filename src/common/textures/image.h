@@ -61,6 +61,7 @@ public:
 class FImageSource
 {
 	friend class FBrightmapTexture;
+	friend class FCachedImage;
 protected:
 
 	static TArray<FImageSource *>ImageForLump;
@@ -115,8 +116,9 @@ public:
 
 	FBitmap GetCachedBitmap(const PalEntry *remap, int conversion, int *trans = nullptr, int frame = 0);
 
-	static void ClearImages() { ImageArena.FreeAll(); ImageForLump.Clear(); NextID = 0; }
+	static void ClearImages();
 	static FImageSource * GetImage(int lumpnum, bool checkflat);
+	static void SaveInfoCache();
 
 	// Frame functions
 
@@ -173,9 +175,13 @@ public:
 		return bUseGamePalette;
 	}
 
+	// Called on the main thread before the pixels get created on a decoder thread.
+	virtual void PrepareForDecode() {}
+
 	virtual void CollectForPrecache(PrecacheInfo &info, bool requiretruecolor);
 	static void BeginPrecaching();
 	static void EndPrecaching();
+	static bool IsPrecaching();
 	static void RegisterForPrecache(FImageSource *img, bool requiretruecolor);
 };
 
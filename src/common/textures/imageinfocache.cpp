@@ -0,0 +1,404 @@
+/*
+** imageinfocache.cpp
+** Persistent cache of the image properties found by the image probers
+**
+**---------------------------------------------------------------------------
+** Copyright (C) 2026 Redemption Development Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Running every lump through the image probers means opening it and
+** reading its header, which takes a long time for large texture packs.
+** The results are stored per resource file, keyed by a hash of the file's
+** path, size and time stamp, so that later runs can create the image
+** sources from the cache without touching the lump data. The real image
+** only gets created once its pixels are needed.
+**
+*/
+
+#include <memory>
+#include <time.h>
+#include "image.h"
+#include "filesystem.h"
+#include "files.h"
+#include "cmdlib.h"
+#include "md5.h"
+#include "i_specialpaths.h"
+#include "c_cvars.h"
+#include "printf.h"
+
+CVAR(Bool, r_cacheimageinfo, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+FImageSource *CreateImageFromFormat(int format, int lumpnum);
+
+static const char ImageInfoMagic[4] = { 'Z', 'D', 'I', 'C' };
+
+enum
+{
+	IMAGEINFO_VERSION = 1,		// must be bumped when the prober list in image.cpp changes.
+	MAX_CACHED_FILES = 64,
+};
+
+struct FImageInfo
+{
+	enum
+	{
+		NoImage = 0xfe,		// none of the probers accepted the lump
+		Unknown = 0xff,		// not probed yet
+	};
+
+	enum
+	{
+		IIF_Flat = 1,		// probed with flat detection enabled
+		IIF_Masked = 2,
+		IIF_GamePalette = 4,
+		IIF_Remap0 = 8,
+	};
+
+	uint32_t LumpSize;
+	int32_t Width, Height;
+	int32_t LeftOffset, TopOffset;
+	int32_t NumOfFrames;
+	uint8_t Format;
+	uint8_t Flags;
+	int8_t Translucent;
+	uint8_t Padding;
+};
+
+static_assert(sizeof(FImageInfo) == 28, "FImageInfo is written to disk as is");
+
+struct FImageInfoFile
+{
+	uint8_t Key[16];
+	bool Used;
+	TArray<FImageInfo> Entries;
+};
+
+static TArray<FImageInfoFile> InfoFiles;
+static TArray<int> InfoFileForWad;
+static bool InfoLoaded, InfoInitialized, InfoDirty;
+
+//==========================================================================
+//
+// An image whose properties come from the cache. The real image is
+// created from the known format when the pixels are requested.
+//
+//==========================================================================
+
+class FCachedImage : public FImageSource
+{
+	FImageSource *Real = nullptr;
+	uint8_t Format;
+	bool Remap0;
+	bool Failed = false;
+
+	FImageSource *GetReal();
+	void Sync();
+
+public:
+	FCachedImage(int lumpnum, const FImageInfo &info);
+	static void Describe(FImageSource *image, FImageInfo &info);
+
+	bool SupportRemap0() override { return Real ? Real->SupportRemap0() : Remap0; }
+	void PrepareForDecode() override { GetReal(); }
+	int GetDurationOfFrame(int frame) override;
+	int CopyPixels(FBitmap *bmp, int conversion, int frame = 0) override;
+
+protected:
+	PalettedPixels CreatePalettedPixels(int conversion, int frame = 0) override;
+};
+
+FCachedImage::FCachedImage(int lumpnum, const FImageInfo &info) : FImageSource(lumpnum)
+{
+	Width = info.Width;
+	Height = info.Height;
+	LeftOffset = info.LeftOffset;
+	TopOffset = info.TopOffset;
+	NumOfFrames = info.NumOfFrames;
+	bUseGamePalette = !!(info.Flags & FImageInfo::IIF_GamePalette);
+	bMasked = !!(info.Flags & FImageInfo::IIF_Masked);
+	bTranslucent = info.Translucent;
+	Remap0 = !!(info.Flags & FImageInfo::IIF_Remap0);
+	Format = info.Format;
+}
+
+void FCachedImage::Describe(FImageSource *image, FImageInfo &info)
+{
+	info.Width = image->Width;
+	info.Height = image->Height;
+	info.LeftOffset = image->LeftOffset;
+	info.TopOffset = image->TopOffset;
+	info.NumOfFrames = image->NumOfFrames;
+	info.Translucent = image->bTranslucent;
+	info.Flags &= FImageInfo::IIF_Flat;
+	if (image->bMasked) info.Flags |= FImageInfo::IIF_Masked;
+	if (image->bUseGamePalette) info.Flags |= FImageInfo::IIF_GamePalette;
+	if (image->SupportRemap0()) info.Flags |= FImageInfo::IIF_Remap0;
+	info.Padding = 0;
+}
+
+FImageSource *FCachedImage::GetReal()
+{
+	if (Real == nullptr && !Failed)
+	{
+		Real = CreateImageFromFormat(Format, SourceLump);
+		// If the lump changed without the container noticing, the cached size is wrong and the image cannot be used.
+		if (Real == nullptr || Real->Width != Width || Real->Height != Height)
+		{
+			Printf("Cached image info for %s is outdated\n", fileSystem.GetFileFullName(SourceLump));
+			Real = nullptr;
+			Failed = true;
+		}
+	}
+	return Real;
+}
+
+// Decoding the pixels may have told the real image more about itself.
+void FCachedImage::Sync()
+{
+	bMasked = Real->bMasked;
+	if (Real->bTranslucent != -1) bTranslucent = Real->bTranslucent;
+}
+
+int FCachedImage::GetDurationOfFrame(int frame)
+{
+	return NumOfFrames > 1 && GetReal() ? Real->GetDurationOfFrame(frame) : FImageSource::GetDurationOfFrame(frame);
+}
+
+PalettedPixels FCachedImage::CreatePalettedPixels(int conversion, int frame)
+{
+	if (!GetReal()) return FImageSource::CreatePalettedPixels(conversion, frame);
+	auto pixels = Real->CreatePalettedPixels(conversion, frame);
+	Sync();
+	return pixels;
+}
+
+int FCachedImage::CopyPixels(FBitmap *bmp, int conversion, int frame)
+{
+	if (!GetReal()) return FImageSource::CopyPixels(bmp, conversion, frame);
+	int trans = Real->CopyPixels(bmp, conversion, frame);
+	Sync();
+	return trans;
+}
+
+//==========================================================================
+//
+// Cache file
+//
+//==========================================================================
+
+static FString ImageInfoCacheName(bool create)
+{
+	FString path = M_GetCachePath(create);
+	if (create) CreatePath(path.GetChars());
+	path << "/imageinfo.zdic";
+	return path;
+}
+
+static void LoadImageInfoCache()
+{
+	InfoLoaded = true;
+
+	FileReader fr;
+	if (!fr.OpenFile(ImageInfoCacheName(false).GetChars())) return;
+
+	char magic[4];
+	if (fr.Read(magic, 4) != 4 || memcmp(magic, ImageInfoMagic, 4) != 0) return;
+	if (fr.ReadUInt32() != IMAGEINFO_VERSION) return;
+
+	uint32_t numfiles = fr.ReadUInt32();
+	for (uint32_t i = 0; i < numfiles && i < MAX_CACHED_FILES; i++)
+	{
+		uint8_t key[16];
+		if (fr.Read(key, 16) != 16) break;
+		uint32_t count = fr.ReadUInt32();
+		if (count > 0x1000000) break;	// more than any resource file can hold, so the file must be damaged.
+
+		auto &file = InfoFiles[InfoFiles.Reserve(1)];
+		memcpy(file.Key, key, 16);
+		file.Used = false;
+		file.Entries.Resize(count);
+		if (fr.Read(file.Entries.Data(), count * sizeof(FImageInfo)) != (ptrdiff_t)(count * sizeof(FImageInfo)))
+		{
+			InfoFiles.Pop();
+			break;
+		}
+	}
+}
+
+void FImageSource::SaveInfoCache()
+{
+	if (!InfoInitialized) return;
+
+	// Collect what has been found out about the images since they were created.
+	for (unsigned i = 0; i < ImageForLump.Size(); i++)
+	{
+		if (ImageForLump[i] == nullptr) continue;
+		int wad = fileSystem.GetFileContainer(i);
+		if (wad < 0 || wad >= (int)InfoFileForWad.Size() || InfoFileForWad[wad] < 0) continue;
+
+		auto &entries = InfoFiles[InfoFileForWad[wad]].Entries;
+		unsigned index = i - fileSystem.GetFirstEntry(wad);
+		if (index >= entries.Size() || entries[index].Format >= FImageInfo::NoImage) continue;
+
+		FImageInfo info = entries[index];
+		FCachedImage::Describe(ImageForLump[i], info);
+		if (memcmp(&info, &entries[index], sizeof(info)))
+		{
+			entries[index] = info;
+			InfoDirty = true;
+		}
+	}
+	if (!InfoDirty) return;
+
+	std::unique_ptr<FileWriter> fw(FileWriter::Open(ImageInfoCacheName(true).GetChars()));
+	if (fw == nullptr) return;
+
+	// Files of the current setup come first so that they survive when the oldest entries get dropped.
+	TArray<FImageInfoFile *> files;
+	for (auto &file : InfoFiles) if (file.Used) files.Push(&file);
+	for (auto &file : InfoFiles) if (!file.Used && files.Size() < MAX_CACHED_FILES) files.Push(&file);
+
+	uint32_t version = IMAGEINFO_VERSION;
+	uint32_t numfiles = files.Size();
+	fw->Write(ImageInfoMagic, 4);
+	fw->Write(&version, sizeof(uint32_t));
+	fw->Write(&numfiles, sizeof(uint32_t));
+	for (auto file : files)
+	{
+		uint32_t count = file->Entries.Size();
+		fw->Write(file->Key, 16);
+		fw->Write(&count, sizeof(uint32_t));
+		fw->Write(file->Entries.Data(), count * sizeof(FImageInfo));
+	}
+	InfoDirty = false;
+}
+
+//==========================================================================
+//
+// Finds the cache entries for each loaded resource file. Files that are
+// not a plain file on disk, like directories or nested archives, are
+// not cached.
+//
+//==========================================================================
+
+static bool GetResourceFileKey(int wadnum, uint8_t *key)
+{
+	auto name = fileSystem.GetResourceFileFullName(wadnum);
+	size_t size;
+	time_t time;
+	if (name == nullptr || !GetFileInfo(name, &size, &time)) return false;
+
+	FString id;
+	id.Format("%s|%llu|%lld", name, (unsigned long long)size, (long long)time);
+	MD5Context md5;
+	md5.Update((const uint8_t *)id.GetChars(), (unsigned)id.Len());
+	md5.Final(key);
+	return true;
+}
+
+static void InitImageInfoCache()
+{
+	if (!InfoLoaded) LoadImageInfoCache();
+	InfoInitialized = true;
+
+	int numwads = fileSystem.GetNumWads();
+	InfoFileForWad.Resize(numwads);
+	for (int i = 0; i < numwads; i++)
+	{
+		uint8_t key[16];
+		InfoFileForWad[i] = -1;
+		if (!GetResourceFileKey(i, key)) continue;
+
+		unsigned count = fileSystem.GetLastEntry(i) - fileSystem.GetFirstEntry(i) + 1;
+		unsigned index = InfoFiles.FindEx([&](const FImageInfoFile &file) { return !memcmp(file.Key, key, 16); });
+		if (index == InfoFiles.Size())
+		{
+			index = InfoFiles.Reserve(1);
+			memcpy(InfoFiles[index].Key, key, 16);
+		}
+		auto &file = InfoFiles[index];
+		file.Used = true;
+		if (file.Entries.Size() != count)
+		{
+			file.Entries.Resize(count);
+			for (auto &entry : file.Entries) entry.Format = FImageInfo::Unknown;
+		}
+		InfoFileForWad[i] = index;
+	}
+}
+
+static FImageInfo *GetImageInfo(int lumpnum)
+{
+	if (!r_cacheimageinfo) return nullptr;
+	if (!InfoInitialized) InitImageInfoCache();
+
+	int wad = fileSystem.GetFileContainer(lumpnum);
+	if (wad < 0 || wad >= (int)InfoFileForWad.Size() || InfoFileForWad[wad] < 0) return nullptr;
+
+	auto &entries = InfoFiles[InfoFileForWad[wad]].Entries;
+	unsigned index = lumpnum - fileSystem.GetFirstEntry(wad);
+	return index < entries.Size() ? &entries[index] : nullptr;
+}
+
+//==========================================================================
+//
+// Interface for FImageSource::GetImage
+//
+//==========================================================================
+
+FImageSource *ImageInfoCache_Find(int lumpnum, bool isflat, bool &found)
+{
+	found = false;
+	auto info = GetImageInfo(lumpnum);
+	if (info == nullptr || info->Format == FImageInfo::Unknown) return nullptr;
+	if (!!(info->Flags & FImageInfo::IIF_Flat) != isflat) return nullptr;	// a different set of probers may accept it.
+	if (info->LumpSize != (uint32_t)fileSystem.FileLength(lumpnum)) return nullptr;
+
+	found = true;
+	if (info->Format == FImageInfo::NoImage) return nullptr;
+	return new FCachedImage(lumpnum, *info);
+}
+
+void ImageInfoCache_Store(int lumpnum, bool isflat, int format, FImageSource *image)
+{
+	auto info = GetImageInfo(lumpnum);
+	if (info == nullptr) return;
+
+	memset(info, 0, sizeof(*info));
+	info->LumpSize = (uint32_t)fileSystem.FileLength(lumpnum);
+	info->Format = format < 0 ? (uint8_t)FImageInfo::NoImage : (uint8_t)format;
+	info->Flags = isflat ? FImageInfo::IIF_Flat : 0;
+	if (image != nullptr) FCachedImage::Describe(image, *info);
+	InfoDirty = true;
+}
+
+// The resource files may be different after the images have been cleared.
+void ImageInfoCache_Reset()
+{
+	InfoInitialized = false;
+	InfoFileForWad.Clear();
+}
@@ -39,6 +39,7 @@
 #include "bitmap.h"
 #include "image.h"
 #include "textures.h"
+#include "hw_texturedecoder.h"
 
 
 //==========================================================================
@@ -60,6 +61,7 @@ FImageTexture::FImageTexture(FImageSource *img, int frame) noexcept
 
 FImageTexture::~FImageTexture()
 {
+	TexDecoder_Cancel(this);
 	delete mImage;
 }
 
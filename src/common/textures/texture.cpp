@@ -34,6 +34,7 @@
 **
 */
 
+#include <mutex>
 #include "printf.h"
 #include "files.h"
 #include "filesystem.h"
@@ -51,6 +52,7 @@
 #include "imagehelpers.h"
 #include "v_video.h"
 #include "v_font.h"
+#include "hw_texturedecoder.h"
 
 // Wrappers to keep the definitions of these classes out of here.
 IHardwareTexture* CreateHardwareTexture(int numchannels);
@@ -207,27 +209,42 @@ bool FTexture::FindHoles(const unsigned char* buffer, int w, int h)
 //
 //----------------------------------------------------------------------------
 
-void FTexture::CheckTrans(unsigned char* buffer, int size, int trans)
+int8_t FTexture::CalcTrans(const unsigned char* buffer, int size, int trans)
 {
-	if (bTranslucent == -1)
+	if (trans != -1) return trans;
+
+	const uint32_t* dwbuf = (const uint32_t*)buffer;
+	for (int i = 0; i < size; i++)
 	{
-		bTranslucent = trans;
-		if (trans == -1)
-		{
-			uint32_t* dwbuf = (uint32_t*)buffer;
-			for (int i = 0; i < size; i++)
-			{
-				uint32_t alpha = dwbuf[i] >> 24;
+		uint32_t alpha = dwbuf[i] >> 24;
 
-				if (alpha != 0xff && alpha != 0)
-				{
-					bTranslucent = 1;
-					return;
-				}
-			}
-			bTranslucent = 0;
+		if (alpha != 0xff && alpha != 0)
+		{
+			return 1;
 		}
 	}
+	return 0;
+}
+
+void FTexture::CheckTrans(unsigned char* buffer, int size, int trans)
+{
+	if (bTranslucent == -1)
+	{
+		bTranslucent = CalcTrans(buffer, size, trans);
+	}
+}
+
+//----------------------------------------------------------------------------
+//
+// Publishes what a decoder thread found out about the texture.
+// Must be called on the main thread.
+//
+//----------------------------------------------------------------------------
+
+void FTexture::SetTexBufferState(const FTexBufferState &state)
+{
+	Masked = Masked && state.Masked;
+	if (bTranslucent == -1) bTranslucent = state.Translucent;
 }
 
 
@@ -323,7 +340,7 @@ bool FTexture::ProcessData(unsigned char* buffer, int w, int h, bool ispatch)
 //
 //===========================================================================
 
-FTextureBuffer FTexture::CreateTexBuffer(int translation, int flags)
+FTextureBuffer FTexture::CreateTexBuffer(int translation, int flags, FTexBufferState *state)
 {
 	FTextureBuffer result;
 	if (flags & CTF_Indexed)
@@ -370,7 +387,12 @@ FTextureBuffer FTexture::CreateTexBuffer(int translation, int flags)
 				V_ApplyLuminosityTranslation(LuminosityTranslationDesc::fromInt(translation), buffer, W * H);
 			}
 
-			if (remap == nullptr)
+			if (remap == nullptr && state != nullptr)
+			{
+				if (state->Translucent == -1) state->Translucent = CalcTrans(buffer, W * H, trans);
+				isTransparent = state->Translucent;
+			}
+			else if (remap == nullptr)
 			{
 				CheckTrans(buffer, W * H, trans);
 				isTransparent = bTranslucent;
@@ -402,7 +424,12 @@ FTextureBuffer FTexture::CreateTexBuffer(int translation, int flags)
 		{
 			if (flags & CTF_Upscale) CreateUpsampledTextureBuffer(result, !!isTransparent, checkonly);
 
-			if (!checkonly) ProcessData(result.mBuffer, result.mWidth, result.mHeight, false);
+			// On a decoder thread the texture may not be changed. The hole list is left to the caller then.
+			if (!checkonly && state != nullptr)
+			{
+				if (state->Masked) state->Masked = SmoothEdges(result.mBuffer, result.mWidth, result.mHeight);
+			}
+			else if (!checkonly) ProcessData(result.mBuffer, result.mWidth, result.mHeight, false);
 		}
 	}
 	return result;
@@ -422,6 +449,21 @@ bool FTexture::DetermineTranslucency()
 	return !!bTranslucent;
 }
 
+//===========================================================================
+// 
+// The hardware renderer's BSP workers may test the same texture at the same
+// time, so the first check is serialized.
+//
+//===========================================================================
+
+static std::mutex TranslucencyMutex;
+
+bool FTexture::CheckTranslucency()
+{
+	std::lock_guard<std::mutex> lock(TranslucencyMutex);
+	return bTranslucent != -1 ? bTranslucent : DetermineTranslucency();
+}
+
 //===========================================================================
 // 
 // the default just returns an empty texture.
@@ -544,6 +586,19 @@ IHardwareTexture* FTexture::GetHardwareTexture(int translation, int scaleflags)
 	return hwtex;
 }
 
+//===========================================================================
+//
+// Pending decoder jobs for this texture become useless along with its
+// hardware textures.
+//
+//===========================================================================
+
+void FTexture::CleanHardwareTextures()
+{
+	TexDecoder_Cancel(this);
+	SystemTextures.Clean();
+}
+
 
 //==========================================================================
 //
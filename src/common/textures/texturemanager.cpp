@@ -1258,6 +1258,9 @@ void FTextureManager::AddTextures(void (*progressFunc_)(), void (*checkForHacks)
 		Textures[i].Texture->SetID(i);
 	}
 
+	// Remember what was found out about the lumps so that the next start does not need to probe them again.
+	FImageSource::SaveInfoCache();
+
 }
 
 //==========================================================================
@@ -202,6 +202,15 @@ struct FTextureBuffer
 
 };
 
+// Texture properties that CreateTexBuffer finds out while creating the buffer.
+// A decoder thread may not store them in the texture, so it gets a copy that
+// the main thread publishes with SetTexBufferState.
+struct FTexBufferState
+{
+	bool Masked;
+	int8_t Translucent;
+};
+
 // Base texture class
 class FTexture : public RefCountedBase
 {
@@ -227,10 +236,7 @@ public:
 	virtual FImageSource *GetImage() const { return nullptr; }
 	void CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasAlpha, bool checkonly);
 
-	void CleanHardwareTextures()
-	{
-		SystemTextures.Clean();
-	}
+	void CleanHardwareTextures();
 
 	void CleanPrecacheMarker()
 	{
@@ -249,6 +255,7 @@ public:
 
 	int GetWidth() { return Width; }
 	int GetHeight() { return Height; }
+	bool isMasked() const { return Masked; }
 
 	bool isHardwareCanvas() const { return bHasCanvas; }	// There's two here so that this can deal with software canvases in the hardware renderer later.
 	bool isCanvas() const { return bHasCanvas; }
@@ -288,15 +295,19 @@ public:
 	FTexture (int lumpnum = -1);
 
 public:
-	FTextureBuffer CreateTexBuffer(int translation, int flags = 0);
+	FTextureBuffer CreateTexBuffer(int translation, int flags = 0, FTexBufferState *state = nullptr);
+	FTexBufferState GetTexBufferState() const { return { Masked, bTranslucent }; }
+	void SetTexBufferState(const FTexBufferState &state);
 	virtual bool DetermineTranslucency();
+	bool CheckTranslucency();
 	bool GetTranslucency()
 	{
-		return bTranslucent != -1 ? bTranslucent : DetermineTranslucency();
+		return bTranslucent != -1 ? bTranslucent : CheckTranslucency();
 	}
 
 public:
 
+	static int8_t CalcTrans(const unsigned char * buffer, int size, int trans);
 	void CheckTrans(unsigned char * buffer, int size, int trans);
 	bool ProcessData(unsigned char * buffer, int w, int h, bool ispatch);
 	int CheckRealHeight();
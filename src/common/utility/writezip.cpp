@@ -181,7 +181,15 @@ int AppendCentralDirectory(FileWriter *zip_file, const FCompressedBuffer &conten
 	return 0;
 }
 
-bool WriteZip(const char* filename, const FCompressedBuffer* content, size_t contentcount)
+//==========================================================================
+//
+// WriteZip
+//
+// Writes the given buffers as a zip file to an already opened writer.
+//
+//==========================================================================
+
+bool WriteZip(FileWriter *f, const FCompressedBuffer* content, size_t contentcount)
 {
 	// try to determine local time
 	struct tm *ltime;
@@ -192,49 +200,46 @@ bool WriteZip(const char* filename, const FCompressedBuffer* content, size_t con
 
 	TArray<int> positions;
 
-	auto f = FileWriter::Open(filename);
-	if (f != nullptr)
+	for (size_t i = 0; i < contentcount; i++)
 	{
-		for (size_t i = 0; i < contentcount; i++)
-		{
-			int pos = AppendToZip(f, content[i], dostime);
-			if (pos == -1)
-			{
-				delete f;
-				remove(filename);
-				return false;
-			}
-			positions.Push(pos);
-		}
-
-		int dirofs = (int)f->Tell();
-		for (size_t i = 0; i < contentcount; i++)
+		int pos = AppendToZip(f, content[i], dostime);
+		if (pos == -1)
 		{
-			if (AppendCentralDirectory(f, content[i], dostime, positions[i]) < 0)
-			{
-				delete f;
-				remove(filename);
-				return false;
-			}
+			return false;
 		}
+		positions.Push(pos);
+	}
 
-		// Write the directory terminator.
-		FZipEndOfCentralDirectory dirend;
-		dirend.Magic = ZIP_ENDOFDIR;
-		dirend.DiskNumber = 0;
-		dirend.FirstDisk = 0;
-		dirend.NumEntriesOnAllDisks = dirend.NumEntries = LittleShort((uint16_t)contentcount);
-		dirend.DirectoryOffset = LittleLong((unsigned)dirofs);
-		dirend.DirectorySize = LittleLong((uint32_t)(f->Tell() - dirofs));
-		dirend.ZipCommentLength = 0;
-		if (f->Write(&dirend, sizeof(dirend)) != sizeof(dirend))
+	int dirofs = (int)f->Tell();
+	for (size_t i = 0; i < contentcount; i++)
+	{
+		if (AppendCentralDirectory(f, content[i], dostime, positions[i]) < 0)
 		{
-			delete f;
-			remove(filename);
 			return false;
 		}
+	}
+
+	// Write the directory terminator.
+	FZipEndOfCentralDirectory dirend;
+	dirend.Magic = ZIP_ENDOFDIR;
+	dirend.DiskNumber = 0;
+	dirend.FirstDisk = 0;
+	dirend.NumEntriesOnAllDisks = dirend.NumEntries = LittleShort((uint16_t)contentcount);
+	dirend.DirectoryOffset = LittleLong((unsigned)dirofs);
+	dirend.DirectorySize = LittleLong((uint32_t)(f->Tell() - dirofs));
+	dirend.ZipCommentLength = 0;
+	return f->Write(&dirend, sizeof(dirend)) == sizeof(dirend);
+}
+
+bool WriteZip(const char* filename, const FCompressedBuffer* content, size_t contentcount)
+{
+	auto f = FileWriter::Open(filename);
+	if (f != nullptr)
+	{
+		bool succeeded = WriteZip(f, content, contentcount);
 		delete f;
-		return true;
+		if (!succeeded) remove(filename);
+		return succeeded;
 	}
 	return false;
 }
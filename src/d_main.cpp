@@ -112,11 +112,13 @@
 #include "v_palette.h"
 #include "texturemanager.h"
 #include "hw_clock.h"
+#include "hw_texturedecoder.h"
 #include "hwrenderer/scene/hw_drawinfo.h"
 #include "doomfont.h"
 #include "screenjob.h"
 #include "startscreen.h"
 #include "shiftstate.h"
+#include "g_benchmark.h"
 
 #ifdef __unix__
 #include "i_system.h"  // for SHARE_DIR
@@ -326,6 +328,7 @@ CVAR(Bool, disableautoload, false, CVAR_ARCHIVE | CVAR_NOINITCALL | CVAR_GLOBALC
 CVAR(Bool, autoloadbrightmaps, false, CVAR_ARCHIVE | CVAR_NOINITCALL | CVAR_GLOBALCONFIG)
 CVAR(Bool, autoloadlights, false, CVAR_ARCHIVE | CVAR_NOINITCALL | CVAR_GLOBALCONFIG)
 CVAR(Bool, autoloadwidescreen, true, CVAR_ARCHIVE | CVAR_NOINITCALL | CVAR_GLOBALCONFIG)
+CVAR(Bool, fs_mapfiles, true, CVAR_ARCHIVE | CVAR_NOINITCALL | CVAR_GLOBALCONFIG)	// access resource files through memory mappings
 CVAR(Bool, r_debug_disable_vis_filter, false, 0)
 CVAR(Int, vid_showpalette, 0, 0)
 CUSTOM_CVAR (Bool, i_discordrpc, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
@@ -1020,6 +1023,7 @@ void D_Display ()
 	screen->FrameTime = I_msTimeFS();
 	TexAnim.UpdateAnimations(screen->FrameTime);
 	R_UpdateSky(screen->FrameTime);
+	TexDecoder_BeginFrame();
 	screen->BeginFrame();
 	twod->ClearClipRect();
 	if ((gamestate == GS_LEVEL || gamestate == GS_TITLELEVEL) && gametic != 0)
@@ -1174,6 +1178,7 @@ void D_Display ()
 	}
 	cycles.Unclock();
 	FrameCycles = cycles;
+	G_BenchmarkFrame();
 }
 
 //==========================================================================
@@ -1214,6 +1219,11 @@ void D_ErrorCleanup ()
 //
 //==========================================================================
 
+enum
+{
+	DEMOSEEK_FRAMETIME = 100,	// ms spent on running tics between frames while seeking
+};
+
 void D_DoomLoop ()
 {
 	int lasttic = 0;
@@ -1239,22 +1249,27 @@ void D_DoomLoop ()
 			I_SetFrameTime();
 
 			// process one or more tics
-			if (singletics)
+			if (singletics || G_IsDemoSeeking())
 			{
-				I_StartTic ();
-				D_ProcessEvents ();
-				G_BuildTiccmd (&netcmds[consoleplayer][maketic%BACKUPTICS]);
-				if (advancedemo)
-					D_DoAdvanceDemo ();
-				C_Ticker ();
-				M_Ticker ();
-				G_Ticker ();
-				// [RH] Use the consoleplayer's camera to update sounds
-				S_UpdateSounds (players[consoleplayer].camera);	// move positional sounds
-				gametic++;
-				maketic++;
-				GC::CheckGC ();
-				Net_NewMakeTic ();
+				// When seeking in a demo, run tics for a while before drawing the next frame.
+				uint64_t seekstart = I_msTime();
+				do
+				{
+					I_StartTic ();
+					D_ProcessEvents ();
+					G_BuildTiccmd (&netcmds[consoleplayer][maketic%BACKUPTICS]);
+					if (advancedemo)
+						D_DoAdvanceDemo ();
+					C_Ticker ();
+					M_Ticker ();
+					G_Ticker ();
+					// [RH] Use the consoleplayer's camera to update sounds
+					S_UpdateSounds (players[consoleplayer].camera);	// move positional sounds
+					gametic++;
+					maketic++;
+					GC::CheckGC ();
+					Net_NewMakeTic ();
+				} while (G_UpdateDemoSeek() && I_msTime() - seekstart < DEMOSEEK_FRAMETIME);
 			}
 			else
 			{
@@ -3219,6 +3234,7 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 
 
 	GetReserved(lfi);
+	lfi.mapfiles = fs_mapfiles;
 
 	lfi.postprocessFunc = [&]()
 	{
@@ -3580,6 +3596,15 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 		{
 			singledemo = true;				// quit after one demo
 			G_DeferedPlayDemo (v);
+
+			// -demoseek runs the demo up to the given tic. With -nodraw this is done
+			// without any output and the game quits at that point.
+			v = Args->CheckValue("-demoseek");
+			if (v != nullptr)
+			{
+				nodrawers = !!Args->CheckParm("-nodraw");
+				G_SetDemoSeek((int)strtol(v, nullptr, 10), nodrawers);
+			}
 		}
 		else
 		{
@@ -3876,6 +3901,7 @@ void D_Cleanup()
 	{
 		G_CheckDemoStatus();
 	}
+	G_FinishPendingSave(true);
 
 	// Music and sound should be stopped first
 	S_StopMusic(true);
@@ -3909,6 +3935,7 @@ void D_Cleanup()
 	savegameManager.ClearSaveGames();
 	LightDefaults.DeleteAndClear();			// this can leak heap memory if it isn't cleared.
 	TexAnim.DeleteAll();
+	TexDecoder_Shutdown();
 	TexMan.DeleteAll();
 	
 	// delete GameStartupInfo data
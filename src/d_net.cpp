@@ -72,6 +72,7 @@
 #include "d_main.h"
 #include "i_interface.h"
 #include "savegamemanager.h"
+#include "d_worldhash.h"
 
 EXTERN_CVAR (Int, disableautosave)
 EXTERN_CVAR (Int, autosavecount)
@@ -2753,6 +2754,10 @@ void Net_DoCommand (int type, uint8_t **stream, int player)
 			primaryLevel->localEventManager->NetCommand(netCmd);
 		}
 	break;
+
+	case DEM_WORLDHASH:
+		D_ReadWorldHash(player, stream);
+		break;
 		
 	default:
 		I_Error ("Unknown net command: %d", type);
@@ -2855,6 +2860,10 @@ void Net_SkipCommand (int type, uint8_t **stream)
 			skip = 8;
 			break;
 
+		case DEM_WORLDHASH:
+			skip = 16;
+			break;
+
 		case DEM_GENERICCHEAT:
 		case DEM_DROPPLAYER:
 		case DEM_ADDCONTROLLER:
@@ -164,6 +164,7 @@ enum EDemoCommand
 	DEM_SETINV,			// 72 SetInventory
 	DEM_ENDSCREENJOB,
 	DEM_ZSC_CMD,		// 74 String: Command, Word: Byte size of command
+	DEM_WORLDHASH,		// 75 Int: Tic, Int: Actor hash, Int: Sector hash, Int: RNG hash
 };
 
 // The following are implemented by cht_DoCheat in m_cheat.cpp
@@ -0,0 +1,425 @@
+/*
+** d_worldhash.cpp
+** World state hashes for finding desyncs in netgames and demos
+**
+**---------------------------------------------------------------------------
+** Copyright (C) 2026 Redemption Development Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** The consistancy check in the ticcmds only covers the player's position
+** and a few RNGs, so it can tell that a game went out of sync but not why.
+**
+** With sv_worldhash set to n, every n-th tic the actors, sectors and RNGs
+** are hashed and the result is sent as DEM_WORLDHASH. Other machines compare
+** it against their own hash of the same tic, and demo playback compares it
+** against the recorded one. On the first mismatch the per-object hashes of
+** that tic are written to a text file. Diffing the files from both sides
+** shows the first object that diverged.
+**
+** Tics are counted with the level's totaltime, which is the same on all
+** machines and in demo playback, unlike gametic.
+**
+*/
+
+#include <string.h>
+#include <stdio.h>
+#include "doomstat.h"
+#include "d_net.h"
+#include "d_protocol.h"
+#include "d_worldhash.h"
+#include "g_levellocals.h"
+#include "c_dispatch.h"
+#include "c_cvars.h"
+#include "m_random.h"
+#include "m_crc32.h"
+#include "actor.h"
+#include "v_text.h"
+#include "printf.h"
+
+CVAR(Int, sv_worldhash, 0, CVAR_SERVERINFO | CVAR_NOSAVE)
+
+enum
+{
+	WORLDHASH_HISTORY = 128,	// tics whose hashes are kept for comparison
+	WORLDHASH_DETAILS = 16,		// tics whose per-object hashes are kept for dumps
+};
+
+struct FActorHashEntry
+{
+	FName Class;
+	DVector3 Pos;
+	int Health;
+	uint32_t Hash;
+};
+
+struct FRNGHashEntry
+{
+	uint32_t NameCRC;
+	int Index;
+	uint32_t Value;
+};
+
+struct FWorldHashDetail
+{
+	FWorldHash Hash = { -1, 0, 0, 0 };
+	TArray<FActorHashEntry> Actors;
+	TArray<uint32_t> Sectors;
+	TArray<FRNGHashEntry> RNGs;
+};
+
+static FWorldHash WorldHashes[WORLDHASH_HISTORY];
+static FWorldHashDetail WorldHashDetails[WORLDHASH_DETAILS];
+static unsigned NumWorldHashes;
+static unsigned NumWorldHashDetails;
+static int WorldHashMismatches;
+static bool WorldHashReported;
+
+// These RNGs are named but get called from the renderer and the sound code,
+// so their state is not the same on different machines.
+static const char *const UnsyncedRNGs[] = { "TorchFlicker", "RandSound" };
+
+//==========================================================================
+//
+// 64 bit FNV-1a over whole values, folded to 32 bits at the end
+//
+//==========================================================================
+
+struct FWorldHasher
+{
+	uint64_t h = 0xcbf29ce484222325ull;
+
+	void Add(uint64_t v)
+	{
+		h = (h ^ v) * 0x100000001b3ull;
+	}
+	void AddDouble(double v)
+	{
+		uint64_t bits;
+		memcpy(&bits, &v, sizeof(bits));
+		Add(bits);
+	}
+	void AddVector(const DVector3 &v)
+	{
+		AddDouble(v.X);
+		AddDouble(v.Y);
+		AddDouble(v.Z);
+	}
+	uint32_t Result() const
+	{
+		return uint32_t(h ^ (h >> 32));
+	}
+};
+
+//==========================================================================
+//
+// CalcWorldHash
+//
+//==========================================================================
+
+static bool IsUnsyncedRNG(uint32_t namecrc)
+{
+	static uint32_t crcs[countof(UnsyncedRNGs)];
+	if (crcs[0] == 0)
+	{
+		for (unsigned i = 0; i < countof(UnsyncedRNGs); i++)
+		{
+			crcs[i] = CalcCRC32((const uint8_t *)UnsyncedRNGs[i], (unsigned)strlen(UnsyncedRNGs[i]));
+		}
+	}
+	for (auto crc : crcs)
+	{
+		if (crc == namecrc) return true;
+	}
+	return false;
+}
+
+static void CalcWorldHash(FLevelLocals *Level, int tic, FWorldHashDetail &detail)
+{
+	FWorldHasher actors, sectors, rngs;
+
+	detail.Actors.Clear();
+	detail.Sectors.Clear();
+	detail.RNGs.Clear();
+
+	auto it = Level->GetThinkerIterator<AActor>();
+	AActor *mo;
+	while ((mo = it.Next()))
+	{
+		FWorldHasher h;
+		h.Add(mo->GetClass()->TypeName.GetIndex());
+		h.AddVector(mo->Pos());
+		h.AddVector(mo->Vel);
+		h.AddDouble(mo->Angles.Yaw.Degrees());
+		h.Add(mo->health);
+		h.Add(mo->sprite);
+		h.Add(mo->frame);
+		h.Add(mo->tics);
+		h.Add(mo->flags.GetValue());
+
+		uint32_t result = h.Result();
+		actors.Add(result);
+		detail.Actors.Push({ mo->GetClass()->TypeName, mo->Pos(), mo->health, result });
+	}
+
+	for (auto &sec : Level->sectors)
+	{
+		FWorldHasher h;
+		h.AddDouble(sec.floorplane.fD());
+		h.AddDouble(sec.ceilingplane.fD());
+		h.Add(sec.lightlevel);
+
+		uint32_t result = h.Result();
+		sectors.Add(result);
+		detail.Sectors.Push(result);
+	}
+
+	FRandom::StaticIterateSeeds([&](uint32_t namecrc, int index, uint32_t value)
+	{
+		if (IsUnsyncedRNG(namecrc)) return;
+		rngs.Add(namecrc);
+		rngs.Add(index);
+		rngs.Add(value);
+		detail.RNGs.Push({ namecrc, index, value });
+	});
+
+	detail.Hash = { tic, actors.Result(), sectors.Result(), rngs.Result() };
+}
+
+//==========================================================================
+//
+// ClearWorldHashes
+//
+//==========================================================================
+
+static void ClearWorldHashes()
+{
+	NumWorldHashes = 0;
+	NumWorldHashDetails = 0;
+	WorldHashMismatches = 0;
+	WorldHashReported = false;
+	for (auto &detail : WorldHashDetails)
+	{
+		detail.Hash.Tic = -1;
+	}
+}
+
+static const FWorldHash *FindWorldHash(int tic)
+{
+	unsigned count = min<unsigned>(NumWorldHashes, WORLDHASH_HISTORY);
+	for (unsigned i = 1; i <= count; i++)
+	{
+		auto &hash = WorldHashes[(NumWorldHashes - i) % WORLDHASH_HISTORY];
+		if (hash.Tic == tic) return &hash;
+	}
+	return nullptr;
+}
+
+static const FWorldHashDetail *FindWorldHashDetail(int tic)
+{
+	for (auto &detail : WorldHashDetails)
+	{
+		if (tic >= 0 && detail.Hash.Tic == tic) return &detail;
+	}
+	return nullptr;
+}
+
+//==========================================================================
+//
+// D_WorldHashTic
+//
+// Called at the end of every tic.
+//
+//==========================================================================
+
+void D_WorldHashTic()
+{
+	if (sv_worldhash <= 0 || gamestate != GS_LEVEL || !(netgame || demorecording || demoplayback))
+	{
+		return;
+	}
+
+	int tic = primaryLevel->totaltime;
+	if (tic % sv_worldhash != 0)
+	{
+		return;
+	}
+	if (NumWorldHashes > 0)
+	{
+		int last = WorldHashes[(NumWorldHashes - 1) % WORLDHASH_HISTORY].Tic;
+		if (last == tic) return;		// paused
+		if (last > tic) ClearWorldHashes();	// a savegame was loaded
+	}
+
+	auto &detail = WorldHashDetails[NumWorldHashDetails++ % WORLDHASH_DETAILS];
+	CalcWorldHash(primaryLevel, tic, detail);
+	WorldHashes[NumWorldHashes++ % WORLDHASH_HISTORY] = detail.Hash;
+
+	if (!demoplayback)
+	{
+		Net_WriteInt8(DEM_WORLDHASH);
+		Net_WriteInt32(detail.Hash.Tic);
+		Net_WriteInt32(detail.Hash.Actors);
+		Net_WriteInt32(detail.Hash.Sectors);
+		Net_WriteInt32(detail.Hash.RNG);
+	}
+}
+
+//==========================================================================
+//
+// DumpWorldHash
+//
+// One line per object so that the files from two machines can be diffed.
+// If the requested tic is no longer kept, the current state is written.
+//
+//==========================================================================
+
+static bool DumpWorldHash(const char *filename, int tic)
+{
+	FWorldHashDetail current;
+	const FWorldHashDetail *detail = FindWorldHashDetail(tic);
+	if (detail == nullptr)
+	{
+		CalcWorldHash(primaryLevel, primaryLevel->totaltime, current);
+		detail = &current;
+	}
+
+	FILE *f = fopen(filename, "w");
+	if (f == nullptr) return false;
+
+	auto &hash = detail->Hash;
+	fprintf(f, "tic %d actors %08x sectors %08x rng %08x\n", hash.Tic, hash.Actors, hash.Sectors, hash.RNG);
+	for (unsigned i = 0; i < detail->RNGs.Size(); i++)
+	{
+		auto &rng = detail->RNGs[i];
+		fprintf(f, "rng %08x %d %08x\n", rng.NameCRC, rng.Index, rng.Value);
+	}
+	for (unsigned i = 0; i < detail->Sectors.Size(); i++)
+	{
+		fprintf(f, "sector %u %08x\n", i, detail->Sectors[i]);
+	}
+	for (unsigned i = 0; i < detail->Actors.Size(); i++)
+	{
+		auto &actor = detail->Actors[i];
+		fprintf(f, "actor %u %08x %s (%g, %g, %g) health %d\n", i, actor.Hash, actor.Class.GetChars(),
+			actor.Pos.X, actor.Pos.Y, actor.Pos.Z, actor.Health);
+	}
+	fclose(f);
+	return true;
+}
+
+//==========================================================================
+//
+// D_ReadWorldHash
+//
+// Handles DEM_WORLDHASH.
+//
+//==========================================================================
+
+void D_ReadWorldHash(int player, uint8_t **stream)
+{
+	FWorldHash remote;
+	remote.Tic = ReadInt32(stream);
+	remote.Actors = ReadInt32(stream);
+	remote.Sectors = ReadInt32(stream);
+	remote.RNG = ReadInt32(stream);
+
+	if (player == consoleplayer && !demoplayback)
+	{
+		return;
+	}
+
+	auto local = FindWorldHash(remote.Tic);
+	if (local == nullptr || *local == remote)
+	{
+		return;
+	}
+
+	WorldHashMismatches++;
+	if (WorldHashReported)
+	{
+		return;
+	}
+	WorldHashReported = true;
+
+	FString parts;
+	if (local->Actors != remote.Actors) parts << " actors";
+	if (local->Sectors != remote.Sectors) parts << " sectors";
+	if (local->RNG != remote.RNG) parts << " rng";
+
+	const char *source = demoplayback ? "the demo" : players[player].userinfo.GetName();
+	Printf(TEXTCOLOR_RED "World state differs from %s at tic %d:%s\n", source, remote.Tic, parts.GetChars());
+
+	FString filename;
+	filename.Format("worldhash_%d_p%d.txt", remote.Tic, consoleplayer);
+	if (DumpWorldHash(filename.GetChars(), remote.Tic))
+	{
+		Printf("Local world state written to %s\n", filename.GetChars());
+	}
+}
+
+//==========================================================================
+//
+// CCMD worldhash
+//
+//==========================================================================
+
+CCMD(worldhash)
+{
+	if (argv.argc() > 2 && !stricmp(argv[1], "dump"))
+	{
+		if (gamestate != GS_LEVEL)
+		{
+			Printf("Not in a level\n");
+		}
+		else if (DumpWorldHash(argv[2], argv.argc() > 3 ? atoi(argv[3]) : -1))
+		{
+			Printf("World state written to %s\n", argv[2]);
+		}
+		else
+		{
+			Printf(TEXTCOLOR_RED "Unable to write %s\n", argv[2]);
+		}
+		return;
+	}
+	if (argv.argc() > 1)
+	{
+		Printf("Usage: worldhash [dump <filename> [tic]]\n");
+		return;
+	}
+
+	if (sv_worldhash <= 0)
+	{
+		Printf("World hashes are off. Set sv_worldhash to the number of tics between checks.\n");
+		return;
+	}
+	Printf("Hashing every %d tics, %d mismatches\n", *sv_worldhash, WorldHashMismatches);
+	if (NumWorldHashes > 0)
+	{
+		auto &hash = WorldHashes[(NumWorldHashes - 1) % WORLDHASH_HISTORY];
+		Printf("Tic %d: actors %08x sectors %08x rng %08x\n", hash.Tic, hash.Actors, hash.Sectors, hash.RNG);
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdint.h>
+
+// Hashes of the playsim state at the end of a tic, split by category so that
+// a mismatch tells which part of the world diverged.
+struct FWorldHash
+{
+	int Tic;
+	uint32_t Actors;
+	uint32_t Sectors;
+	uint32_t RNG;
+
+	bool operator==(const FWorldHash &other) const
+	{
+		return Tic == other.Tic && Actors == other.Actors && Sectors == other.Sectors && RNG == other.RNG;
+	}
+	bool operator!=(const FWorldHash &other) const { return !(*this == other); }
+};
+
+void D_WorldHashTic();
+void D_ReadWorldHash(int player, uint8_t **stream);
@@ -0,0 +1,339 @@
+/*
+** g_benchmark.cpp
+** Benchmark results for timed demos
+**
+**---------------------------------------------------------------------------
+** Copyright (C) 2026 Redemption Development Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Timedemo benchmark recording. Collects per-tic playsim times and
+** per-frame render times from the existing profiling clocks while a
+** demo is being timed and writes them out as JSON or CSV with
+** percentiles, so that runs can be compared by scripts.
+**
+*/
+
+#define RAPIDJSON_48BITPOINTER_OPTIMIZATION 0	// disable this insanity which is bound to make the code break over time.
+#define RAPIDJSON_HAS_CXX11_RVALUE_REFS 1
+#define RAPIDJSON_HAS_CXX11_RANGE_FOR 1
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+#include "rapidjson/rapidjson.h"
+#include "rapidjson/prettywriter.h"
+#include "g_benchmark.h"
+#include "doomdef.h"
+#include "doomstat.h"
+#include "gamestate.h"
+#include "d_main.h"
+#include "stats.h"
+#include "hw_clock.h"
+#include "version.h"
+#include "printf.h"
+#include "tarray.h"
+#include "zstring.h"
+
+extern cycle_t FrameCycles;
+extern cycle_t ThinkCycles;
+extern cycle_t ActionCycles;
+extern bool timingdemo;
+
+namespace swrenderer
+{
+	extern cycle_t WallCycles, PlaneCycles, MaskedCycles;
+}
+
+struct FBenchSeries
+{
+	const char *Name;
+	TArray<double> Samples;
+};
+
+enum
+{
+	BENCH_Tic,
+	BENCH_Think,
+	BENCH_Action,
+	BENCH_NumTicSeries,
+
+	BENCH_Frame = BENCH_NumTicSeries,
+	BENCH_SWWalls,
+	BENCH_SWPlanes,
+	BENCH_SWMasked,
+	BENCH_HWBsp,
+	BENCH_HWWalls,
+	BENCH_HWFlats,
+	BENCH_HWSprites,
+	BENCH_HWDrawcalls,
+	BENCH_NumSeries
+};
+
+static FBenchSeries BenchSeries[BENCH_NumSeries] =
+{
+	{ "tic" }, { "think" }, { "action" },
+	{ "frame" }, { "sw_walls" }, { "sw_planes" }, { "sw_masked" },
+	{ "hw_bsp" }, { "hw_walls" }, { "hw_flats" }, { "hw_sprites" }, { "hw_drawcalls" },
+};
+
+static FString BenchOutFile;
+
+struct FBenchSummary
+{
+	double Mean, Min, Max, P50, P90, P95, P99;
+};
+
+//==========================================================================
+//
+// Nearest-rank percentile of sorted samples
+//
+//==========================================================================
+
+static double Percentile(const TArray<double> &sorted, double pct)
+{
+	unsigned rank = (unsigned)ceil(pct / 100. * sorted.Size());
+	return sorted[clamp<unsigned>(rank, 1, sorted.Size()) - 1];
+}
+
+static FBenchSummary Summarize(const TArray<double> &samples)
+{
+	TArray<double> sorted = samples;
+	std::sort(sorted.begin(), sorted.end());
+
+	FBenchSummary sum;
+	double total = 0;
+	for (double s : sorted) total += s;
+	sum.Mean = total / sorted.Size();
+	sum.Min = sorted[0];
+	sum.Max = sorted.Last();
+	sum.P50 = Percentile(sorted, 50);
+	sum.P90 = Percentile(sorted, 90);
+	sum.P95 = Percentile(sorted, 95);
+	sum.P99 = Percentile(sorted, 99);
+	return sum;
+}
+
+// Series that never saw a non-zero sample belong to the renderer that was not in use.
+static bool SeriesUsed(const FBenchSeries &series)
+{
+	for (double s : series.Samples)
+	{
+		if (s != 0) return true;
+	}
+	return false;
+}
+
+//==========================================================================
+//
+// G_BenchmarkStart
+//
+//==========================================================================
+
+void G_BenchmarkStart(const char *outfile)
+{
+	BenchOutFile = outfile;
+	for (auto &series : BenchSeries)
+	{
+		series.Samples.Clear();
+	}
+	// The hardware renderer only runs its clocks when something asks for them.
+	SetBenchmarkClocks(true);
+}
+
+bool G_BenchmarkActive()
+{
+	return BenchOutFile.IsNotEmpty() && timingdemo && demoplayback;
+}
+
+//==========================================================================
+//
+// G_BenchmarkTic
+//
+// Called after each playsim tic.
+//
+//==========================================================================
+
+void G_BenchmarkTic(double playsimms)
+{
+	if (!G_BenchmarkActive()) return;
+
+	BenchSeries[BENCH_Tic].Samples.Push(playsimms);
+	BenchSeries[BENCH_Think].Samples.Push(ThinkCycles.TimeMS());
+	BenchSeries[BENCH_Action].Samples.Push(ActionCycles.TimeMS());
+}
+
+//==========================================================================
+//
+// G_BenchmarkFrame
+//
+// Called after each frame has been drawn.
+//
+//==========================================================================
+
+void G_BenchmarkFrame()
+{
+	if (!G_BenchmarkActive() || gamestate != GS_LEVEL) return;
+
+	BenchSeries[BENCH_Frame].Samples.Push(FrameCycles.TimeMS());
+	if (!V_IsHardwareRenderer())
+	{
+		BenchSeries[BENCH_SWWalls].Samples.Push(swrenderer::WallCycles.TimeMS());
+		BenchSeries[BENCH_SWPlanes].Samples.Push(swrenderer::PlaneCycles.TimeMS());
+		BenchSeries[BENCH_SWMasked].Samples.Push(swrenderer::MaskedCycles.TimeMS());
+	}
+	else
+	{
+		BenchSeries[BENCH_HWBsp].Samples.Push(Bsp.TimeMS());
+		BenchSeries[BENCH_HWWalls].Samples.Push(RenderWall.TimeMS());
+		BenchSeries[BENCH_HWFlats].Samples.Push(RenderFlat.TimeMS());
+		BenchSeries[BENCH_HWSprites].Samples.Push(RenderSprite.TimeMS());
+		BenchSeries[BENCH_HWDrawcalls].Samples.Push(drawcalls.TimeMS());
+	}
+}
+
+//==========================================================================
+//
+// Output
+//
+//==========================================================================
+
+static void WriteJSON(FILE *f, const char *demoname, int gametics, int realtics)
+{
+	rapidjson::StringBuffer buffer;
+	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+	writer.SetIndent('\t', 1);
+	writer.SetFormatOptions(rapidjson::kFormatSingleLineArray);
+	writer.SetMaxDecimalPlaces(4);
+
+	FString demo = demoname;
+	demo.Substitute("\\", "/");
+
+	writer.StartObject();
+	writer.Key("version");
+	writer.String(GetVersionString());
+	writer.Key("demo");
+	writer.String(demo.GetChars());
+	writer.Key("renderer");
+	writer.String(V_IsHardwareRenderer() ? "hardware" : "software");
+	writer.Key("gametics");
+	writer.Int(gametics);
+	writer.Key("realtics");
+	writer.Int(realtics);
+	writer.Key("fps");
+	writer.Double(realtics > 0 ? (double)gametics / realtics * TICRATE : 0.);
+
+	writer.Key("series");
+	writer.StartObject();
+	for (auto &series : BenchSeries)
+	{
+		if (!SeriesUsed(series)) continue;
+
+		auto sum = Summarize(series.Samples);
+		writer.Key(series.Name);
+		writer.StartObject();
+		writer.Key("count");
+		writer.Uint(series.Samples.Size());
+		writer.Key("mean");
+		writer.Double(sum.Mean);
+		writer.Key("min");
+		writer.Double(sum.Min);
+		writer.Key("max");
+		writer.Double(sum.Max);
+		writer.Key("p50");
+		writer.Double(sum.P50);
+		writer.Key("p90");
+		writer.Double(sum.P90);
+		writer.Key("p95");
+		writer.Double(sum.P95);
+		writer.Key("p99");
+		writer.Double(sum.P99);
+		writer.Key("samples");
+		writer.StartArray();
+		for (double sample : series.Samples)
+		{
+			writer.Double(sample);
+		}
+		writer.EndArray();
+		writer.EndObject();
+	}
+	writer.EndObject();
+	writer.EndObject();
+
+	fwrite(buffer.GetString(), 1, buffer.GetSize(), f);
+	fputc('\n', f);
+}
+
+static void WriteCSV(FILE *f)
+{
+	fprintf(f, "series,count,mean,min,max,p50,p90,p95,p99\n");
+	for (auto &series : BenchSeries)
+	{
+		if (!SeriesUsed(series)) continue;
+
+		auto sum = Summarize(series.Samples);
+		fprintf(f, "%s,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+			series.Name, series.Samples.Size(), sum.Mean, sum.Min, sum.Max, sum.P50, sum.P90, sum.P95, sum.P99);
+	}
+}
+
+//==========================================================================
+//
+// G_BenchmarkFinish
+//
+// Writes the collected data. The format is picked from the file extension:
+// .csv writes one summary row per series, anything else writes JSON with
+// the summaries and the raw samples.
+//
+//==========================================================================
+
+void G_BenchmarkFinish(const char *demoname, int gametics, int realtics)
+{
+	if (BenchOutFile.IsEmpty()) return;
+
+	FILE *f = fopen(BenchOutFile.GetChars(), "w");
+	if (f == nullptr)
+	{
+		Printf(TEXTCOLOR_RED "Unable to write benchmark results to %s\n", BenchOutFile.GetChars());
+	}
+	else
+	{
+		if (BenchOutFile.Len() >= 4 && !BenchOutFile.Right(4).CompareNoCase(".csv"))
+			WriteCSV(f);
+		else
+			WriteJSON(f, demoname, gametics, realtics);
+		fclose(f);
+		Printf("Benchmark results written to %s\n", BenchOutFile.GetChars());
+	}
+
+	for (auto &series : BenchSeries)
+	{
+		series.Samples.Reset();
+	}
+	BenchOutFile = "";
+	SetBenchmarkClocks(false);
+}
@@ -0,0 +1,12 @@
+#ifndef __G_BENCHMARK_H
+#define __G_BENCHMARK_H
+
+// Timedemo benchmark recording (-timedemo <demo> -benchout <file>)
+
+void G_BenchmarkStart(const char *outfile);
+bool G_BenchmarkActive();
+void G_BenchmarkTic(double playsimms);
+void G_BenchmarkFrame();
+void G_BenchmarkFinish(const char *demoname, int gametics, int realtics);
+
+#endif
@@ -80,25 +80,12 @@ CCMD(listlights)
 			}
 			
 			
-			FLightNode * node;
-			
-			node=dl->touching_sides;
-			
-			while (node)
-			{
-				walls++;
-				allwalls++;
-				node = node->nextTarget;
-			}
-			
-			
-			node = dl->touching_sector;
-			
-			while (node)
+			if (dl->links)
 			{
-				allsectors++;
-				sectors++;
-				node = node->nextTarget;
+				walls = dl->links->Sides.Size();
+				sectors = dl->links->Sections.Size();
+				allwalls += walls;
+				allsectors += sectors;
 			}
 			Printf("- %d walls, %d sectors\n", walls, sectors);
 			
@@ -27,6 +27,7 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <memory>
+#include <future>
 
 #include "i_time.h"
 
@@ -91,12 +92,15 @@
 #include "screenjob.h"
 #include "i_interface.h"
 #include "fs_findfile.h"
+#include "g_benchmark.h"
+#include "d_worldhash.h"
 
 
 static FRandom pr_dmspawn ("DMSpawn");
 static FRandom pr_pspawn ("PlayerSpawn");
 
 bool WriteZip(const char* filename, const FileSys::FCompressedBuffer* content, size_t contentcount);
+bool WriteZip(FileWriter *f, const FileSys::FCompressedBuffer* content, size_t contentcount);
 bool	G_CheckDemoStatus (void);
 void	G_ReadDemoTiccmd (ticcmd_t *cmd, int player);
 void	G_WriteDemoTiccmd (ticcmd_t *cmd, int player, int buf);
@@ -105,6 +109,8 @@ void	G_PlayerReborn (int player);
 void	G_DoNewGame (void);
 void	G_DoLoadGame (void);
 void	G_DoPlayDemo (void);
+static void G_DemoSnapshotTicker (bool afteractions);
+static void G_EndDemoSeek ();
 void	G_DoCompleted (void);
 void	G_DoVictory (void);
 void	G_DoWorldDone (void);
@@ -116,12 +122,16 @@ void STAT_Serialize(FSerializer &file);
 
 CVARD_NAMED(Int, gameskill, skill, 2, CVAR_SERVERINFO|CVAR_LATCH, "sets the skill for the next newly started game")
 CVAR(Bool, save_formatted, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// use formatted JSON for saves (more readable but a larger files and a bit slower.
+CVAR(Bool, save_binary, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// use the binary format for saves and hub snapshots. save_formatted overrides this.
 CVAR (Int, deathmatch, 0, CVAR_SERVERINFO|CVAR_LATCH);
 CVAR (Bool, chasedemo, false, 0);
 CVAR (Bool, storesavepic, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (Bool, longsavemessages, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR (Bool, cl_waitforsave, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+CVAR (Bool, save_async, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);	// compress and write savegames on a background thread
 CVAR (Bool, enablescriptscreenshot, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+CVAR (Int, demo_snapshotinterval, 35*30, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);	// tics between in-memory saves for demo seeking, 0 for level starts only
+CVAR (Int, demo_snapshotmemory, 256, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);	// megabytes those may use
 EXTERN_CVAR (Float, con_midtime);
 
 //==========================================================================
@@ -1125,6 +1135,8 @@ void G_Ticker ()
 	int i;
 	gamestate_t	oldgamestate;
 
+	G_FinishPendingSave(false);
+
 	// do player reborns if needed
 	for (i = 0; i < MAXPLAYERS; i++)
 	{
@@ -1147,6 +1159,8 @@ void G_Ticker ()
 		AddCommandString ("toggle vid_fullscreen");
 	}
 
+	G_DemoSnapshotTicker(false);
+
 	// do things to change the game state
 	oldgamestate = gamestate;
 	while (gameaction != ga_nothing)
@@ -1232,6 +1246,8 @@ void G_Ticker ()
 		C_AdjustBottom ();
 	}
 
+	G_DemoSnapshotTicker(true);
+
 	// get commands, check consistancy, and build new consistancy check
 	int buf = (gametic/ticdup)%BACKUPTICS;
 
@@ -1306,9 +1322,15 @@ void G_Ticker ()
 	switch (gamestate)
 	{
 	case GS_LEVEL:
+	{
+		cycle_t ticcycles;
+		ticcycles.ResetAndClock();
 		P_Ticker ();
+		ticcycles.Unclock();
+		G_BenchmarkTic(ticcycles.TimeMS());
 		primaryLevel->automap->Ticker ();
 		break;
+	}
 
 	case GS_TITLELEVEL:
 		P_Ticker ();
@@ -1341,6 +1363,8 @@ void G_Ticker ()
 
 	// [MK] Additional ticker for UI events right after all others
 	primaryLevel->localEventManager->PostUiTick();
+
+	D_WorldHashTic();
 }
 
 
@@ -1986,29 +2010,20 @@ void C_SerializeCVars(FSerializer& arc, const char* label, uint32_t filter)
 void SetupLoadingCVars();
 void FinishLoadingCVars();
 
-void G_DoLoadGame ()
-{
-	SetupLoadingCVars();
-	bool hidecon;
-
-	if (gameaction != ga_autoloadgame)
-	{
-		demoplayback = false;
-	}
-	hidecon = gameaction == ga_loadgamehidecon;
-	gameaction = ga_nothing;
+//==========================================================================
+//
+// Restores the game from an opened savegame. savename is only used for
+// error messages.
+//
+//==========================================================================
 
-	std::unique_ptr<FResourceFile> resfile(FResourceFile::OpenResourceFile(savename.GetChars(), true));
-	if (resfile == nullptr)
-	{
-		LoadGameError("TXT_COULDNOTREAD");
-		return;
-	}
+static bool G_ReadSaveGame(std::unique_ptr<FResourceFile> resfile, bool hidecon)
+{
 	auto info = resfile->FindEntry("info.json");
 	if (info < 0)
 	{
 		LoadGameError("TXT_NOINFOJSON");
-		return;
+		return false;
 	}
 
 	SaveVersion = 0;
@@ -2018,7 +2033,7 @@ void G_DoLoadGame ()
 	if (!arc.OpenReader(data.string(), data.size()))
 	{
 		LoadGameError("TXT_FAILEDTOREADSG");
-		return;
+		return false;
 	}
 
 	// Check whether this savegame actually has been created by a compatible engine.
@@ -2041,7 +2056,7 @@ void G_DoLoadGame ()
 		{
 			LoadGameError("TXT_OTHERENGINESG", engine.GetChars());
 		}
-		return;
+		return false;
 	}
 
 	if (SaveVersion < MINSAVEVER || SaveVersion > SAVEVER)
@@ -2059,7 +2074,7 @@ void G_DoLoadGame ()
 		}
 		message.Substitute("%d", FStringf("%d", SaveVersion));
 		LoadGameError(message.GetChars());
-		return;
+		return false;
 	}
 
 	if (!G_CheckSaveGameWads(arc, true))
@@ -2070,7 +2085,7 @@ void G_DoLoadGame ()
 	if (map.IsEmpty())
 	{
 		LoadGameError("TXT_NOMAPSG");
-		return;
+		return false;
 	}
 
 	// Now that it looks like we can load this save, hide the fullscreen console if it was up
@@ -2086,14 +2101,14 @@ void G_DoLoadGame ()
 	if (info < 0)
 	{
 		LoadGameError("TXT_NOGLOBALSJSON");
-		return;
+		return false;
 	}
 
 	data = resfile->Read(info);
 	if (!arc.OpenReader(data.string(), data.size()))
 	{
 		LoadGameError("TXT_SGINFOERR");
-		return;
+		return false;
 	}
 
 
@@ -2146,8 +2161,6 @@ void G_DoLoadGame ()
 	if (level.info != nullptr)
 		level.info->Snapshot.Clean();
 
-	BackupSaveName = savename;
-
 	//Push any added models from A_ChangeModel
 	for (auto& smf : savedModelFiles)
 	{
@@ -2160,6 +2173,32 @@ void G_DoLoadGame ()
 	// amount of memory in use, so bring it down now by starting a
 	// collection.
 	GC::StartCollection();
+	return true;
+}
+
+void G_DoLoadGame ()
+{
+	G_FinishPendingSave(true);
+	SetupLoadingCVars();
+	bool hidecon;
+
+	if (gameaction != ga_autoloadgame)
+	{
+		demoplayback = false;
+	}
+	hidecon = gameaction == ga_loadgamehidecon;
+	gameaction = ga_nothing;
+
+	std::unique_ptr<FResourceFile> resfile(FResourceFile::OpenResourceFile(savename.GetChars(), true));
+	if (resfile == nullptr)
+	{
+		LoadGameError("TXT_COULDNOTREAD");
+		return;
+	}
+	if (G_ReadSaveGame(std::move(resfile), hidecon))
+	{
+		BackupSaveName = savename;
+	}
 }
 
 
@@ -2331,24 +2370,129 @@ static void PutSavePic (FileWriter *file, int width, int height)
 	}
 }
 
-void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, const char *description)
+//==========================================================================
+//
+// Savegames are created in two steps: everything gets serialized into
+// memory on the game thread, then the compression and the file output
+// are done by a job that normally runs in the background so that the
+// game does not stall for them.
+//
+//==========================================================================
+
+struct FSaveGameJob
 {
-	TArray<FCompressedBuffer> savegame_content;
-	TArray<FString> savegame_filenames;
+	FString Filename;
+	FString Description;
+	bool OkForQuicksave;
+	bool ForceQuicksave;
 
-	char buf[100];
+	TArray<FCompressedBuffer> Content;	// all buffers are owned by the job
+	TArray<FString> ContentNames;
+	TArray<bool> Compress;
 
-	// Do not even try, if we're not in a level. (Can happen after
-	// a demo finishes playback.)
-	if (primaryLevel->lines.Size() == 0 || primaryLevel->sectors.Size() == 0 || gamestate != GS_LEVEL)
+	uint64_t StallTime = 0;
+	uint64_t WriteTime = 0;
+	std::future<bool> Result;
+
+	~FSaveGameJob()
 	{
-		return;
+		for (auto &buff : Content) buff.Clean();
 	}
 
-	if (demoplayback)
+	void Add(const FString &name, const FCompressedBuffer &buff, bool compress)
 	{
-		filename = G_BuildSaveName ("demosave");
+		ContentNames.Push(name);
+		Content.Push(buff);
+		Compress.Push(compress);
+	}
+};
+
+static std::unique_ptr<FSaveGameJob> PendingSave;
+
+static FCompressedBuffer CopyCompressedBuffer(const FCompressedBuffer &buff)
+{
+	FCompressedBuffer copy = buff;
+	copy.mBuffer = new char[buff.mCompressedSize];
+	memcpy(copy.mBuffer, buff.mBuffer, buff.mCompressedSize);
+	return copy;
+}
+
+// These run on the save thread and must not touch any game state.
+static void CompressSaveGame(FSaveGameJob *job)
+{
+	for (unsigned i = 0; i < job->Content.Size(); i++)
+	{
+		if (job->Compress[i]) FSerializer::CompressOutput(job->Content[i]);
+		job->Content[i].filename = job->ContentNames[i].GetChars();
+	}
+}
+
+static bool WriteSaveGame(FSaveGameJob *job)
+{
+	uint64_t starttime = I_nsTime();
+
+	CompressSaveGame(job);
+
+	bool succeeded = false;
+	if (WriteZip(job->Filename.GetChars(), job->Content.Data(), job->Content.Size()))
+	{
+		// Check whether the file is ok by trying to open it.
+		FResourceFile *test = FResourceFile::OpenResourceFile(job->Filename.GetChars(), true);
+		if (test != nullptr)
+		{
+			delete test;
+			succeeded = true;
+		}
+	}
+	job->WriteTime = I_nsTime() - starttime;
+	return succeeded;
+}
+
+static void FinishSaveGame(FSaveGameJob *job, bool succeeded)
+{
+	if (succeeded)
+	{
+		savegameManager.NotifyNewSave(job->Filename, job->Description, job->OkForQuicksave, job->ForceQuicksave);
+		BackupSaveName = job->Filename;
+
+		if (longsavemessages) Printf("%s (%s)\n", GStrings("GGSAVED"), job->Filename.GetChars());
+		else Printf("%s\n", GStrings("GGSAVED"));
 	}
+	else
+	{
+		Printf(PRINT_HIGH, "%s\n", GStrings("TXT_SAVEFAILED"));
+	}
+	DPrintf(DMSG_NOTIFY, "Savegame %s: game stalled for %.1f ms, writing took %.1f ms\n", job->Filename.GetChars(),
+		job->StallTime / 1e6, job->WriteTime / 1e6);
+}
+
+//==========================================================================
+//
+// Reports the result of a savegame that was written in the background.
+// With 'wait' set this blocks until the file is complete, which must be
+// done before anything that may access it.
+//
+//==========================================================================
+
+void G_FinishPendingSave(bool wait)
+{
+	if (PendingSave == nullptr) return;
+	if (!wait && PendingSave->Result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+
+	auto job = std::move(PendingSave);
+	FinishSaveGame(job.get(), job->Result.get());
+}
+
+//==========================================================================
+//
+// Serializes the current game into the job. This is everything a savegame
+// needs from the game state; the caller decides where the data goes.
+//
+//==========================================================================
+
+static bool G_BuildSaveGame(FSaveGameJob *job, const char *description, bool withpic)
+{
+	char buf[100];
 
 	if (cl_waitforsave)
 		I_FreezeTime(true);
@@ -2356,7 +2500,7 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 	insave = true;
 	try
 	{
-		level.SnapshotLevel();
+		level.SnapshotLevel(false);
 	}
 	catch(CRecoverableError &err)
 	{
@@ -2368,7 +2512,7 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 		// The time freeze must be reset if the save fails.
 		if (cl_waitforsave)
 			I_FreezeTime(false);
-		return;
+		return false;
 	}
 	catch (...)
 	{
@@ -2383,10 +2527,10 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 	FSerializer savegameglobals;	// and this for non-level related info that must be saved.
 
 	savegameinfo.OpenWriter(true);
-	savegameglobals.OpenWriter(save_formatted);
+	savegameglobals.OpenWriter(save_formatted, save_binary && !save_formatted);
 
 	SaveVersion = SAVEVER;
-	PutSavePic(&savepic, SAVEPICWIDTH, SAVEPICHEIGHT);
+	PutSavePic(&savepic, withpic ? SAVEPICWIDTH : 0, SAVEPICHEIGHT);
 	mysnprintf(buf, countof(buf), GAMENAME " %s", GetVersionString());
 	// put some basic info into the PNG so that this isn't lost when the image gets extracted.
 	M_AppendPNGText(&savepic, "Software", buf);
@@ -2431,49 +2575,28 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 	auto picdata = savepic.GetBuffer();
 	FCompressedBuffer bufpng = { picdata->size(), picdata->size(), FileSys::METHOD_STORED, static_cast<unsigned int>(crc32(0, &(*picdata)[0], picdata->size())), (char*)&(*picdata)[0] };
 
-	savegame_content.Push(bufpng);
-	savegame_filenames.Push("savepic.png");
-	savegame_content.Push(savegameinfo.GetCompressedOutput());
-	savegame_filenames.Push("info.json");
-	savegame_content.Push(savegameglobals.GetCompressedOutput());
-	savegame_filenames.Push("globals.json");
-	G_WriteSnapshots (savegame_filenames, savegame_content);
-	
-	for (unsigned i = 0; i < savegame_content.Size(); i++)
-		savegame_content[i].filename = savegame_filenames[i].GetChars();
-
-	bool succeeded = false;
+	job->Add("savepic.png", CopyCompressedBuffer(bufpng), false);
+	job->Add("info.json", savegameinfo.GetStoredOutput(), true);
+	job->Add("globals.json", savegameglobals.GetStoredOutput(), true);
 
-	if (WriteZip(filename.GetChars(), savegame_content.Data(), savegame_content.Size()))
+	TArray<FString> snapshot_filenames;
+	TArray<FCompressedBuffer> snapshots;
+	G_WriteSnapshots (snapshot_filenames, snapshots);
+	for (unsigned i = 0; i < snapshots.Size(); i++)
 	{
-		// Check whether the file is ok by trying to open it.
-		FResourceFile *test = FResourceFile::OpenResourceFile(filename.GetChars(), true);
-		if (test != nullptr)
+		// The current level's snapshot was only made for this save, so the job can take it over.
+		// The other ones still belong to their levels.
+		if (snapshots[i].mBuffer == level.info->Snapshot.mBuffer)
 		{
-			delete test;
-			succeeded = true;
+			job->Add(snapshot_filenames[i], snapshots[i], true);
+			level.info->Snapshot.mBuffer = nullptr;
+		}
+		else
+		{
+			job->Add(snapshot_filenames[i], CopyCompressedBuffer(snapshots[i]), false);
 		}
 	}
 
-	if (succeeded)
-	{
-		savegameManager.NotifyNewSave(filename, description, okForQuicksave, forceQuicksave);
-		BackupSaveName = filename;
-
-		if (longsavemessages) Printf("%s (%s)\n", GStrings("GGSAVED"), filename.GetChars());
-		else Printf("%s\n", GStrings("GGSAVED"));
-	}
-	else
-	{
-		Printf(PRINT_HIGH, "%s\n", GStrings("TXT_SAVEFAILED"));
-	}
-
-
-	// delete the JSON buffers we created just above. Everything else will
-	// either still be needed or taken care of automatically.
-	savegame_content[1].Clean();
-	savegame_content[2].Clean();
-
 	// We don't need the snapshot any longer.
 	level.info->Snapshot.Clean();
 		
@@ -2481,6 +2604,52 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 
 	if (cl_waitforsave)
 		I_FreezeTime(false);
+
+	return true;
+}
+
+void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, const char *description)
+{
+	// Do not even try, if we're not in a level. (Can happen after
+	// a demo finishes playback.)
+	if (primaryLevel->lines.Size() == 0 || primaryLevel->sectors.Size() == 0 || gamestate != GS_LEVEL)
+	{
+		return;
+	}
+
+	// The previous save may still be writing to the same file.
+	G_FinishPendingSave(true);
+	uint64_t starttime = I_nsTime();
+
+	if (demoplayback)
+	{
+		filename = G_BuildSaveName ("demosave");
+	}
+
+	auto job = std::make_unique<FSaveGameJob>();
+	job->Filename = filename;
+	job->Description = description;
+	job->OkForQuicksave = okForQuicksave;
+	job->ForceQuicksave = forceQuicksave;
+
+	if (!G_BuildSaveGame(job.get(), description, true))
+	{
+		return;
+	}
+
+	job->StallTime = I_nsTime() - starttime;
+	if (save_async)
+	{
+		auto jobp = job.get();
+		job->Result = std::async(std::launch::async, [=]() { return WriteSaveGame(jobp); });
+		PendingSave = std::move(job);
+	}
+	else
+	{
+		bool succeeded = WriteSaveGame(job.get());
+		job->StallTime += job->WriteTime;
+		FinishSaveGame(job.get(), succeeded);
+	}
 }
 
 
@@ -2687,10 +2856,17 @@ void G_BeginRecording (const char *startmap)
 
 FString defdemoname;
 
+static int DemoStartTic;			// gametic at which the current demo started playing
+static int DemoSeekTic = -1;		// demo tic to fast forward to, -1 if not seeking
+static bool DemoSeekExit;			// quit when DemoSeekTic is reached
+static bool DemoRestart;			// G_CheckDemoStatus should play the demo again
+static bool DemoFromSave;			// the demo needs the savegame that was loaded before it
+
 void G_DeferedPlayDemo (const char *name)
 {
 	defdemoname = name;
-	gameaction = (gameaction == ga_loadgame) ? ga_loadgameplaydemo : ga_playdemo;
+	DemoFromSave = gameaction == ga_loadgame;
+	gameaction = DemoFromSave ? ga_loadgameplaydemo : ga_playdemo;
 }
 
 UNSAFE_CCMD (playdemo)
@@ -2954,9 +3130,212 @@ void G_DoPlayDemo (void)
 		usergame = false;
 		demoplayback = true;
 		playedtitlemusic = false;
+		DemoStartTic = gametic;
 	}
 }
 
+//==========================================================================
+//
+// Demo seeking
+//
+// Seeking runs the demo as fast as possible until the requested tic is
+// reached, drawing only an occasional frame. Every level start that is
+// played and every demo_snapshotinterval tics get an in-memory savegame,
+// so seeking backwards continues from the closest one before the target.
+// The oldest ones are dropped when they use more than demo_snapshotmemory.
+// Without one, the demo is played again from the start.
+//
+//==========================================================================
+
+struct FDemoSnapshot
+{
+	int Tic;
+	ptrdiff_t DemoPos;
+	ticcmd_t Cmds[MAXPLAYERS];	// the demo's commands are deltas to these
+	std::vector<unsigned char> Data;	// savegame zip
+};
+
+static TArray<FDemoSnapshot> DemoSnapshots;	// in the order they were taken
+static size_t DemoSnapshotBytes;
+static int DemoSnapshotToLoad = -1;
+
+static void G_TakeDemoSnapshot ()
+{
+	if (DemoSnapshotToLoad >= 0) return;
+	for (auto &snap : DemoSnapshots)
+	{
+		if (snap.Tic == G_DemoTic()) return;
+	}
+
+	FSaveGameJob job;
+	if (!G_BuildSaveGame(&job, "demo snapshot", false)) return;
+	CompressSaveGame(&job);
+
+	BufferWriter zip;
+	if (!WriteZip(&zip, job.Content.Data(), job.Content.Size())) return;
+
+	auto &snap = DemoSnapshots[DemoSnapshots.Reserve(1)];
+	snap.Tic = G_DemoTic();
+	snap.DemoPos = demo_p - demobuffer;
+	for (int i = 0; i < MAXPLAYERS; i++) snap.Cmds[i] = players[i].cmd;
+	snap.Data = zip.TakeBuffer();
+	DemoSnapshotBytes += snap.Data.size();
+
+	// Always keep the new one, even if it alone is over the limit.
+	const size_t limit = (size_t)max(*demo_snapshotmemory, 0) << 20;
+	while (DemoSnapshotBytes > limit && DemoSnapshots.Size() > 1)
+	{
+		DemoSnapshotBytes -= DemoSnapshots[0].Data.size();
+		DemoSnapshots.Delete(0);
+	}
+}
+
+static void G_ClearDemoSnapshots ()
+{
+	DemoSnapshots.Clear();
+	DemoSnapshotBytes = 0;
+	DemoSnapshotToLoad = -1;
+}
+
+static bool G_LoadDemoSnapshot (const FDemoSnapshot &snap)
+{
+	FileReader fr;
+	if (!fr.OpenMemory(snap.Data.data(), snap.Data.size())) return false;
+	std::unique_ptr<FResourceFile> resfile(FResourceFile::OpenResourceFile("demosnapshot", fr, true));
+	if (resfile == nullptr) return false;
+
+	G_FinishPendingSave(true);
+	SetupLoadingCVars();
+	if (!G_ReadSaveGame(std::move(resfile), false)) return false;
+
+	demo_p = demobuffer + snap.DemoPos;
+	DemoStartTic = gametic - snap.Tic;
+	for (int i = 0; i < MAXPLAYERS; i++) players[i].cmd = snap.Cmds[i];
+	return true;
+}
+
+// Called by G_Ticker before and after the game actions have been processed.
+static void G_DemoSnapshotTicker (bool afteractions)
+{
+	if (!afteractions)
+	{
+		int toload = DemoSnapshotToLoad;
+		DemoSnapshotToLoad = -1;
+		if (toload >= 0 && demoplayback && !G_LoadDemoSnapshot(DemoSnapshots[toload]))
+		{
+			// Drop it and seek from the start instead, like when there is no snapshot.
+			Printf("Unable to restore the demo at tic %d\n", DemoSnapshots[toload].Tic);
+			DemoSnapshotBytes -= DemoSnapshots[toload].Data.size();
+			DemoSnapshots.Delete(toload);
+			if (DemoFromSave && savename.IsEmpty())
+			{
+				Printf("This demo cannot be restarted\n");
+				G_EndDemoSeek();
+				return;
+			}
+			DemoRestart = true;
+			G_CheckDemoStatus();
+		}
+	}
+	else if (demoplayback && !timingdemo && gamestate == GS_LEVEL &&
+		(primaryLevel->maptime == 0 || (demo_snapshotinterval > 0 && G_DemoTic() % demo_snapshotinterval == 0)))
+	{
+		G_TakeDemoSnapshot();
+	}
+}
+
+int G_DemoTic ()
+{
+	return gametic - DemoStartTic;
+}
+
+bool G_IsDemoSeeking ()
+{
+	return DemoSeekTic >= 0;
+}
+
+void G_SetDemoSeek (int tic, bool exitwhendone)
+{
+	if (DemoSeekTic < 0) soundEngine->BlockNewSounds(true);
+	DemoSeekTic = max(tic, 0);
+	DemoSeekExit = exitwhendone;
+}
+
+static void G_EndDemoSeek ()
+{
+	DemoSeekTic = -1;
+	soundEngine->BlockNewSounds(false);
+}
+
+// Called after each tic that was run for seeking. Returns false once the target has been reached.
+bool G_UpdateDemoSeek ()
+{
+	if (DemoSeekTic < 0) return false;
+
+	if (!demoplayback)
+	{
+		// Restarting, or not started yet when seeking from the command line.
+		if (gameaction == ga_playdemo || gameaction == ga_loadgameplaydemo) return true;
+
+		Printf("Demo ended before tic %d\n", DemoSeekTic);
+		G_EndDemoSeek();
+		if (DemoSeekExit)
+		{
+			throw CExitEvent(1);
+		}
+		return false;
+	}
+	if (G_DemoTic() < DemoSeekTic) return true;
+
+	Printf("Reached demo tic %d\n", G_DemoTic());
+	G_EndDemoSeek();
+	if (DemoSeekExit)
+	{
+		throw CExitEvent(0);
+	}
+	return false;
+}
+
+CCMD (demoseek)
+{
+	if (!demoplayback || timingdemo)
+	{
+		Printf("No demo is being played\n");
+		return;
+	}
+	if (argv.argc() < 2)
+	{
+		Printf("Usage: demoseek <tic>|+<tics>|-<tics>\nThe demo is at tic %d\n", G_DemoTic());
+		return;
+	}
+
+	int tic = (int)strtol(argv[1], nullptr, 10);
+	if (argv[1][0] == '+' || argv[1][0] == '-') tic += G_DemoTic();
+
+	if (tic < G_DemoTic())
+	{
+		int best = -1;
+		for (unsigned i = 0; i < DemoSnapshots.Size(); i++)
+		{
+			if (DemoSnapshots[i].Tic <= tic && (best < 0 || DemoSnapshots[i].Tic > DemoSnapshots[best].Tic)) best = i;
+		}
+		if (best >= 0)
+		{
+			DemoSnapshotToLoad = best;
+			G_SetDemoSeek(tic, false);
+			return;
+		}
+		if (DemoFromSave && savename.IsEmpty())
+		{
+			Printf("This demo cannot be restarted\n");
+			return;
+		}
+		DemoRestart = true;
+		G_CheckDemoStatus();
+	}
+	G_SetDemoSeek(tic, false);
+}
+
 //
 // G_TimeDemo
 //
@@ -2967,6 +3346,12 @@ void G_TimeDemo (const char* name)
 	timingdemo = true;
 	singletics = true;
 
+	const char *benchout = Args->CheckValue ("-benchout");
+	if (benchout != nullptr)
+	{
+		G_BenchmarkStart (benchout);
+	}
+
 	defdemoname = name;
 	gameaction = (gameaction == ga_loadgame) ? ga_loadgameplaydemo : ga_playdemo;
 }
@@ -3000,6 +3385,7 @@ bool G_CheckDemoStatus (void)
 		C_RestoreCVars ();		// [RH] Restore cvars demo might have changed
 		M_Free (demobuffer);
 		demobuffer = NULL;
+		G_ClearDemoSnapshots();
 
 		P_SetupWeapons_ntohton();
 		demoplayback = false;
@@ -3014,10 +3400,24 @@ bool G_CheckDemoStatus (void)
 		{
 			StatusBar->AttachToPlayer (&players[0]);
 		}
+		if (DemoRestart)
+		{
+			DemoRestart = false;
+			gameaction = DemoFromSave ? ga_loadgameplaydemo : ga_playdemo;
+			return true;
+		}
 		if (singledemo || timingdemo)
 		{
 			if (timingdemo)
 			{
+				G_BenchmarkFinish (defdemoname.GetChars(), gametic, endtime);
+				if (batchrun)
+				{
+					// Benchmark runs on build machines should exit quietly.
+					Printf ("timed %i gametics in %i realtics (%.1f fps)\n", gametic,
+							endtime, (float)gametic/(float)endtime*(float)TICRATE);
+					throw CExitEvent(0);
+				}
 				// Trying to get back to a stable state after timing a demo
 				// seems to cause problems. I don't feel like fixing that
 				// right now.
@@ -67,6 +67,7 @@ void G_DoLoadGame (void);
 void G_SaveGame (const char *filename, const char *description);
 // Called by messagebox
 void G_DoQuickSave ();
+void G_FinishPendingSave (bool wait);
 
 // Only called by startup code.
 void G_RecordDemo (const char* name);
@@ -75,6 +76,10 @@ void G_BeginRecording (const char *startmap);
 
 void G_PlayDemo (char* name);
 void G_TimeDemo (const char* name);
+int G_DemoTic ();
+bool G_IsDemoSeeking ();
+void G_SetDemoSeek (int tic, bool exitwhendone);
+bool G_UpdateDemoSeek ();
 bool G_CheckDemoStatus (void);
 
 void G_Ticker (void);
@@ -172,7 +172,7 @@ private:
 	void PlayerSpawnPickClass (int playernum);
 
 public:
-	void SnapshotLevel();
+	void SnapshotLevel(bool compress = true);
 	void UnSnapshotLevel(bool hubLoad);
 
 	void FinalizePortals();
@@ -269,6 +269,7 @@ public:
 
 	void DeleteAllAttachedLights();
 	void RecreateAllAttachedLights();
+	void UpdateLightLinks();
 
 
 private:
@@ -462,6 +463,7 @@ public:
 	TArray<node_t> gamenodes;
 	node_t *headgamenode;
 	TArray<uint8_t> rejectmatrix;
+	bool rejectgenerated = false;	// rejectmatrix was made by BuildReject, not loaded from the map
 	TArray<zone_t>	Zones;
 	TArray<FPolyObj> Polyobjects;
 
@@ -677,7 +679,7 @@ public:
 	uint32_t			ActiveParticles;
 	uint32_t			InactiveParticles;
 	TArray<particle_t>	Particles;
-	TArray<uint16_t>	ParticlesInSubsec;
+	TArray<uint32_t>	ParticlesInSubsec;
 	FThinkerCollection Thinkers;
 
 	TArray<DVector2>	Scrolls;		// NULL if no DScrollers in this level
@@ -708,6 +710,8 @@ public:
 	int			ImpactDecalCount;
 
 	FDynamicLight *lights;
+	TArray<FDynamicLight *> LightLinks;	// packed per-section and per-sidedef light lists
+	bool LightLinksDirty = false;
 
 	// links to global game objects
 	TArray<TObjPtr<AActor *>> CorpseQueue;
@@ -154,6 +154,7 @@ void DBaseStatusBar::CreateAltHUD()
 		AltHud = DoCreateAltHUD(NAME_AltHud);
 
 	assert(AltHud);
+	GC::WriteBarrier(this, AltHud);
 }
 
 
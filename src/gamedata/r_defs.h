@@ -50,7 +50,7 @@
 // We rely on the thinker data struct
 // to handle sound origins in sectors.
 // SECTORS do store MObjs anyway.
-struct FLightNode;
+struct FDynamicLight;
 struct FGLSection;
 class FSerializer;
 struct FSectorPortalGroup;
@@ -64,6 +64,9 @@ struct FLevelLocals;
 struct LightmapSurface;
 struct LightProbe;
 
+// The dynamic lights touching a section or sidedef. Points into FLevelLocals::LightLinks.
+using FLightList = TArrayView<FDynamicLight *>;
+
 const uint16_t NO_INDEX = 0xffffu;
 const uint32_t NO_SIDE = 0xffffffffu;
 
@@ -1249,7 +1252,7 @@ struct side_t
 	int16_t		TierLights[3];	// per-tier light levels
 	uint16_t	Flags;
 	int			UDMFIndex;		// needed to access custom UDMF fields which are stored in loading order.
-	FLightNode * lighthead;		// all dynamic lights that may affect this wall
+	FLightList	lights;			// all dynamic lights that may affect this wall
 	LightmapSurface* lightmap;
 	seg_t **segs;	// all segs belonging to this sidedef in ascending order. Used for precise rendering
 	int numsegs;
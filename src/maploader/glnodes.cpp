@@ -961,7 +961,7 @@ bool MapLoader::CheckNodes(MapData * map, bool rebuilt, int buildtime)
 				0, 0, 0, 0
 			};
 			leveldata.FindMapBounds ();
-			FNodeBuilder builder (leveldata, polyspots, anchors, true);
+			FNodeBuilder builder (leveldata, polyspots, anchors, true, NodeBuilderThreads());
 			
 			builder.Extract (*Level);
 			endTime = I_msTime ();
@@ -998,7 +998,7 @@ bool MapLoader::CheckNodes(MapData * map, bool rebuilt, int buildtime)
 typedef TArray<uint8_t> MemFile;
 
 
-static FString CreateCacheName(MapData *map, bool create)
+static FString CreateCacheName(MapData *map, bool create, const char *ext = ".gzc")
 {
 	FString path = M_GetCachePath(create);
 	FString lumpname = fileSystem.GetFileFullPath(map->lumpnum).c_str();
@@ -1008,7 +1008,7 @@ static FString CreateCacheName(MapData *map, bool create)
 
 	lumpname.ReplaceChars('/', '%');
 	lumpname.ReplaceChars(':', '$');
-	path << '/' << lumpname.Right((ptrdiff_t)lumpname.Len() - separator - 1) << ".gzc";
+	path << '/' << lumpname.Right((ptrdiff_t)lumpname.Len() - separator - 1) << ext;
 	return path;
 }
 
@@ -1197,6 +1197,84 @@ bool MapLoader::CheckCachedNodes(MapData *map)
 	return true;
 }
 
+//==========================================================================
+//
+// REJECT caching
+//
+// Generated REJECT tables are stored next to the cached nodes. Whether
+// the game nodes were rebuilt is part of the key because the table
+// depends on which sectors actors end up in.
+//
+//==========================================================================
+
+enum { REJECT_CACHE_VERSION = 1 };
+
+void MapLoader::CreateCachedReject(MapData *map)
+{
+	auto &reject = Level->rejectmatrix;
+	uLongf outlen = compressBound(reject.Size());
+	TArray<Bytef> compressed(outlen + 32, true);
+
+	if (compress(compressed.Data() + 32, &outlen, reject.Data(), reject.Size()) != Z_OK)
+	{
+		return;
+	}
+
+	memcpy(compressed.Data(), "REJC", 4);
+	uint32_t header[3] = { LittleLong(uint32_t(REJECT_CACHE_VERSION | (ForceNodeBuild ? 0x100 : 0))), LittleLong(Level->sectors.Size()), LittleLong(Level->lines.Size()) };
+	memcpy(&compressed[4], header, 12);
+	map->GetChecksum(&compressed[16]);
+
+	FString path = CreateCacheName(map, true, ".rej");
+	FileWriter *fw = FileWriter::Open(path.GetChars());
+
+	if (fw != nullptr)
+	{
+		const size_t length = outlen + 32;
+		if (fw->Write(compressed.Data(), length) != length)
+		{
+			Printf("Error saving REJECT to file %s\n", path.GetChars());
+		}
+		delete fw;
+	}
+	else
+	{
+		Printf("Cannot open REJECT file %s for writing\n", path.GetChars());
+	}
+}
+
+bool MapLoader::CheckCachedReject(MapData *map)
+{
+	uint8_t head[32];
+	uint8_t md5map[16];
+
+	FString path = CreateCacheName(map, false, ".rej");
+	FileReader fr;
+
+	if (!fr.OpenFile(path.GetChars())) return false;
+	if (fr.Read(head, 32) != 32) return false;
+	if (memcmp(head, "REJC", 4)) return false;
+
+	uint32_t header[3];
+	memcpy(header, &head[4], 12);
+	if (LittleLong(header[0]) != uint32_t(REJECT_CACHE_VERSION | (ForceNodeBuild ? 0x100 : 0))) return false;
+	if (LittleLong(header[1]) != Level->sectors.Size() || LittleLong(header[2]) != Level->lines.Size()) return false;
+
+	map->GetChecksum(md5map);
+	if (memcmp(&head[16], md5map, 16)) return false;
+
+	auto data = fr.Read(fr.GetLength() - 32);
+	uLongf rejectsize = (Level->sectors.Size() * Level->sectors.Size() + 7) >> 3;
+	Level->rejectmatrix.Resize(rejectsize);
+	if (uncompress(Level->rejectmatrix.Data(), &rejectsize, data.bytes(), data.size()) != Z_OK ||
+		rejectsize != Level->rejectmatrix.Size())
+	{
+		Level->rejectmatrix.Reset();
+		return false;
+	}
+	return true;
+}
+
 UNSAFE_CCMD(clearnodecache)
 {
 	FileSys::FileList list;
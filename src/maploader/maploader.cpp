@@ -60,6 +60,7 @@
 
 #include <math.h>
 #include <cmath>	// needed for std::floor on mac
+#include <thread>
 #include "maploader.h"
 #include "c_cvars.h"
 #include "actor.h"
@@ -85,6 +86,8 @@
 #include "hw_vertexbuilder.h"
 #include "version.h"
 #include "fs_decompress.h"
+#include "c_dispatch.h"
+#include "gamestate.h"
 
 enum
 {
@@ -93,6 +96,72 @@ enum
 
 CVAR (Bool, genblockmap, false, CVAR_SERVERINFO|CVAR_GLOBALCONFIG);
 CVAR (Bool, gennodes, false, CVAR_SERVERINFO|CVAR_GLOBALCONFIG);
+CVAR (Int, gennodes_threads, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG);	// 0 uses one thread per core
+
+//==========================================================================
+//
+// Number of threads the node builder may use
+//
+//==========================================================================
+
+int NodeBuilderThreads()
+{
+	if (gennodes_threads > 0) return gennodes_threads;
+	return clamp<int>(std::thread::hardware_concurrency(), 1, 8);
+}
+
+//==========================================================================
+//
+// CCMD nodebench
+//
+// Rebuilds the nodes of the current level with one thread and with
+// NodeBuilderThreads() threads, and checks that both produce the same tree.
+//
+//==========================================================================
+
+static uint64_t BenchNodeBuild(FLevelLocals *Level, int threads, int count, double &ms)
+{
+	uint64_t checksum = 0;
+	uint64_t start = I_nsTime();
+
+	for (int i = 0; i < count; i++)
+	{
+		// The node builder replaces the lines' vertex pointers, so it gets a copy.
+		TArray<line_t> lines = Level->lines;
+		TArray<FNodeBuilder::FPolyStart> polyspots, anchors;
+		FNodeBuilder::FLevel leveldata =
+		{
+			&Level->vertexes[0], (int)Level->vertexes.Size(),
+			&Level->sides[0], (int)Level->sides.Size(),
+			&lines[0], (int)lines.Size(),
+			0, 0, 0, 0
+		};
+		leveldata.FindMapBounds();
+
+		FNodeBuilder builder(leveldata, polyspots, anchors, true, threads);
+		checksum = builder.GetChecksum();
+	}
+	ms = (I_nsTime() - start) / 1e6 / count;
+	return checksum;
+}
+
+CCMD(nodebench)
+{
+	if (gamestate != GS_LEVEL || primaryLevel->lines.Size() == 0)
+	{
+		Printf("Not in a level\n");
+		return;
+	}
+
+	int count = argv.argc() > 1 ? max(atoi(argv[1]), 1) : 3;
+	int threads = NodeBuilderThreads();
+	double serialms, parallelms;
+	uint64_t serial = BenchNodeBuild(primaryLevel, 1, count, serialms);
+	uint64_t parallel = BenchNodeBuild(primaryLevel, threads, count, parallelms);
+
+	Printf("%s: %u lines, 1 thread %.1f ms, %d threads %.1f ms, %s\n", primaryLevel->MapName.GetChars(), primaryLevel->lines.Size(),
+		serialms, threads, parallelms, serial == parallel ? "same output" : TEXTCOLOR_RED "output differs" TEXTCOLOR_NORMAL);
+}
 
 inline bool P_LoadBuildMap(uint8_t *mapdata, size_t len, FMapThing **things, int *numthings)
 {
@@ -3134,7 +3203,7 @@ void MapLoader::LoadLevel(MapData *map, const char *lumpname, int position)
 		};
 		leveldata.FindMapBounds();
 
-		FNodeBuilder builder(leveldata, polyspots, anchors, BuildGLNodes);
+		FNodeBuilder builder(leveldata, polyspots, anchors, BuildGLNodes, NodeBuilderThreads());
 		builder.Extract(*Level);
 		endTime = I_msTime();
 		DPrintf(DMSG_NOTIFY, "BSP generation took %.3f sec (%d segs)\n", (endTime - startTime) * 0.001, Level->segs.Size());
@@ -3176,6 +3245,7 @@ void MapLoader::LoadLevel(MapData *map, const char *lumpname, int position)
 	LoadBlockMap(map);
 
 	LoadReject(map, false);
+	bool buildreject = Level->rejectmatrix.Size() == 0;
 	GroupLines(false);
 	FloodZones();
 	SetRenderSector();
@@ -3255,6 +3325,13 @@ void MapLoader::LoadLevel(MapData *map, const char *lumpname, int position)
 	InitPortalGroups(Level);
 	P_InitHealthGroups(Level);
 
+	// The generated REJECT does not know about linked portals, and InitPortalGroups
+	// drops the table for such maps anyway.
+	if (buildreject && Level->Displacements.size <= 1)
+	{
+		BuildReject(map);
+	}
+
 	if (reloop) LoopSidedefs(false);
 	PO_Init();				// Initialize the polyobjs
 	if (!Level->IsReentering())
@@ -0,0 +1,540 @@
+/*
+** reject.cpp
+** REJECT table builder
+**
+**---------------------------------------------------------------------------
+** Copyright (C) 2026 Redemption Development Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Builds a REJECT table for maps that come without a usable one.
+**
+** P_CheckSight only looks at lines, so two actors can only see each
+** other if a straight line between them crosses nothing but two-sided
+** lines. Since doors and lifts can open any two-sided line, the table
+** ignores heights entirely and only asks whether such a straight line
+** can exist in 2D. This is decided by following chains of two-sided
+** lines from each sector and clipping every further line against the
+** window through which it could be seen, like a 2D version of the
+** portal flow in Quake's vis. Paths through single vertices count as
+** well, because the sight trace can slip through those.
+**
+** The result must never reject a pair that P_CheckSight could see, so
+** every step errs towards visibility, and maps whose geometry does not
+** match their nodes or blockmap only get their disconnected areas
+** rejected, or no table at all.
+**
+*/
+
+#include <math.h>
+#include <utility>
+
+#include "maploader.h"
+#include "g_levellocals.h"
+#include "p_setup.h"
+#include "c_cvars.h"
+#include "i_time.h"
+#include "printf.h"
+#include "parallel_for.h"
+
+CVAR(Bool, genreject, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+EXTERN_CVAR(Bool, gl_cachenodes)
+EXTERN_CVAR(Float, gl_cachetime)
+
+enum
+{
+	MAX_REJECT_SECTORS = 16384,		// 32 MB of matrix, larger maps are left alone
+	REJECT_FLOW_BUDGET = 1 << 15,	// portal steps per sector before giving up on clipping
+	REJECT_MAX_DEPTH = 256,			// longest chain of lines followed
+};
+
+static const double REJECT_SLACK = 1.;	// map units every clip is widened by
+
+struct FRejectSeg
+{
+	DVector2 v1, v2;
+
+	bool IsPoint() const { return v1 == v2; }
+};
+
+struct FRejectPortal
+{
+	FRejectSeg seg;		// both ends are the same for portals through a single vertex
+	int id;				// line index, or number of lines + vertex index
+	int to;				// sector on the other side
+};
+
+//==========================================================================
+//
+// Half-plane clipping
+//
+//==========================================================================
+
+// Signed distance of p from the line through a and b, positive on the left.
+static double SideOf(const DVector2 &a, const DVector2 &b, const DVector2 &p)
+{
+	DVector2 d = b - a;
+	return (d.X * (p.Y - a.Y) - d.Y * (p.X - a.X)) / d.Length();
+}
+
+// Keeps the part of seg on the given side of the line through a and b.
+static bool ClipToSide(FRejectSeg &seg, const DVector2 &a, const DVector2 &b, double sign)
+{
+	double d1 = SideOf(a, b, seg.v1) * sign + REJECT_SLACK;
+	double d2 = SideOf(a, b, seg.v2) * sign + REJECT_SLACK;
+
+	if (d1 < 0 && d2 < 0) return false;
+	if (d1 < 0) seg.v1 = seg.v1 + (seg.v2 - seg.v1) * (d1 / (d1 - d2));
+	else if (d2 < 0) seg.v2 = seg.v2 + (seg.v1 - seg.v2) * (d2 / (d2 - d1));
+	return true;
+}
+
+//==========================================================================
+//
+// ClipToWindow
+//
+// Clips target to the area that a straight line through source and then
+// through pass can reach. Returns false if nothing of target is left.
+// Degenerate arrangements are not clipped at all.
+//
+//==========================================================================
+
+static bool ClipToWindow(const FRejectSeg &source, const FRejectSeg &pass, FRejectSeg &target)
+{
+	if (pass.IsPoint()) return true;
+
+	// The line continues on the other side of the pass.
+	double s1 = SideOf(pass.v1, pass.v2, source.v1);
+	double s2 = SideOf(pass.v1, pass.v2, source.v2);
+	double sign;
+	if (s1 > REJECT_SLACK && s2 > REJECT_SLACK) sign = -1;
+	else if (s1 < -REJECT_SLACK && s2 < -REJECT_SLACK) sign = 1;
+	else return true;
+	if (!ClipToSide(target, pass.v1, pass.v2, sign)) return false;
+
+	// The separating lines run from one end of the source to one end of the pass
+	// with the rest of the source and the rest of the pass on different sides.
+	const DVector2 *sv[2] = { &source.v1, &source.v2 };
+	const DVector2 *pv[2] = { &pass.v1, &pass.v2 };
+	int numsource = source.IsPoint() ? 1 : 2;
+	for (int i = 0; i < numsource; i++)
+	{
+		for (int j = 0; j < 2; j++)
+		{
+			const DVector2 &a = *sv[i];
+			const DVector2 &b = *pv[j];
+			if ((b - a).LengthSquared() < REJECT_SLACK * REJECT_SLACK) continue;
+
+			double sideother = numsource == 1 ? 0 : SideOf(a, b, *sv[i ^ 1]);
+			double passother = SideOf(a, b, *pv[j ^ 1]);
+			if (fabs(passother) <= REJECT_SLACK) continue;
+			if (fabs(sideother) > REJECT_SLACK && (sideother > 0) == (passother > 0)) continue;
+
+			if (!ClipToSide(target, a, b, passother > 0 ? 1 : -1)) return false;
+		}
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// FRejectBuilder
+//
+//==========================================================================
+
+class FRejectBuilder
+{
+	FLevelLocals *Level;
+	unsigned NumSectors;
+	unsigned RowBytes;
+	TArray<TArray<FRejectPortal>> Portals;	// per sector
+	TArray<int> Component;
+	TArray<uint8_t> Visible;				// one row of RowBytes per sector
+	bool UseFlow = true;
+
+	struct FFlow
+	{
+		uint8_t *row;
+		TArray<uint8_t> onpath;
+		int budget;
+	};
+
+	int Find(int s)
+	{
+		while (Component[s] != s) s = Component[s] = Component[Component[s]];
+		return s;
+	}
+
+	void Union(int a, int b)
+	{
+		a = Find(a);
+		b = Find(b);
+		if (a != b) Component[max(a, b)] = min(a, b);
+	}
+
+	void CollectPortals();
+	bool CheckGeometry();
+	bool CheckBlockmap();
+	bool Flow(FFlow &flow, const FRejectSeg &source, const FRejectSeg &pass, int sector, int depth);
+	void BuildRow(int sector);
+
+public:
+	FRejectBuilder(FLevelLocals *l) : Level(l) {}
+	bool Build(TArray<uint8_t> &matrix, int &numrejected);
+	bool UsedFlow() const { return UseFlow; }
+};
+
+//==========================================================================
+//
+// Sector adjacency through two-sided lines and shared vertices
+//
+//==========================================================================
+
+void FRejectBuilder::CollectPortals()
+{
+	unsigned numlines = Level->lines.Size();
+
+	Component.Resize(NumSectors);
+	for (unsigned i = 0; i < NumSectors; i++) Component[i] = i;
+	Portals.Resize(NumSectors);
+
+	// Sectors touching each vertex, and the pairs that a two-sided line at that vertex connects.
+	TArray<TArray<int>> vertexsectors(Level->vertexes.Size(), true);
+	TArray<TArray<std::pair<int, int>>> vertexlinks(Level->vertexes.Size(), true);
+
+	for (auto &line : Level->lines)
+	{
+		for (auto v : { line.v1, line.v2 })
+		{
+			auto &list = vertexsectors[v - Level->vertexes.Data()];
+			for (auto sec : { line.frontsector, line.backsector })
+			{
+				if (sec != nullptr && list.Find(sec->Index()) == list.Size()) list.Push(sec->Index());
+			}
+		}
+
+		if (line.frontsector == nullptr || line.backsector == nullptr || line.frontsector == line.backsector) continue;
+
+		int front = line.frontsector->Index();
+		int back = line.backsector->Index();
+		int linenum = int(&line - Level->lines.Data());
+		FRejectSeg seg = { line.v1->fPos(), line.v2->fPos() };
+		Portals[front].Push({ seg, linenum, back });
+		Portals[back].Push({ seg, linenum, front });
+		vertexlinks[line.v1 - Level->vertexes.Data()].Push({ front, back });
+		vertexlinks[line.v2 - Level->vertexes.Data()].Push({ front, back });
+		Union(front, back);
+	}
+
+	// A trace passing exactly through a vertex may not be stopped by the lines
+	// ending there, so sectors that only meet at a vertex are connected, too.
+	// Where a two-sided line ends at the vertex, its own portal already covers this.
+	for (unsigned v = 0; v < vertexsectors.Size(); v++)
+	{
+		auto &list = vertexsectors[v];
+		auto &links = vertexlinks[v];
+		DVector2 pos = Level->vertexes[v].fPos();
+		for (unsigned i = 0; i < list.Size(); i++)
+		{
+			Union(list[i], list[0]);
+			for (unsigned j = 0; j < list.Size(); j++)
+			{
+				if (i == j) continue;
+				bool linked = false;
+				for (auto &link : links)
+				{
+					linked |= (link.first == list[i] && link.second == list[j]) || (link.first == list[j] && link.second == list[i]);
+				}
+				if (!linked) Portals[list[i]].Push({ { pos, pos }, int(numlines + v), list[j] });
+			}
+		}
+	}
+}
+
+//==========================================================================
+//
+// CheckGeometry
+//
+// The flow only follows lines, so every part of the map an actor can be
+// placed in must belong to the sector on the line sides around it. Anything
+// else, like unclosed sectors or game nodes that disagree with the GL nodes,
+// joins the affected sectors and makes the table fall back to rejecting
+// only disconnected areas.
+//
+//==========================================================================
+
+bool FRejectBuilder::CheckGeometry()
+{
+	bool consistent = true;
+	auto mismatch = [&](sector_t *a, sector_t *b)
+	{
+		if (a != b)
+		{
+			if (a != nullptr && b != nullptr) Union(a->Index(), b->Index());
+			consistent = false;
+		}
+	};
+
+	for (auto &sub : Level->subsectors)
+	{
+		for (unsigned i = 0; i < sub.numlines; i++)
+		{
+			auto &seg = sub.firstline[i];
+			if (seg.sidedef != nullptr)
+			{
+				mismatch(sub.sector, seg.sidedef->sector);
+			}
+			else if (seg.PartnerSeg != nullptr && seg.PartnerSeg->Subsector != nullptr)
+			{
+				mismatch(sub.sector, seg.PartnerSeg->Subsector->sector);
+			}
+			else if (seg.linedef == nullptr)
+			{
+				consistent = false;
+			}
+		}
+
+		if (Level->gamenodes.Size() > 0 && sub.numlines > 0)
+		{
+			// The game nodes decide which sector an actor is in. Sample the middle
+			// and the corners of each GL subsector to see if they agree.
+			DVector2 center(0, 0);
+			for (unsigned i = 0; i < sub.numlines; i++) center += sub.firstline[i].v1->fPos();
+			center /= sub.numlines;
+			mismatch(sub.sector, Level->PointInSector(center));
+			for (unsigned i = 0; i < sub.numlines; i++)
+			{
+				DVector2 corner = sub.firstline[i].v1->fPos();
+				mismatch(sub.sector, Level->PointInSector(corner + (center - corner) * 0.125));
+			}
+		}
+	}
+	return consistent;
+}
+
+//==========================================================================
+//
+// CheckBlockmap
+//
+// Sight traces only see the lines listed in the blockmap, so a blockmap
+// that leaves out a line from a block it passes through lets sight leak
+// through walls. No table can be made for such maps.
+//
+//==========================================================================
+
+bool FRejectBuilder::CheckBlockmap()
+{
+	auto &bm = Level->blockmap;
+	const double size = FBlockmap::MAPBLOCKUNITS;
+
+	for (auto &line : Level->lines)
+	{
+		DVector2 v1 = line.v1->fPos(), v2 = line.v2->fPos();
+		int bx1 = bm.GetBlockX(min(v1.X, v2.X)), bx2 = bm.GetBlockX(max(v1.X, v2.X));
+		int by1 = bm.GetBlockY(min(v1.Y, v2.Y)), by2 = bm.GetBlockY(max(v1.Y, v2.Y));
+		if (!bm.isValidBlock(bx1, by1) || !bm.isValidBlock(bx2, by2)) return false;
+
+		int linenum = int(&line - Level->lines.Data());
+		for (int by = by1; by <= by2; by++)
+		{
+			for (int bx = bx1; bx <= bx2; bx++)
+			{
+				// Only blocks the line really passes through, with a margin for
+				// lines that merely touch a block's edge.
+				double left = bm.bmaporgx + bx * size + REJECT_SLACK, right = left + size - 2 * REJECT_SLACK;
+				double bottom = bm.bmaporgy + by * size + REJECT_SLACK, top = bottom + size - 2 * REJECT_SLACK;
+				FRejectSeg seg = { v1, v2 };
+				if (!ClipToSide(seg, { left, 0 }, { left, 1 }, 1) ||
+					!ClipToSide(seg, { right, 0 }, { right, 1 }, -1) ||
+					!ClipToSide(seg, { 0, bottom }, { -1, bottom }, 1) ||
+					!ClipToSide(seg, { 0, top }, { -1, top }, -1))
+				{
+					continue;
+				}
+
+				bool found = false;
+				for (int *list = bm.GetLines(bx, by); *list != -1 && !found; list++)
+				{
+					found = *list == linenum;
+				}
+				if (!found) return false;
+			}
+		}
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// Portal flow
+//
+//==========================================================================
+
+bool FRejectBuilder::Flow(FFlow &flow, const FRejectSeg &source, const FRejectSeg &pass, int sector, int depth)
+{
+	if (depth > REJECT_MAX_DEPTH) return false;
+	for (auto &portal : Portals[sector])
+	{
+		if (flow.onpath[portal.id]) continue;	// a straight line cannot cross a line twice
+		if (--flow.budget < 0) return false;
+
+		FRejectSeg target = portal.seg;
+		if (!ClipToWindow(source, pass, target)) continue;
+		FRejectSeg newsource = source;
+		if (!ClipToWindow(target, pass, newsource)) continue;
+
+		flow.row[portal.to >> 3] |= 1 << (portal.to & 7);
+		flow.onpath[portal.id] = true;
+		bool ok = Flow(flow, newsource, target, portal.to, depth + 1);
+		flow.onpath[portal.id] = false;
+		if (!ok) return false;
+	}
+	return true;
+}
+
+void FRejectBuilder::BuildRow(int sector)
+{
+	FFlow flow;
+	flow.row = &Visible[sector * RowBytes];
+	flow.row[sector >> 3] |= 1 << (sector & 7);
+
+	bool ok = UseFlow;
+	if (ok)
+	{
+		flow.onpath.Resize(Level->lines.Size() + Level->vertexes.Size());
+		memset(flow.onpath.Data(), 0, flow.onpath.Size());
+		flow.budget = REJECT_FLOW_BUDGET;
+
+		// Anything right behind a line of this sector and behind a second line
+		// of that neighbour can always be seen. The clipping starts after that.
+		for (auto &first : Portals[sector])
+		{
+			flow.row[first.to >> 3] |= 1 << (first.to & 7);
+			flow.onpath[first.id] = true;
+			for (auto &second : Portals[first.to])
+			{
+				if (flow.onpath[second.id]) continue;
+				flow.row[second.to >> 3] |= 1 << (second.to & 7);
+				flow.onpath[second.id] = true;
+				ok = Flow(flow, first.seg, second.seg, second.to, 0);
+				flow.onpath[second.id] = false;
+				if (!ok) break;
+			}
+			flow.onpath[first.id] = false;
+			if (!ok) break;
+		}
+	}
+
+	if (!ok)
+	{
+		// Too complex or unreliable, so everything that is connected counts as visible.
+		int comp = Component[sector];
+		for (unsigned i = 0; i < NumSectors; i++)
+		{
+			if (Component[i] == comp) flow.row[i >> 3] |= 1 << (i & 7);
+		}
+	}
+}
+
+//==========================================================================
+//
+// Build
+//
+// Creates the matrix in the format of the REJECT lump.
+//
+//==========================================================================
+
+bool FRejectBuilder::Build(TArray<uint8_t> &matrix, int &numrejected)
+{
+	NumSectors = Level->sectors.Size();
+	if (NumSectors < 2 || NumSectors > MAX_REJECT_SECTORS) return false;
+	if (!CheckBlockmap()) return false;
+
+	CollectPortals();
+	UseFlow = CheckGeometry();
+	for (unsigned i = 0; i < NumSectors; i++) Component[i] = Find(i);	// BuildRow runs in parallel and only reads this
+
+	RowBytes = (NumSectors + 7) / 8;
+	Visible.Resize(NumSectors * RowBytes);
+	memset(Visible.Data(), 0, Visible.Size());
+
+	parallel_for((int)NumSectors, [&](int sector)
+	{
+		BuildRow(sector);
+	});
+
+	// Sight checks go both ways, so only reject pairs that neither side could see.
+	matrix.Resize((NumSectors * NumSectors + 7) / 8);
+	memset(matrix.Data(), 0, matrix.Size());
+	numrejected = 0;
+	for (unsigned i = 0; i < NumSectors; i++)
+	{
+		for (unsigned j = 0; j < NumSectors; j++)
+		{
+			if (!(Visible[i * RowBytes + (j >> 3)] & (1 << (j & 7))) && !(Visible[j * RowBytes + (i >> 3)] & (1 << (i & 7))))
+			{
+				unsigned pnum = i * NumSectors + j;
+				matrix[pnum >> 3] |= 1 << (pnum & 7);
+				numrejected++;
+			}
+		}
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// MapLoader::BuildReject
+//
+//==========================================================================
+
+void MapLoader::BuildReject(MapData *map)
+{
+	if (!genreject || Level->maptype == MAPTYPE_BUILD) return;
+
+	if (!CheckCachedReject(map))
+	{
+		uint64_t startTime = I_msTime();
+		FRejectBuilder builder(Level);
+		int numrejected;
+
+		if (!builder.Build(Level->rejectmatrix, numrejected))
+		{
+			DPrintf(DMSG_NOTIFY, "Not generating REJECT for this map\n");
+			Level->rejectmatrix.Reset();
+			return;
+		}
+		uint64_t endTime = I_msTime();
+		DPrintf(DMSG_NOTIFY, "REJECT generation took %.3f sec (%d of %u sector pairs rejected%s)\n", (endTime - startTime) * 0.001,
+			numrejected, Level->sectors.Size() * Level->sectors.Size(), builder.UsedFlow() ? "" : ", connectivity only");
+
+		if (gl_cachenodes && (endTime - startTime) / 1000.f >= gl_cachetime)
+		{
+			CreateCachedReject(map);
+		}
+	}
+	Level->rejectgenerated = true;
+}
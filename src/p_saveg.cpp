@@ -63,8 +63,11 @@
 #include "s_music.h"
 #include "model.h"
 #include "d_net.h"
+#include "c_dispatch.h"
+#include "i_time.h"
 
 EXTERN_CVAR(Bool, save_formatted)
+EXTERN_CVAR(Bool, save_binary)
 
 //==========================================================================
 //
@@ -1094,7 +1097,7 @@ void FLevelLocals::Serialize(FSerializer &arc, bool hubload)
 //
 //==========================================================================
 
-void FLevelLocals::SnapshotLevel()
+void FLevelLocals::SnapshotLevel(bool compress)
 {
 	info->Snapshot.Clean();
 
@@ -1102,15 +1105,58 @@ void FLevelLocals::SnapshotLevel()
 	{
 		FDoomSerializer arc(this);
 
-		if (arc.OpenWriter(save_formatted))
+		if (arc.OpenWriter(save_formatted, save_binary && !save_formatted))
 		{
 			SaveVersion = SAVEVER;
 			Serialize(arc, false);
-			info->Snapshot = arc.GetCompressedOutput();
+			// Savegames compress the snapshot themselves when writing the file.
+			info->Snapshot = compress ? arc.GetCompressedOutput() : arc.GetStoredOutput();
 		}
 	}
 }
 
+//==========================================================================
+//
+// Compares the snapshot formats on the current level: time to write
+// and to read back into a document, and the size of the result.
+//
+//==========================================================================
+
+CCMD(snapshotbench)
+{
+	if (gamestate != GS_LEVEL || !primaryLevel->info->isValid())
+	{
+		Printf("Not in a level\n");
+		return;
+	}
+
+	static const char *const formats[] = { "JSON", "Formatted JSON", "Binary" };
+	for (int format = 0; format < 3; format++)
+	{
+		uint64_t start = I_nsTime();
+		FDoomSerializer arc(primaryLevel);
+		arc.OpenWriter(format == 1, format == 2);
+		SaveVersion = SAVEVER;
+		primaryLevel->Serialize(arc, false);
+		auto buff = arc.GetStoredOutput();
+		arc.Close();
+		uint64_t written = I_nsTime();
+
+		FSerializer reader;
+		reader.OpenReader(buff.mBuffer, buff.mSize);
+		reader.Close();
+		uint64_t read = I_nsTime();
+
+		size_t size = buff.mSize;
+		FSerializer::CompressOutput(buff);
+		uint64_t compressed = I_nsTime();
+
+		Printf("%-15s write %8.2f ms, read %8.2f ms, compress %8.2f ms, %10zu bytes, %10zu compressed\n", formats[format],
+			(written - start) / 1e6, (read - written) / 1e6, (compressed - read) / 1e6, size, buff.mCompressedSize);
+		buff.Clean();
+	}
+}
+
 //==========================================================================
 //
 // Unarchives the current level based on its snapshot
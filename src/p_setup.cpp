@@ -343,6 +343,8 @@ void FLevelLocals::ClearLevelData(bool fullgc)
 	subsectorbuffer.Clear();
 	lines.Clear();
 	sides.Clear();
+	LightLinks.Clear();
+	LightLinksDirty = false;
 	segbuffer.Clear();
 	loadsectors.Clear();
 	loadlines.Clear();
@@ -353,6 +355,7 @@ void FLevelLocals::ClearLevelData(bool fullgc)
 	subsectors.Clear();
 	gamesubsectors.Reset();
 	rejectmatrix.Clear();
+	rejectgenerated = false;
 	Zones.Clear();
 	blockmap.Clear();
 	Polyobjects.Clear();
@@ -633,6 +636,7 @@ void P_Shutdown ()
 		Level->Thinkers.DestroyThinkersInList(STAT_STATIC);
 	}
 	P_FreeLevelData ();
+	P_ClearCompiledACS();
 	// [ZZ] delete global event handlers
 	staticEventManager.Shutdown();	// clear out the handlers before starting the engine shutdown
 	ST_Clear();
@@ -204,6 +204,12 @@ DEFINE_ACTION_FUNCTION_NATIVE(ADynamicLight, SetOffset, SetOffset)
 
 void FDynamicLight::ReleaseLight()
 {
+	if (links != nullptr)
+	{
+		delete links;
+		links = nullptr;
+		Level->LightLinksDirty = true;
+	}
 	assert(prev != nullptr || this == Level->lights);
 	if (prev != nullptr) prev->next = next;
 	else Level->lights = next;
@@ -412,86 +418,6 @@ void FDynamicLight::UpdateLocation()
 	}
 }
 
-//=============================================================================
-//
-// These have been copied from the secnode code and modified for the light links
-//
-// P_AddSecnode() searches the current list to see if this sector is
-// already there. If not, it adds a sector node at the head of the list of
-// sectors this object appears in. This is called when creating a list of
-// nodes that will get linked in later. Returns a pointer to the new node.
-//
-//=============================================================================
-
-FLightNode * AddLightNode(FLightNode ** thread, void * linkto, FDynamicLight * light, FLightNode *& nextnode)
-{
-	FLightNode * node;
-
-	node = nextnode;
-	while (node)
-    {
-		if (node->targ==linkto)   // Already have a node for this sector?
-		{
-			node->lightsource = light; // Yes. Setting m_thing says 'keep it'.
-			return(nextnode);
-		}
-		node = node->nextTarget;
-    }
-
-	// Couldn't find an existing node for this sector. Add one at the head
-	// of the list.
-	
-	node = new FLightNode;
-	
-	node->targ = linkto;
-	node->lightsource = light; 
-
-	node->prevTarget = &nextnode; 
-	node->nextTarget = nextnode;
-
-	if (nextnode) nextnode->prevTarget = &node->nextTarget;
-	
-	// Add new node at head of sector thread starting at s->touching_thinglist
-	
-	node->prevLight = thread;  	
-	node->nextLight = *thread; 
-	if (node->nextLight) node->nextLight->prevLight=&node->nextLight;
-	*thread = node;
-	return(node);
-}
-
-
-//=============================================================================
-//
-// P_DelSecnode() deletes a sector node from the list of
-// sectors this object appears in. Returns a pointer to the next node
-// on the linked list, or nullptr.
-//
-//=============================================================================
-
-static FLightNode * DeleteLightNode(FLightNode * node)
-{
-	FLightNode * tn;  // next node on thing thread
-	
-	if (node)
-    {
-		
-		*node->prevTarget = node->nextTarget;
-		if (node->nextTarget) node->nextTarget->prevTarget=node->prevTarget;
-
-		*node->prevLight = node->nextLight;
-		if (node->nextLight) node->nextLight->prevLight=node->prevLight;
-		
-		// Return this node to the freelist
-		tn=node->nextTarget;
-		delete node;
-		return(tn);
-	}
-	return(nullptr);
-}
-
-
-
 //==========================================================================
 //
 // Gets the light's distance to a line
@@ -546,7 +472,8 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 		auto pos = collected_ss[i].pos;
 		section = collected_ss[i].sect;
 
-		touching_sector = AddLightNode(&section->lighthead, section, this, touching_sector);
+		// Sections reached through a portal may come up more than once.
+		if (links->Sections.Find(section) == links->Sections.Size()) links->Sections.Push(section);
 
 
 		auto processSide = [&](side_t *sidedef, const vertex_t *v1, const vertex_t *v2)
@@ -558,7 +485,7 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 				if ((pos.Y - v1->fY()) * (v2->fX() - v1->fX()) + (v1->fX() - pos.X) * (v2->fY() - v1->fY()) <= 0)
 				{
 					linedef->validcount = ::validcount;
-					touching_sides = AddLightNode(&sidedef->lighthead, sidedef, this, touching_sides);
+					links->Sides.Push(sidedef);
 				}
 				else if (linedef->sidedef[0] == sidedef && linedef->sidedef[1] == nullptr)
 				{
@@ -654,13 +581,13 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 
 void FDynamicLight::CollectAll(const DVector3 &opos)
 {
-	for (int i = 0 ; i < Level->sections.allSections.Size() ; i++)
+	for (auto &section : Level->sections.allSections)
 	{
-		touching_sector = AddLightNode(&Level->sections.allSections[i].lighthead, &Level->sections.allSections[i], this, touching_sector);
+		links->Sections.Push(&section);
 	}
-	for (int i = 0 ; i < Level->sides.Size(); i++)
+	for (auto &side : Level->sides)
 	{
-		touching_sides = AddLightNode(&Level->sides[i].lighthead, &Level->sides[i], this, touching_sides);
+		links->Sides.Push(&side);
 	}
 	shadowmapped = false;
 }
@@ -676,21 +603,10 @@ void FDynamicLight::LinkLight()
 	if (isglobal)
 		return;
 
-	// mark the old light nodes
-	FLightNode * node;
-	
-	node = touching_sides;
-	while (node)
-    {
-		node->lightsource = nullptr;
-		node = node->nextTarget;
-    }
-	node = touching_sector;
-	while (node)
-	{
-		node->lightsource = nullptr;
-		node = node->nextTarget;
-	}
+	// The link arrays are kept so that relinking a moving light does not allocate anything.
+	if (links == nullptr) links = new FLightLinkSet;
+	links->Sections.Clear();
+	links->Sides.Clear();
 
 	if (radius>0)
 	{
@@ -711,43 +627,23 @@ void FDynamicLight::LinkLight()
 		}
 
 	}
-		
-	// Now delete any nodes that won't be used. These are the ones where
-	// m_thing is still nullptr.
-	
-	node = touching_sides;
-	while (node)
-	{
-		if (node->lightsource == nullptr)
-		{
-			node = DeleteLightNode(node);
-		}
-		else
-			node = node->nextTarget;
-	}
-
-	node = touching_sector;
-	while (node)
-	{
-		if (node->lightsource == nullptr)
-		{
-			node = DeleteLightNode(node);
-		}
-		else
-			node = node->nextTarget;
-	}
+	Level->LightLinksDirty = true;
 }
 
 
 //==========================================================================
 //
-// Deletes the link lists
+// Deletes the links
 //
 //==========================================================================
 void FDynamicLight::UnlinkLight ()
 {
-	while (touching_sides) touching_sides = DeleteLightNode(touching_sides);
-	while (touching_sector) touching_sector = DeleteLightNode(touching_sector);
+	if (links != nullptr)
+	{
+		links->Sections.Clear();
+		links->Sides.Clear();
+	}
+	Level->LightLinksDirty = true;
 	shadowmapped = false;
 	isglobal = false;
 }
@@ -1023,3 +919,56 @@ void FLevelLocals::RecreateAllAttachedLights()
 		}
 	}
 }
+
+//==========================================================================
+//
+// Packs the lights touching each section and sidedef into one array.
+// This is done in bulk before rendering whenever a light got relinked,
+// so moving lights do not need to maintain any per-section lists.
+//
+//==========================================================================
+
+void FLevelLocals::UpdateLightLinks()
+{
+	static TArray<unsigned> offsets;
+
+	if (!LightLinksDirty) return;
+	LightLinksDirty = false;
+
+	unsigned numsections = sections.allSections.Size();
+	offsets.Resize(numsections + sides.Size());
+	if (offsets.Size() > 0) memset(offsets.Data(), 0, offsets.Size() * sizeof(unsigned));
+
+	for (auto light = lights; light; light = light->next)
+	{
+		if (light->links == nullptr) continue;
+		for (auto sect : light->links->Sections) offsets[sections.SectionIndex(sect)]++;
+		for (auto side : light->links->Sides) offsets[numsections + side->Index()]++;
+	}
+
+	unsigned total = 0;
+	for (auto &offset : offsets)
+	{
+		unsigned count = offset;
+		offset = total;
+		total += count;
+	}
+	LightLinks.Resize(total);
+
+	// This advances each offset to the end of its list.
+	for (auto light = lights; light; light = light->next)
+	{
+		if (light->links == nullptr) continue;
+		for (auto sect : light->links->Sections) LightLinks[offsets[sections.SectionIndex(sect)]++] = light;
+		for (auto side : light->links->Sides) LightLinks[offsets[numsections + side->Index()]++] = light;
+	}
+
+	unsigned start = 0;
+	for (unsigned i = 0; i < offsets.Size(); i++)
+	{
+		FLightList list(LightLinks.Data() + start, offsets[i] - start);
+		if (i < numsections) sections.allSections[i].lights = list;
+		else sides[i - numsections].lights = list;
+		start = offsets[i];
+	}
+}
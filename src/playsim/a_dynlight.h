@@ -180,19 +180,12 @@ protected:
 };
 
 
-struct FLightNode
+// The sections and sidedefs a light touches. The renderer does not read these
+// but the per-section and per-sidedef lists FLevelLocals::UpdateLightLinks packs from them.
+struct FLightLinkSet
 {
-	FLightNode ** prevTarget;
-	FLightNode * nextTarget;
-	FLightNode ** prevLight;
-	FLightNode * nextLight;
-	FDynamicLight * lightsource;
-	union
-	{
-		side_t * targLine;
-		subsector_t * targSubsector;
-		void * targ;
-	};
+	TArray<FSection *> Sections;
+	TArray<side_t *> Sides;
 };
 
 struct FDynamicLight
@@ -272,8 +265,7 @@ public:
 	sector_t *Sector;
 	FLevelLocals *Level;
 	TObjPtr<AActor *> target;
-	FLightNode * touching_sides;
-	FLightNode * touching_sector;
+	FLightLinkSet *links;
 	float radius;			// The maximum size the light can be with its current settings.
 	float m_currentRadius;	// The current light size.
 	int m_tickCount;
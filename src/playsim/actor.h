@@ -1167,6 +1167,7 @@ public:
 // interaction info
 	TArray<TObjPtr<AActor*> > Path;
 	FBlockNode		*BlockNode;			// links in blocks (if needed)
+	uint64_t		BlockQueryStamp;	// last FMultiBlockThingsIterator::Collect pass that returned this actor
 	struct sector_t	*Sector;
 	subsector_t *		subsector;
 	FSection *			section;
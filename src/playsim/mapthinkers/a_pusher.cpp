@@ -204,10 +204,19 @@ void DPusher::Tick ()
 
 		FPortalGroupArray check(FPortalGroupArray::PGA_NoSectorPortals);	// no sector portals because this thing is utterly z-unaware.
 		FMultiBlockThingsIterator it(check, m_Source, m_Radius);
-		FMultiBlockThingsIterator::CheckResult cres;
-
-
-		while (it.Next(&cres))
+		static TArray<FMultiBlockThingsIterator::CheckResult> candidates;
+		static TArray<AActor *> pushed;
+		static TArray<DAngle> pushangles;
+		static TArray<double> pushspeeds;
+		static TArray<bool> cansee;
+
+		candidates.Clear();
+		pushed.Clear();
+		pushangles.Clear();
+		pushspeeds.Clear();
+		it.Collect(candidates);
+
+		for (auto &cres : candidates)
 		{
 			AActor *thing = cres.thing;
 			// Normal ZDoom is based only on the WINDTHRUST flag, with the noclip cheat as an exemption.
@@ -229,14 +238,23 @@ void DPusher::Tick ()
 				// If speed <= 0, you're outside the effective radius. You also have
 				// to be able to see the push/pull source point.
 
-				if ((speed > 0) && (P_CheckSight (thing, m_Source, SF_IGNOREVISIBILITY)))
+				if (speed > 0)
 				{
 					DAngle pushangle = pos.Angle();
 					if (m_Source->IsKindOf(NAME_PointPuller)) pushangle += DAngle::fromDeg(180);
-					thing->Thrust(pushangle, speed);
+					pushed.Push(thing);
+					pushangles.Push(pushangle);
+					pushspeeds.Push(speed);
 				}
 			}
 		}
+
+		// Thrusting only changes velocities, so all sight checks can be done in one go.
+		P_CheckSightBatch(m_Source, pushed, SF_IGNOREVISIBILITY, cansee);
+		for (unsigned i = 0; i < pushed.Size(); i++)
+		{
+			if (cansee[i]) pushed[i]->Thrust(pushangles[i], pushspeeds[i]);
+		}
 		return;
 	}
 
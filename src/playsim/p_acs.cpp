@@ -78,6 +78,8 @@
 #include "s_music.h"
 #include "v_video.h"
 #include "texturemanager.h"
+#include "vmbuilder.h"
+#include "md5.h"
 
 	// P-codes for ACS scripts
 	enum
@@ -542,10 +544,17 @@
 
 FRandom pr_acs ("ACS");
 
+// Run p-code that can be translated as VM functions. See RunCompiledACS.
+CVAR(Bool, acs_compile, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
 // I imagine this much stack space is probably overkill, but it could
 // potentially get used with recursive functions.
 #define STACK_SIZE 4096
 
+// Instructions a script may execute in one RunScript call before it is
+// terminated as runaway.
+#define RUNAWAY_LIMIT 2000000
+
 // HUD message flags
 #define HUDMSG_LOG					(0x80000000)
 #define HUDMSG_COLORSTRING			(0x40000000)
@@ -1958,6 +1967,7 @@ FBehavior *FBehaviorContainer::LoadModule (int lumpnum, FileReader *fr, int len,
 	FBehavior * behavior = new FBehavior ();
 	if (behavior->Init(Level, lumpnum, fr, len, reallumpnum))
 	{
+		if (acs_compile) behavior->CompileScripts();
 		return behavior;
 	}
 	else
@@ -2203,6 +2213,7 @@ FBehavior::FBehavior()
 	Data = NULL;
 	Format = ACS_Unknown;
 	LumpNum = -1;
+	CompiledID = -1;
 	memset (MapVarStore, 0, sizeof(MapVarStore));
 	ModuleName[0] = 0;
 	FunctionProfileData = NULL;
@@ -3410,10 +3421,25 @@ void DACSThinker::Serialize(FSerializer &arc)
 }
 
 cycle_t ACSTime;
+static cycle_t ACSRunTime;			// time spent in RunScript during the last tic
+static unsigned ACSInstructions;	// p-code instructions executed during the last tic
+static unsigned ACSScriptRuns;
+static unsigned ACSCompiledInstructions;	// the part of them that ran as compiled code
+static int ACSRunDepth;
+
+// Scripts started with immediate execution run inside another script,
+// so only the outermost RunScript call is clocked.
+struct FACSRunClock
+{
+	FACSRunClock() { if (ACSRunDepth++ == 0) ACSRunTime.Clock(); }
+	~FACSRunClock() { if (--ACSRunDepth == 0) ACSRunTime.Unclock(); }
+};
 
 void DACSThinker::Tick ()
 {
 	ACSTime.Reset();
+	ACSRunTime.Reset();
+	ACSInstructions = ACSScriptRuns = ACSCompiledInstructions = 0;
 	ACSTime.Clock();
 	DLevelScript *script = Scripts;
 
@@ -6871,8 +6897,830 @@ PClass *DLevelScript::GetClassForIndex(int index) const
 	return PClass::FindActor(Level->Behaviors.LookupString(index));
 }
 
+//==========================================================================
+//
+// Compiled ACS
+//
+// Runs of p-code that only use the stack, integer arithmetic, script, map,
+// world and global variables and branches are translated into VM functions,
+// which the JIT turns into native code when vm_jit is on. A block is
+// compiled for the pc the interpreter is about to execute and covers
+// everything reachable from there through supported instructions. Whenever
+// it gets to an instruction it cannot handle it returns to the interpreter
+// in front of it, along with the stack depth at that point and the number
+// of instructions it ran.
+//
+// Blocks only depend on the module's p-code, so they are shared by all
+// loaded copies of a module, e.g. a library that every map imports.
+//
+//==========================================================================
+
+struct FACSBlockExit
+{
+	uint32_t Offset;	// where the interpreter continues
+	int Depth;			// stack depth there, relative to the block's entry
+};
+
+struct FACSBlock
+{
+	VMScriptFunction *Func = nullptr;	// nullptr if nothing can be compiled at this pc
+	TArray<FACSBlockExit> Exits;
+	int MinDepth = 0;					// lowest stack slot used, relative to the entry
+	int MaxDepth = 0;					// one past the highest stack slot used
+	unsigned NumLocals = 0;				// local variables the block accesses
+};
+
+static TMap<FString, int> ACSModuleIDs;
+static TMap<uint64_t, FACSBlock> ACSBlocks;
+
+class FACSTranslator
+{
+	enum
+	{
+		MAX_BLOCK_SIZE = 2048,
+		MAX_SCRIPT_VARS = 65536,
+	};
+
+	enum
+	{
+		SCOPE_Script,
+		SCOPE_Map,
+		SCOPE_World,
+		SCOPE_Global,
+	};
+
+	struct Insn
+	{
+		uint32_t Ofs;
+		uint32_t Next;
+		uint32_t Target;
+		int Pcd;
+		int Arg;
+		int NumBytes;		// for the PUSH*BYTES instructions, which find their bytes at offset Arg
+		int Scope;			// for the variable instructions, which are all mapped to their SCRIPTVAR form
+		int Change;			// stack depth change when falling through
+		int TargetChange;	// stack depth change when branching
+		bool Falls;
+		bool Branches;
+		bool Leader;
+		int Depth;
+		int Remaining;		// instructions from this one to the end of its basic block
+		int FallExit;		// exit taken instead of falling through, or -1
+		int TargetExit;		// exit taken instead of branching, or -1
+	};
+
+	struct Exit
+	{
+		FACSBlockExit Where;
+		int Unexecuted;		// instructions counted by the block that did not run
+	};
+
+	FBehavior *Module;
+	const uint8_t *Data;
+	uint32_t DataSize;
+	bool Enhanced;
+
+	TArray<Insn> Code;
+	TMap<uint32_t, unsigned> Index;
+	TArray<Exit> Exits;
+
+	VMFunctionBuilder Build;
+	TArray<std::pair<size_t, unsigned>> Jumps;
+	TArray<std::pair<size_t, int>> ExitJumps;
+	int StackReg, LocalReg, MapReg, WorldReg, GlobalReg, VarReg;
+	int BudgetReg, CountReg, T0, T1, T2;
+	FACSBlock *Block;
+
+public:
+	FACSTranslator(FBehavior *module)
+		: Module(module), Build(0)
+	{
+		Data = (const uint8_t *)module->Ofs2PC(0);
+		DataSize = module->GetDataSize();
+		Enhanced = module->GetFormat() == ACS_LittleEnhanced;
+	}
+
+	void Compile(uint32_t start, FACSBlock &block);
+
+private:
+	bool ReadByte(uint32_t &ofs, int &val)
+	{
+		if (ofs >= DataSize) return false;
+		val = Data[ofs++];
+		return true;
+	}
+
+	bool ReadWord(uint32_t &ofs, int &val)
+	{
+		if (ofs >= DataSize || DataSize - ofs < 4) return false;
+		val = int(Data[ofs] | (Data[ofs + 1] << 8) | (Data[ofs + 2] << 16) | (uint32_t(Data[ofs + 3]) << 24));
+		ofs += 4;
+		return true;
+	}
+
+	// Operands read with NEXTBYTE in the interpreter
+	bool ReadOperand(uint32_t &ofs, int &val)
+	{
+		return Enhanced ? ReadByte(ofs, val) : ReadWord(ofs, val);
+	}
+
+	bool Decode(uint32_t ofs, Insn &insn);
+	int Reach(uint32_t ofs, int depth, TArray<unsigned> &work);
+	int AddExit(uint32_t ofs, int depth, int unexecuted);
+	void Discover(uint32_t start);
+	int Slot(int depth);
+	void Load(int reg, int depth);
+	void Store(int reg, int depth);
+	void Variable(const Insn &insn, int &areg, int &konst);
+	void EmitJump(int exit, uint32_t target);
+	void EmitInsn(const Insn &insn);
+};
+
+//==========================================================================
+//
+// FACSTranslator :: Decode
+//
+// Returns false for anything the translator does not support.
+//
+//==========================================================================
+
+bool FACSTranslator::Decode(uint32_t ofs, Insn &insn)
+{
+	static const int VarPcds[][4] =
+	{
+		{ PCD_PUSHSCRIPTVAR, PCD_PUSHMAPVAR, PCD_PUSHWORLDVAR, PCD_PUSHGLOBALVAR },
+		{ PCD_ASSIGNSCRIPTVAR, PCD_ASSIGNMAPVAR, PCD_ASSIGNWORLDVAR, PCD_ASSIGNGLOBALVAR },
+		{ PCD_ADDSCRIPTVAR, PCD_ADDMAPVAR, PCD_ADDWORLDVAR, PCD_ADDGLOBALVAR },
+		{ PCD_SUBSCRIPTVAR, PCD_SUBMAPVAR, PCD_SUBWORLDVAR, PCD_SUBGLOBALVAR },
+		{ PCD_INCSCRIPTVAR, PCD_INCMAPVAR, PCD_INCWORLDVAR, PCD_INCGLOBALVAR },
+		{ PCD_DECSCRIPTVAR, PCD_DECMAPVAR, PCD_DECWORLDVAR, PCD_DECGLOBALVAR },
+	};
+	static const int VarLimits[] = { MAX_SCRIPT_VARS, NUM_MAPVARS, NUM_WORLDVARS, NUM_GLOBALVARS };
+
+	int pcd;
+
+	insn.Ofs = ofs;
+	insn.Arg = insn.NumBytes = insn.Scope = 0;
+	insn.Change = insn.TargetChange = 0;
+	insn.Falls = true;
+	insn.Branches = false;
+	insn.Target = 0;
+
+	if (Enhanced)
+	{
+		if (!ReadByte(ofs, pcd)) return false;
+		if (pcd >= 256-16)
+		{
+			int ext;
+			if (!ReadByte(ofs, ext)) return false;
+			pcd = (256-16) + ((pcd - (256-16)) << 8) + ext;
+		}
+	}
+	else if (!ReadWord(ofs, pcd))
+	{
+		return false;
+	}
+	insn.Pcd = pcd;
+
+	switch (pcd)
+	{
+	case PCD_NOP:
+	case PCD_SWAP:
+	case PCD_NEGATELOGICAL:
+	case PCD_NEGATEBINARY:
+	case PCD_UNARYMINUS:
+		break;
+
+	case PCD_DUP:
+		insn.Change = 1;
+		break;
+
+	case PCD_DROP:
+	case PCD_ADD:
+	case PCD_SUBTRACT:
+	case PCD_MULTIPLY:
+	case PCD_DIVIDE:
+	case PCD_MODULUS:
+	case PCD_EQ:
+	case PCD_NE:
+	case PCD_LT:
+	case PCD_GT:
+	case PCD_LE:
+	case PCD_GE:
+	case PCD_ANDLOGICAL:
+	case PCD_ORLOGICAL:
+	case PCD_ANDBITWISE:
+	case PCD_ORBITWISE:
+	case PCD_EORBITWISE:
+	case PCD_LSHIFT:
+	case PCD_RSHIFT:
+		insn.Change = -1;
+		break;
+
+	case PCD_PUSHNUMBER:
+		if (!ReadWord(ofs, insn.Arg)) return false;
+		insn.Change = 1;
+		break;
+
+	case PCD_PUSHBYTE:
+	case PCD_PUSH2BYTES:
+	case PCD_PUSH3BYTES:
+	case PCD_PUSH4BYTES:
+	case PCD_PUSH5BYTES:
+		insn.NumBytes = pcd == PCD_PUSHBYTE ? 1 : pcd - PCD_PUSH2BYTES + 2;
+		insn.Arg = ofs;
+		ofs += insn.NumBytes;
+		if (ofs > DataSize) return false;
+		insn.Change = insn.NumBytes;
+		break;
+
+	case PCD_PUSHBYTES:
+		if (!ReadByte(ofs, insn.NumBytes)) return false;
+		insn.Arg = ofs;
+		ofs += insn.NumBytes;
+		if (ofs > DataSize) return false;
+		insn.Change = insn.NumBytes;
+		break;
+
+	case PCD_GOTO:
+	case PCD_IFGOTO:
+	case PCD_IFNOTGOTO:
+	{
+		int target;
+		if (!ReadWord(ofs, target) || uint32_t(target) >= DataSize) return false;
+		insn.Target = target;
+		insn.Branches = true;
+		insn.Falls = pcd != PCD_GOTO;
+		insn.Change = insn.TargetChange = pcd == PCD_GOTO ? 0 : -1;
+		break;
+	}
+
+	case PCD_CASEGOTO:
+	{
+		int target;
+		if (!ReadWord(ofs, insn.Arg) || !ReadWord(ofs, target) || uint32_t(target) >= DataSize) return false;
+		insn.Target = target;
+		insn.Branches = true;
+		insn.TargetChange = -1;
+		break;
+	}
+
+	default:
+		for (auto &row : VarPcds)
+		{
+			for (int scope = SCOPE_Script; scope <= SCOPE_Global; scope++)
+			{
+				if (row[scope] == pcd)
+				{
+					if (!ReadOperand(ofs, insn.Arg) || insn.Arg < 0 || insn.Arg >= VarLimits[scope]) return false;
+					insn.Pcd = row[SCOPE_Script];
+					insn.Scope = scope;
+					insn.Change = insn.Pcd == PCD_PUSHSCRIPTVAR ? 1 : insn.Pcd == PCD_INCSCRIPTVAR || insn.Pcd == PCD_DECSCRIPTVAR ? 0 : -1;
+					insn.Next = ofs;
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+	insn.Next = ofs;
+	return true;
+}
+
+//==========================================================================
+//
+// FACSTranslator :: Reach
+//
+// Returns the index of the instruction at ofs, queueing it up if it has not
+// been reached before, or -1 if the block has to exit there instead.
+//
+//==========================================================================
+
+int FACSTranslator::Reach(uint32_t ofs, int depth, TArray<unsigned> &work)
+{
+	if (auto index = Index.CheckKey(ofs))
+	{
+		// Joins need the same stack layout on every path.
+		return Code[*index].Depth == depth ? int(*index) : -1;
+	}
+
+	Insn insn;
+	if (Code.Size() >= MAX_BLOCK_SIZE || !Decode(ofs, insn))
+	{
+		return -1;
+	}
+	insn.Depth = depth;
+	insn.Leader = false;
+	insn.Remaining = 0;
+	insn.FallExit = insn.TargetExit = -1;
+	unsigned index = Code.Push(insn);
+	Index[ofs] = index;
+	work.Push(index);
+	return index;
+}
+
+int FACSTranslator::AddExit(uint32_t ofs, int depth, int unexecuted)
+{
+	Exit exit = { { ofs, depth }, unexecuted };
+	return Exits.Push(exit);
+}
+
+//==========================================================================
+//
+// FACSTranslator :: Discover
+//
+// Collects every instruction reachable from start, sorts them by offset
+// and splits them into basic blocks.
+//
+//==========================================================================
+
+void FACSTranslator::Discover(uint32_t start)
+{
+	TArray<unsigned> work;
+
+	if (Reach(start, 0, work) < 0)
+	{
+		return;
+	}
+	while (work.Size() > 0)
+	{
+		unsigned i;
+		work.Pop(i);
+		if (Code[i].Falls && Reach(Code[i].Next, Code[i].Depth + Code[i].Change, work) < 0)
+		{
+			Code[i].FallExit = AddExit(Code[i].Next, Code[i].Depth + Code[i].Change, 0);
+		}
+		if (Code[i].Branches && Reach(Code[i].Target, Code[i].Depth + Code[i].TargetChange, work) < 0)
+		{
+			Code[i].TargetExit = AddExit(Code[i].Target, Code[i].Depth + Code[i].TargetChange, 0);
+		}
+	}
+
+	std::sort(Code.begin(), Code.end(), [](const Insn &a, const Insn &b) { return a.Ofs < b.Ofs; });
+	Index.Clear();
+	for (unsigned i = 0; i < Code.Size(); i++)
+	{
+		Index[Code[i].Ofs] = i;
+	}
+
+	// A basic block starts wherever control does not just fall in from the previous instruction.
+	for (unsigned i = 0; i < Code.Size(); i++)
+	{
+		auto &insn = Code[i];
+		if (insn.Ofs == start || i == 0) insn.Leader = true;
+		else
+		{
+			auto &prev = Code[i - 1];
+			insn.Leader |= prev.Branches || !prev.Falls || prev.FallExit >= 0 || prev.Next != insn.Ofs;
+		}
+		if (insn.Branches && insn.TargetExit < 0)
+		{
+			Code[*Index.CheckKey(insn.Target)].Leader = true;
+		}
+	}
+	for (unsigned i = Code.Size(); i-- > 0; )
+	{
+		Code[i].Remaining = i + 1 < Code.Size() && !Code[i + 1].Leader ? Code[i + 1].Remaining + 1 : 1;
+	}
+}
+
+//==========================================================================
+//
+// FACSTranslator :: stack and variable access
+//
+// Stack slots are addressed relative to the stack pointer at the block's
+// entry, which the caller checks against the stack's bounds.
+//
+//==========================================================================
+
+int FACSTranslator::Slot(int depth)
+{
+	Block->MinDepth = min(Block->MinDepth, depth);
+	Block->MaxDepth = max(Block->MaxDepth, depth + 1);
+	return Build.GetConstantInt(depth * (int)sizeof(int32_t));
+}
+
+void FACSTranslator::Load(int reg, int depth)
+{
+	Build.Emit(OP_LW, reg, StackReg, Slot(depth));
+}
+
+void FACSTranslator::Store(int reg, int depth)
+{
+	Build.Emit(OP_SW, StackReg, reg, Slot(depth));
+}
+
+void FACSTranslator::Variable(const Insn &insn, int &areg, int &konst)
+{
+	switch (insn.Scope)
+	{
+	case SCOPE_Script:
+		Block->NumLocals = max<unsigned>(Block->NumLocals, insn.Arg + 1);
+		areg = LocalReg;
+		konst = Build.GetConstantInt(insn.Arg * (int)sizeof(int32_t));
+		break;
+
+	case SCOPE_Map:
+		Build.Emit(OP_LP, VarReg, MapReg, Build.GetConstantInt(insn.Arg * (int)sizeof(int32_t *)));
+		areg = VarReg;
+		konst = Build.GetConstantInt(0);
+		break;
+
+	default:
+		areg = insn.Scope == SCOPE_World ? WorldReg : GlobalReg;
+		konst = Build.GetConstantInt(insn.Arg * (int)sizeof(int32_t));
+		break;
+	}
+}
+
+void FACSTranslator::EmitJump(int exit, uint32_t target)
+{
+	size_t addr = Build.Emit(OP_JMP, 0);
+	if (exit >= 0) ExitJumps.Push(std::make_pair(addr, exit));
+	else Jumps.Push(std::make_pair(addr, *Index.CheckKey(target)));
+}
+
+//==========================================================================
+//
+// FACSTranslator :: EmitInsn
+//
+// Does the same as the corresponding case in DLevelScript::RunScript.
+//
+//==========================================================================
+
+void FACSTranslator::EmitInsn(const Insn &insn)
+{
+	const int d = insn.Depth;
+	int areg, konst;
+
+	switch (insn.Pcd)
+	{
+	case PCD_NOP:
+	case PCD_DROP:
+	case PCD_GOTO:
+		break;
+
+	case PCD_PUSHNUMBER:
+		Build.EmitLoadInt(T0, insn.Arg);
+		Store(T0, d);
+		break;
+
+	case PCD_PUSHBYTE:
+	case PCD_PUSH2BYTES:
+	case PCD_PUSH3BYTES:
+	case PCD_PUSH4BYTES:
+	case PCD_PUSH5BYTES:
+	case PCD_PUSHBYTES:
+		for (int i = 0; i < insn.NumBytes; i++)
+		{
+			Build.EmitLoadInt(T0, Data[insn.Arg + i]);
+			Store(T0, d + i);
+		}
+		break;
+
+	case PCD_DUP:
+		Load(T0, d - 1);
+		Store(T0, d);
+		break;
+
+	case PCD_SWAP:
+		Load(T0, d - 2);
+		Load(T1, d - 1);
+		Store(T1, d - 2);
+		Store(T0, d - 1);
+		break;
+
+	case PCD_ADD:
+	case PCD_SUBTRACT:
+	case PCD_MULTIPLY:
+	case PCD_DIVIDE:
+	case PCD_MODULUS:
+	case PCD_ANDBITWISE:
+	case PCD_ORBITWISE:
+	case PCD_EORBITWISE:
+	case PCD_LSHIFT:
+	case PCD_RSHIFT:
+	{
+		int op = insn.Pcd == PCD_ADD ? OP_ADD_RR : insn.Pcd == PCD_SUBTRACT ? OP_SUB_RR : insn.Pcd == PCD_MULTIPLY ? OP_MUL_RR :
+			insn.Pcd == PCD_DIVIDE ? OP_DIV_RR : insn.Pcd == PCD_MODULUS ? OP_MOD_RR : insn.Pcd == PCD_ANDBITWISE ? OP_AND_RR :
+			insn.Pcd == PCD_ORBITWISE ? OP_OR_RR : insn.Pcd == PCD_EORBITWISE ? OP_XOR_RR : insn.Pcd == PCD_LSHIFT ? OP_SLL_RR : OP_SRA_RR;
+
+		Load(T0, d - 2);
+		Load(T1, d - 1);
+		if (op == OP_DIV_RR || op == OP_MOD_RR)
+		{
+			// Let the interpreter report the error and end the script.
+			Build.Emit(OP_EQ_K, 1, T1, Build.GetConstantInt(0));
+			EmitJump(AddExit(insn.Ofs, d, insn.Remaining), 0);
+		}
+		Build.Emit(op, T0, T0, T1);
+		Store(T0, d - 2);
+		break;
+	}
+
+	case PCD_EQ:
+	case PCD_NE:
+	case PCD_LT:
+	case PCD_GT:
+	case PCD_LE:
+	case PCD_GE:
+	{
+		// Same as FxCompareRel: the check value selects when the JMP skips setting the result to 1.
+		int op = insn.Pcd == PCD_EQ || insn.Pcd == PCD_NE ? OP_EQ_R : insn.Pcd == PCD_LT || insn.Pcd == PCD_GE ? OP_LT_RR : OP_LE_RR;
+		int check = insn.Pcd == PCD_NE || insn.Pcd == PCD_GT || insn.Pcd == PCD_GE;
+
+		Load(T0, d - 2);
+		Load(T1, d - 1);
+		Build.Emit(OP_LI, T2, 0);
+		Build.Emit(op, check, T0, T1);
+		Build.Emit(OP_JMP, 1);
+		Build.Emit(OP_LI, T2, 1);
+		Store(T2, d - 2);
+		break;
+	}
+
+	case PCD_ANDLOGICAL:
+		Load(T0, d - 2);
+		Load(T1, d - 1);
+		Build.Emit(OP_LI, T2, 0);
+		Build.Emit(OP_EQ_K, 1, T0, Build.GetConstantInt(0));
+		Build.Emit(OP_JMP, 3);
+		Build.Emit(OP_EQ_K, 1, T1, Build.GetConstantInt(0));
+		Build.Emit(OP_JMP, 1);
+		Build.Emit(OP_LI, T2, 1);
+		Store(T2, d - 2);
+		break;
+
+	case PCD_ORLOGICAL:
+		Load(T0, d - 2);
+		Load(T1, d - 1);
+		Build.Emit(OP_OR_RR, T0, T0, T1);
+		Build.Emit(OP_LI, T2, 0);
+		Build.Emit(OP_EQ_K, 1, T0, Build.GetConstantInt(0));
+		Build.Emit(OP_JMP, 1);
+		Build.Emit(OP_LI, T2, 1);
+		Store(T2, d - 2);
+		break;
+
+	case PCD_NEGATELOGICAL:
+		Load(T0, d - 1);
+		Build.Emit(OP_LI, T2, 0);
+		Build.Emit(OP_EQ_K, 0, T0, Build.GetConstantInt(0));
+		Build.Emit(OP_JMP, 1);
+		Build.Emit(OP_LI, T2, 1);
+		Store(T2, d - 1);
+		break;
+
+	case PCD_NEGATEBINARY:
+	case PCD_UNARYMINUS:
+		Load(T0, d - 1);
+		Build.Emit(insn.Pcd == PCD_UNARYMINUS ? OP_NEG : OP_NOT, T0, T0);
+		Store(T0, d - 1);
+		break;
+
+	case PCD_PUSHSCRIPTVAR:
+		Variable(insn, areg, konst);
+		Build.Emit(OP_LW, T0, areg, konst);
+		Store(T0, d);
+		break;
+
+	case PCD_ASSIGNSCRIPTVAR:
+		Variable(insn, areg, konst);
+		Load(T0, d - 1);
+		Build.Emit(OP_SW, areg, T0, konst);
+		break;
+
+	case PCD_ADDSCRIPTVAR:
+	case PCD_SUBSCRIPTVAR:
+		Variable(insn, areg, konst);
+		Build.Emit(OP_LW, T0, areg, konst);
+		Load(T1, d - 1);
+		Build.Emit(insn.Pcd == PCD_ADDSCRIPTVAR ? OP_ADD_RR : OP_SUB_RR, T0, T0, T1);
+		Build.Emit(OP_SW, areg, T0, konst);
+		break;
+
+	case PCD_INCSCRIPTVAR:
+	case PCD_DECSCRIPTVAR:
+		Variable(insn, areg, konst);
+		Build.Emit(OP_LW, T0, areg, konst);
+		Build.Emit(OP_ADDI, T0, T0, uint8_t(insn.Pcd == PCD_INCSCRIPTVAR ? 1 : -1));
+		Build.Emit(OP_SW, areg, T0, konst);
+		break;
+
+	case PCD_IFGOTO:
+	case PCD_IFNOTGOTO:
+		Load(T0, d - 1);
+		Build.Emit(OP_EQ_K, insn.Pcd == PCD_IFNOTGOTO, T0, Build.GetConstantInt(0));
+		break;
+
+	case PCD_CASEGOTO:
+		Load(T0, d - 1);
+		Build.Emit(OP_EQ_K, 1, T0, Build.GetConstantInt(insn.Arg));
+		break;
+	}
+
+	if (insn.Branches)
+	{
+		EmitJump(insn.TargetExit, insn.Target);
+	}
+}
+
+//==========================================================================
+//
+// FACSTranslator :: Compile
+//
+// The function takes the stack at the entry's stack pointer, the local
+// variables, the module's map variables and the number of instructions the
+// script may still run, and returns the exit it left through along with the
+// number of instructions it ran.
+//
+//==========================================================================
+
+void FACSTranslator::Compile(uint32_t start, FACSBlock &block)
+{
+	static const uint8_t RegTypes[] = { REGT_POINTER, REGT_POINTER, REGT_POINTER, REGT_INT };
+
+	Discover(start);
+	if (Code.Size() == 0)
+	{
+		return;
+	}
+	Block = &block;
+
+	// The arguments come first.
+	StackReg = Build.Registers[REGT_POINTER].Get(1);
+	LocalReg = Build.Registers[REGT_POINTER].Get(1);
+	MapReg = Build.Registers[REGT_POINTER].Get(1);
+	BudgetReg = Build.Registers[REGT_INT].Get(1);
+	WorldReg = Build.Registers[REGT_POINTER].Get(1);
+	GlobalReg = Build.Registers[REGT_POINTER].Get(1);
+	VarReg = Build.Registers[REGT_POINTER].Get(1);
+	CountReg = Build.Registers[REGT_INT].Get(1);
+	T0 = Build.Registers[REGT_INT].Get(1);
+	T1 = Build.Registers[REGT_INT].Get(1);
+	T2 = Build.Registers[REGT_INT].Get(1);
+
+	Build.EmitLoadInt(CountReg, 0);
+	Build.Emit(OP_LKP, WorldReg, Build.GetConstantAddress(ACS_WorldVars.Pointer()));
+	Build.Emit(OP_LKP, GlobalReg, Build.GetConstantAddress(ACS_GlobalVars.Pointer()));
+	if (Code[0].Ofs != start)
+	{
+		EmitJump(-1, start);
+	}
+
+	TArray<size_t> labels(Code.Size(), true);
+	for (unsigned i = 0; i < Code.Size(); i++)
+	{
+		const Insn &insn = Code[i];
+
+		labels[i] = Build.GetAddress();
+		if (insn.Leader)
+		{
+			// Count the whole basic block up front. If that would exceed the budget,
+			// the interpreter takes over here and terminates the script at the right instruction.
+			Build.Emit(OP_ADD_RK, CountReg, CountReg, Build.GetConstantInt(insn.Remaining));
+			Build.Emit(OP_LT_RR, 1, BudgetReg, CountReg);
+			EmitJump(AddExit(insn.Ofs, insn.Depth, insn.Remaining), 0);
+		}
+		EmitInsn(insn);
+		if (insn.Falls)
+		{
+			if (insn.FallExit >= 0) EmitJump(insn.FallExit, 0);
+			else if (i + 1 == Code.Size() || Code[i + 1].Ofs != insn.Next) EmitJump(-1, insn.Next);
+		}
+	}
+
+	TArray<size_t> stubs(Exits.Size(), true);
+	for (unsigned i = 0; i < Exits.Size(); i++)
+	{
+		stubs[i] = Build.GetAddress();
+		if (Exits[i].Unexecuted > 0)
+		{
+			Build.Emit(OP_SUB_RK, CountReg, CountReg, Build.GetConstantInt(Exits[i].Unexecuted));
+		}
+		Build.EmitRetInt(0, false, i);
+		Build.Emit(OP_RET, RET_FINAL | 1, REGT_INT, CountReg);
+		block.Exits.Push(Exits[i].Where);
+	}
+	for (auto &jump : Jumps) Build.Backpatch(jump.first, labels[jump.second]);
+	for (auto &jump : ExitJumps) Build.Backpatch(jump.first, stubs[jump.second]);
+
+	TArray<PType *> rets, args;
+	rets.Push(TypeSInt32);
+	rets.Push(TypeSInt32);
+	args.Push(TypeVoidPtr);
+	args.Push(TypeVoidPtr);
+	args.Push(TypeVoidPtr);
+	args.Push(TypeSInt32);
+
+	auto func = new VMScriptFunction;
+	Build.MakeFunction(func);
+	func->Proto = NewPrototype(rets, args);
+	func->RegTypes = RegTypes;
+	func->NumArgs = countof(RegTypes);
+	func->QualifiedName = func->PrintableName = ClassDataAllocator.Strdup(FStringf("ACS block %s+%u", Module->GetModuleName(), start).GetChars());
+	block.Func = func;
+}
+
+//==========================================================================
+//
+// FBehavior :: GetCompiledBlock
+//
+// Returns the block starting at pc, compiling it the first time it is
+// asked for, or nullptr if the instruction there cannot be compiled.
+//
+//==========================================================================
+
+const FACSBlock *FBehavior::GetCompiledBlock(int *pc)
+{
+	if (CompiledID < 0)
+	{
+		uint8_t digest[16];
+		MD5Context md5;
+		md5.Update(Data, DataSize);
+		md5.Final(digest);
+
+		FString key;
+		for (auto c : digest) key.AppendFormat("%02x", c);
+		if (auto id = ACSModuleIDs.CheckKey(key))
+		{
+			CompiledID = *id;
+		}
+		else
+		{
+			CompiledID = ACSModuleIDs.CountUsed();
+			ACSModuleIDs[key] = CompiledID;
+		}
+	}
+
+	uint32_t ofs = PC2Ofs(pc);
+	uint64_t key = (uint64_t(CompiledID) << 32) | ofs;
+	FACSBlock *block = ACSBlocks.CheckKey(key);
+	if (block == nullptr)
+	{
+		block = &ACSBlocks[key];
+		FACSTranslator(this).Compile(ofs, *block);
+	}
+	return block->Func != nullptr ? block : nullptr;
+}
+
+//==========================================================================
+//
+// FBehavior :: CompileScripts
+//
+// Compiles the blocks the scripts start with when the module is loaded.
+// Any others are compiled when execution first gets there.
+//
+//==========================================================================
+
+void FBehavior::CompileScripts()
+{
+	for (int i = 0; i < NumScripts; i++)
+	{
+		GetCompiledBlock(GetScriptAddress(&Scripts[i]));
+	}
+}
+
+void P_ClearCompiledACS()
+{
+	// The VM functions are deleted along with all others.
+	ACSBlocks.Clear();
+}
+
+//==========================================================================
+//
+// RunCompiledACS
+//
+// Runs the compiled block at pc, if there is one and it fits the current
+// stack and local variables. Afterwards pc points to the instruction the
+// interpreter needs to run next.
+//
+//==========================================================================
+
+static void RunCompiledACS(FBehavior *module, int *&pc, FACSStackMemory &Stack, int &sp, ACSLocalVariables &locals, unsigned &runaway)
+{
+	const FACSBlock *block = module->GetCompiledBlock(pc);
+
+	if (block == nullptr || runaway >= RUNAWAY_LIMIT ||
+		sp + block->MinDepth < 0 || sp + block->MaxDepth > STACK_SIZE || locals.GetCount() < block->NumLocals)
+	{
+		return;
+	}
+
+	VMValue params[] = { Stack.Pointer() + sp, locals.GetPointer(), module->MapVars.Pointer(), int(RUNAWAY_LIMIT - runaway) };
+	int exit = 0, count = 0;
+	VMReturn rets[] = { &exit, &count };
+	VMCall(block->Func, params, countof(params), rets, countof(rets));
+
+	pc = module->Ofs2PC(block->Exits[exit].Offset);
+	sp += block->Exits[exit].Depth;
+	runaway += count;
+	ACSCompiledInstructions += count;
+}
+
 int DLevelScript::RunScript()
 {
+	FACSRunClock runclock;
 	DACSThinker *controller = Level->ACSThinker;
 	ACSLocalVariables locals(Localvars);
 	ACSLocalArrays noarrays;
@@ -6956,6 +7804,7 @@ int DLevelScript::RunScript()
 	ACSFormat fmt = activeBehavior->GetFormat();
 	FBehavior* const savedActiveBehavior = activeBehavior;
 	unsigned int runaway = 0;	// used to prevent infinite loops
+	const bool compiled = acs_compile;
 	int pcd;
 	FString work;
 	const char *lookup;
@@ -6964,7 +7813,13 @@ int DLevelScript::RunScript()
 
 	while (state == SCRIPT_Running)
 	{
-		if (++runaway > 2000000)
+		if (compiled)
+		{
+			// Stops in front of the next instruction only the interpreter can run.
+			RunCompiledACS(activeBehavior, pc, Stack, sp, locals, runaway);
+		}
+
+		if (++runaway > RUNAWAY_LIMIT)
 		{
 			Printf ("Runaway %s terminated\n", ScriptPresentation(script).GetChars());
 			state = SCRIPT_PleaseRemove;
@@ -8445,6 +9300,7 @@ scriptwait:
 			if (activationline != NULL)
 			{
 				activationline->special = 0;
+				P_InvalidateSightCache();
 				DPrintf(DMSG_SPAMMY, "Cleared line special on line %d\n", activationline->Index());
 			}
 			break;
@@ -9024,6 +9880,7 @@ scriptwait:
 			{
 				int lineno;
 
+				P_InvalidateSightCache();
 				auto itr = Level->GetLineIdIterator(STACK(2));
 				while ((lineno = itr.Next()) >= 0)
 				{
@@ -9087,6 +9944,7 @@ scriptwait:
 					arg0 = -FName(Level->Behaviors.LookupString(arg0)).GetIndex();
 				}
 
+				P_InvalidateSightCache();
 				auto itr = Level->GetLineIdIterator(STACK(7));
 				while ((linenum = itr.Next()) >= 0)
 				{
@@ -10310,6 +11168,9 @@ scriptwait:
  		}
  	}
 
+	ACSInstructions += runaway;
+	ACSScriptRuns++;
+
 	if (runaway != 0 && InModuleScriptNumber >= 0)
 	{
 		auto scriptptr = activeBehavior->GetScriptPtr(InModuleScriptNumber);
@@ -10891,7 +11752,74 @@ CCMD(acsprofile)
 	}
 }
 
+//==========================================================================
+//
+// CCMD acsbenchmark
+//
+// Runs a script many times with the interpreter alone and then with the
+// compiled blocks, and compares the times. The script really is run every
+// time, so this is meant for test maps whose scripts only compute.
+//
+//==========================================================================
+
+CCMD(acsbenchmark)
+{
+	if (argv.argc() < 2)
+	{
+		Printf("Usage: acsbenchmark <script> [runs]\n");
+		return;
+	}
+	if (gamestate != GS_LEVEL || netgame)
+	{
+		Printf("acsbenchmark can only be used in a single player level\n");
+		return;
+	}
+
+	// Named scripts work like in pukename.
+	char *end;
+	int script = (int)strtol(argv[1], &end, 10);
+	if (*end != 0) script = -FName(argv[1]).GetIndex();
+	int runs = argv.argc() > 2 ? max(1, atoi(argv[2])) : 1000;
+
+	FBehavior *module;
+	if (primaryLevel->Behaviors.FindScript(script, module) == nullptr)
+	{
+		Printf("%s not found\n", ScriptPresentation(script).GetChars());
+		return;
+	}
+
+	const bool oldcompile = acs_compile;
+	cycle_t time[2];
+	unsigned instructions = 0, compiled = 0;
+
+	for (int mode = 0; mode < 2; mode++)
+	{
+		acs_compile = mode == 1;
+		// The first run does the compiling, so it is not timed.
+		P_StartScript(primaryLevel, players[consoleplayer].mo, nullptr, script, nullptr, nullptr, 0, ACS_ALWAYS | ACS_WANTRESULT);
+
+		unsigned startinstr = ACSInstructions, startcompiled = ACSCompiledInstructions;
+		time[mode].Reset();
+		time[mode].Clock();
+		for (int i = 0; i < runs; i++)
+		{
+			P_StartScript(primaryLevel, players[consoleplayer].mo, nullptr, script, nullptr, nullptr, 0, ACS_ALWAYS | ACS_WANTRESULT);
+		}
+		time[mode].Unclock();
+		instructions = ACSInstructions - startinstr;
+		compiled = ACSCompiledInstructions - startcompiled;
+	}
+	acs_compile = oldcompile;
+
+	double interpreted = time[0].TimeMS(), native = time[1].TimeMS();
+	Printf("%s, %d runs of %u instructions, %.1f%% compiled\n", ScriptPresentation(script).GetChars(), runs,
+		instructions / runs, instructions > 0 ? compiled * 100. / instructions : 0.);
+	Printf("interpreter: %.3f ms, compiled: %.3f ms, speedup %.2fx\n", interpreted, native, native > 0 ? interpreted / native : 0.);
+}
+
 ADD_STAT(ACS)
 {
-	return FStringf("ACS time: %f ms", ACSTime.TimeMS());
+	double ms = ACSRunTime.TimeMS();
+	return FStringf("ACS time: %f ms, %u runs in %f ms, %u instructions (%u compiled), %.1f ns/instruction", ACSTime.TimeMS(), ACSScriptRuns, ms,
+		ACSInstructions, ACSCompiledInstructions, ACSInstructions > 0 ? ms * 1e6 / ACSInstructions : 0.);
 }
@@ -147,6 +147,7 @@ void P_CollectACSGlobalStrings();
 void P_ReadACSVars(FSerializer &);
 void P_WriteACSVars(FSerializer &);
 void P_ClearACSVars(bool);
+void P_ClearCompiledACS();
 
 struct ACSProfileInfo
 {
@@ -200,6 +201,16 @@ public:
 		return memory;
 	}
 
+	int32_t *GetPointer()
+	{
+		return memory;
+	}
+
+	size_t GetCount() const
+	{
+		return count;
+	}
+
 private:
 	int32_t *memory;
 	size_t count;
@@ -344,6 +355,7 @@ enum
 
 enum ACSFormat { ACS_Old, ACS_Enhanced, ACS_LittleEnhanced, ACS_Unknown };
 
+struct FACSBlock;
 
 class FBehavior
 {
@@ -379,6 +391,8 @@ public:
 	ACSProfileInfo *GetFunctionProfileData(int index) { return index >= 0 && index < NumFunctions ? &FunctionProfileData[index] : NULL; }
 	ACSProfileInfo *GetFunctionProfileData(ScriptFunction *func) { return GetFunctionProfileData((int)(func - (ScriptFunction *)Functions)); }
 	const char *LookupString (uint32_t index, bool forprint = false) const;
+	const FACSBlock *GetCompiledBlock (int *pc);
+	void CompileScripts ();
 
 	BoundsCheckingArray<int32_t *, NUM_MAPVARS> MapVars;
 
@@ -402,6 +416,7 @@ private:
 	int NumFunctions;
 	int NumArrays;
 	int NumTotalArrays;
+	int CompiledID;
 	uint32_t StringTable;
 	uint32_t LibraryID;
 	bool ShouldLocalize;
@@ -184,7 +184,7 @@ void P_InitParticles (FLevelLocals *Level)
 		num = r_maxparticles;
 
 	// This should be good, but eh...
-	int NumParticles = clamp<int>(num, 100, 65535);
+	int NumParticles = clamp<int>(num, 100, MAX_PARTICLES);
 
 	Level->Particles.Resize(NumParticles);
 	P_ClearParticles (Level);
@@ -234,13 +234,13 @@ void P_FindParticleSubsectors (FLevelLocals *Level)
 		Level->ParticlesInSubsec.Reserve (Level->subsectors.Size() - Level->ParticlesInSubsec.Size());
 	}
 
-	fillshort (&Level->ParticlesInSubsec[0], Level->subsectors.Size(), NO_PARTICLE);
+	std::fill_n(Level->ParticlesInSubsec.Data(), Level->subsectors.Size(), NO_PARTICLE);
 
 	if (!r_particles)
 	{
 		return;
 	}
-	for (uint16_t i = Level->ActiveParticles; i != NO_PARTICLE; i = Level->Particles[i].tnext)
+	for (uint32_t i = Level->ActiveParticles; i != NO_PARTICLE; i = Level->Particles[i].tnext)
 	{
 		 // Try to reuse the subsector from the last portal check, if still valid.
 		if (Level->Particles[i].subsector == nullptr) Level->Particles[i].subsector = Level->PointInRenderSubsector(Level->Particles[i].Pos);
@@ -289,7 +289,7 @@ void P_InitEffects ()
 
 void P_ThinkParticles (FLevelLocals *Level)
 {
-	int i = Level->ActiveParticles;
+	uint32_t i = Level->ActiveParticles;
 	particle_t *particle = nullptr, *prev = nullptr;
 	while (i != NO_PARTICLE)
 	{
@@ -322,7 +322,7 @@ void P_ThinkParticles (FLevelLocals *Level)
 				next->tprev = particle->tprev;
 			}
 			particle->tnext = Level->InactiveParticles;
-			Level->InactiveParticles = (int)(particle - Level->Particles.Data());
+			Level->InactiveParticles = uint32_t(particle - Level->Particles.Data());
 			continue;
 		}
 
@@ -1253,6 +1253,7 @@ void DVisualThinker::Serialize(FSerializer& arc)
 {
 	Super::Serialize(arc);
 
+	int style = PT.style;	// bit field, cannot be serialized directly.
 	arc
 		("pos", PT.Pos)
 		("vel", PT.Vel)
@@ -1263,7 +1264,7 @@ void DVisualThinker::Serialize(FSerializer& arc)
 		("offset", Offset)
 		("alpha", PT.alpha)
 		("texture", PT.texture)
-		("style", *reinterpret_cast<int*>(&PT.style))
+		("style", style)
 		("translation", Translation)
 		("cursector", cursector)
 		("scolor", PT.color)
@@ -1275,7 +1276,7 @@ void DVisualThinker::Serialize(FSerializer& arc)
 		("flipoffsetY", bFlipOffsetY)
 		("lightlevel", LightLevel)
 		("flags", PT.flags);
-		
+	PT.style = ERenderStyle(style);
 }
 
 IMPLEMENT_CLASS(DVisualThinker, false, false);
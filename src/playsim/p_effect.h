@@ -79,17 +79,17 @@ struct particle_t
     int32_t    ttl; // +4 = 76
     int        color; //+4 = 80
     FTextureID texture; // +4 = 84
-    ERenderStyle style; //+4 = 88
+    ERenderStyle style : 16; //+2 = 86
+	uint16_t flags; //+2 = 88
     float Roll, RollVel, RollAcc; //+12 = 100
-    uint16_t    tnext, snext, tprev; //+6 = 106
-	uint16_t flags; //+2 = 108
-	// uint32_t padding; //+4 = 112
+    uint32_t    tnext, snext, tprev; //+12 = 112
 	FStandaloneAnimation animData; //+16 = 128
 };
 
 static_assert(sizeof(particle_t) == 128);
 
-const uint16_t NO_PARTICLE = 0xffff;
+const uint32_t NO_PARTICLE = 0xffffffff;
+const int MAX_PARTICLES = 0x400000;	// must stay well below NO_PARTICLE
 
 void P_InitParticles(FLevelLocals *);
 void P_ClearParticles (FLevelLocals *Level);
@@ -3996,6 +3996,8 @@ int P_ExecuteSpecial(FLevelLocals *Level, int			num,
 {
 	if (num >= 0 && num < (int)countof(LineSpecials))
 	{
+		// Specials can change line flags and 3D floors without moving any planes.
+		P_InvalidateSightCache();
 		return LineSpecials[num](Level, line, activator, backSide, arg1, arg2, arg3, arg4, arg5);
 	}
 	return 0;
@@ -271,6 +271,8 @@ bool	P_BounceWall (AActor *mo);
 bool	P_BounceActor (AActor *mo, AActor *BlockingMobj, bool ontop);
 bool    P_ReflectOffActor(AActor* mo, AActor* blocking);
 int	P_CheckSight (AActor *t1, AActor *t2, int flags=0);
+void	P_CheckSightBatch (AActor *target, const TArray<AActor *> &lookers, int flags, TArray<bool> &results);
+void	P_InvalidateSightCache ();
 
 enum ESightFlags
 {
@@ -6106,7 +6106,6 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bom
 
 	FPortalGroupArray grouplist(FPortalGroupArray::PGA_Full3d);
 	FMultiBlockThingsIterator it(grouplist, bombspot->Level, bombspot->X(), bombspot->Y(), bombspot->Z() - bombdistance, bombspot->Height + bombdistance*2, bombdistance, false, bombspot->Sector);
-	FMultiBlockThingsIterator::CheckResult cres;
 
 	if (flags & RADF_SOURCEISSPOT)
 	{ // The source is actually the same as the spot, even if that wasn't what we received.
@@ -6115,9 +6114,12 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bom
 
 	P_GeometryRadiusAttack(bombspot, bombsource, bombdamage, bombdistance, bombmod, fulldamagedistance);
 
+	TArray<FMultiBlockThingsIterator::CheckResult> candidates;
+	it.Collect(candidates);
+
 	TArray<AActor*> targets;
 	int count = 0;
-	while ((it.Next(&cres)))
+	for (auto &cres : candidates)
 	{
 		AActor *thing = cres.thing;
 		// Vulnerable actors can be damaged by radius attacks even if not shootable
@@ -6361,8 +6363,9 @@ void P_FindAboveIntersectors(AActor *actor)
 
 	FPortalGroupArray check;
 	FMultiBlockThingsIterator it(check, actor);
-	FMultiBlockThingsIterator::CheckResult cres;
-	while (it.Next(&cres))
+	static TArray<FMultiBlockThingsIterator::CheckResult> candidates;	// the loop below cannot recurse into here
+	it.Collect(candidates);
+	for (auto &cres : candidates)
 	{
 		AActor *thing = cres.thing;
 		double blockdist = actor->radius + thing->radius;
@@ -6417,8 +6420,9 @@ void P_FindBelowIntersectors(AActor *actor)
 
 	FPortalGroupArray check;
 	FMultiBlockThingsIterator it(check, actor);
-	FMultiBlockThingsIterator::CheckResult cres;
-	while (it.Next(&cres))
+	static TArray<FMultiBlockThingsIterator::CheckResult> candidates;	// the loop below cannot recurse into here
+	it.Collect(candidates);
+	for (auto &cres : candidates)
 	{
 		AActor *thing = cres.thing;
 		double blockdist = actor->radius + thing->radius;
@@ -6887,6 +6891,8 @@ bool P_ChangeSector(sector_t *sector, int crunch, double amt, int floorOrCeil, b
 	void(*iterator2)(AActor *, FChangePosition *) = NULL;
 	msecnode_t *n;
 
+	P_InvalidateSightCache();
+
 	cpos.nofit = false;
 	cpos.crushchange = crunch;
 	cpos.moveamt = fabs(amt);
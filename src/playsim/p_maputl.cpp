@@ -1127,6 +1127,64 @@ bool FMultiBlockThingsIterator::Next(FMultiBlockThingsIterator::CheckResult *ite
 	return Next(item);
 }
 
+//===========================================================================
+//
+// Returns everything Next() would return, in the same order, in one pass.
+//
+// Since no other code can run while the blocks are walked, actors spanning
+// multiple blocks can be filtered by stamping them with the pass number
+// instead of going through the iterator's hash table. This is only safe
+// for callers that do not move, spawn or destroy actors while they are
+// still going through the results.
+//
+//===========================================================================
+
+void FMultiBlockThingsIterator::Collect(TArray<CheckResult> &results)
+{
+	static uint64_t QueryStamp;
+	const uint64_t stamp = ++QueryStamp;
+	auto Level = blockIterator.Level;
+	auto &blockmap = Level->blockmap;
+
+	results.Clear();
+	Reset();
+	for (;;)
+	{
+		auto &bi = blockIterator;
+		for (int y = bi.miny; y <= bi.maxy; y++)
+		{
+			for (int x = bi.minx; x <= bi.maxx; x++)
+			{
+				if (!blockmap.isValidBlock(x, y)) continue;
+
+				for (FBlockNode *block = blockmap.blocklinks[y*blockmap.bmapwidth + x]; block != nullptr; block = block->NextActor)
+				{
+					AActor *me = block->Me;
+					// Actors in a single block are never filtered, just like in FBlockThingsIterator::Next.
+					if (block->NextBlock != nullptr || block->PrevBlock != &me->BlockNode)
+					{
+						if (me->BlockQueryStamp == stamp) continue;
+						me->BlockQueryStamp = stamp;
+					}
+					auto &item = results[results.Reserve(1)];
+					item.thing = me;
+					item.Position = checkpoint + Level->Displacements.getOffset(basegroup, me->Sector->PortalGroup);
+					item.portalflags = portalflags;
+				}
+			}
+		}
+
+		if (unsigned(index + 1) >= checklist.Size())
+		{
+			break;
+		}
+		int nextflags = checklist[index + 1] & FPortalGroupArray::FLAT;
+		index++;
+		startIteratorForGroup(checklist[index] & ~FPortalGroupArray::FLAT);
+		portalflags = nextflags == FPortalGroupArray::UPPER ? FFCF_NOFLOOR : nextflags == FPortalGroupArray::LOWER ? FFCF_NOCEILING : 0;
+	}
+}
+
 //===========================================================================
 //
 // start iterating a new group
@@ -355,6 +355,7 @@ public:
 	FMultiBlockThingsIterator(FPortalGroupArray &check, AActor *origin, double checkradius = -1, bool ignorerestricted = false);
 	FMultiBlockThingsIterator(FPortalGroupArray &check, FLevelLocals *Level, double checkx, double checky, double checkz, double checkh, double checkradius, bool ignorerestricted, sector_t *newsec);
 	bool Next(CheckResult *item);
+	void Collect(TArray<CheckResult> &results);
 	void Reset();
 	const FBoundingBox &Box() const
 	{
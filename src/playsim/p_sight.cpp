@@ -40,6 +40,8 @@
 static FRandom pr_botchecksight ("BotCheckSight");
 static FRandom pr_checksight ("CheckSight");
 
+CVAR(Bool, sv_sightcache, false, CVAR_ARCHIVE | CVAR_SERVERINFO)
+
 /*
 ==============================================================================
 
@@ -54,6 +56,8 @@ This uses specialized forms of the maputils routines for optimized performance
 static int sightcounts[6];
 static cycle_t SightCycles;
 static cycle_t MaxSightCycles;
+static int sightcachehits, sightcachemisses;
+static int sightgenrejects;
 
 enum
 {
@@ -838,50 +842,72 @@ sightcounts[2]++;
 =====================
 */
 
-int P_CheckSight (AActor *t1, AActor *t2, int flags)
+//==========================================================================
+//
+// Sight cache
+//
+// Remembers the outcome of the line of sight traversal for an actor pair
+// for the rest of the current tic. An entry is only reused if neither actor
+// has moved or changed size, so monsters asking the same question several
+// times per tic (A_Look, A_Chase, missile and melee range checks) only pay
+// for the first traversal. Anything that changes the geometry the trace
+// looks at must call P_InvalidateSightCache, which drops all entries.
+// Plane movers and line flag changes made by scripts during the tic are
+// not all covered by that yet, which is why the cache is off by default.
+//
+// Entries are never kept for checks that depend on random numbers, so the
+// RNG is called exactly as often as without the cache.
+//
+//==========================================================================
+
+struct FSightCacheEntry
 {
-	SightCycles.Clock();
+	FLevelLocals *Level;
+	AActor *t1, *t2;
+	DVector3 pos1, pos2;
+	double height1, height2;
+	int flags;
+	int maptime;
+	unsigned generation;
+	bool result;
+};
 
-	bool res;
+enum { SIGHTCACHE_SIZE = 4096 };	// must be a power of 2
 
-	if (t1 == nullptr || t2 == nullptr)
-	{
-		return false;
-	}
+static FSightCacheEntry SightCache[SIGHTCACHE_SIZE];
+static unsigned SightCacheGeneration = 1;
 
-	if ((t2->flags8 & MF8_MVISBLOCKED) && !(flags & SF_IGNOREVISIBILITY))
-	{
-		return false;
-	}
+void P_InvalidateSightCache()
+{
+	SightCacheGeneration++;
+}
 
-	auto s1 = t1->Sector;
-	auto s2 = t2->Sector;
-	//
-	// check for trivial rejection
-	//
-	if (!t1->Level->CheckReject(s1, s2))
-	{
-sightcounts[0]++;
-		res = false;			// can't possibly be connected
-		goto done;
-	}
+static FSightCacheEntry &SightCacheSlot(AActor *t1, AActor *t2, int flags)
+{
+	uint64_t hash = (uint64_t)(uintptr_t)t1 * 0x9E3779B97F4A7C15ull ^ (uint64_t)(uintptr_t)t2 * 0xC2B2AE3D27D4EB4Full ^ (uint64_t)flags;
+	return SightCache[(hash >> 32) & (SIGHTCACHE_SIZE - 1)];
+}
 
+static bool SightCacheMatches(const FSightCacheEntry &entry, AActor *t1, AActor *t2, int flags)
+{
+	return entry.generation == SightCacheGeneration && entry.t1 == t1 && entry.t2 == t2 && entry.flags == flags &&
+		entry.Level == t1->Level && entry.maptime == t1->Level->maptime &&
+		entry.pos1 == t1->Pos() && entry.pos2 == t2->Pos() && entry.height1 == t1->Height && entry.height2 == t2->Height;
+}
+
+//==========================================================================
 //
-// check precisely
+// SightCheckGeometry
 //
-	// [RH] Andy Baker's stealth monsters:
-	// Cannot see an invisible object
-	if ((flags & SF_IGNOREVISIBILITY) == 0 &&
-		((t2->renderflags & RF_INVISIBLE) ||
-		(t2->flags8 & MF8_MINVISIBLE) ||
-		!t2->RenderStyle.IsVisible(t2->Alpha)))
-	{ // small chance of an attack being made anyway
-		if ((t1->Level->BotInfo.m_Thinking ? pr_botchecksight() : pr_checksight()) > 50)
-		{
-			res = false;
-			goto done;
-		}
-	}
+// The part of P_CheckSight that only depends on the level geometry and the
+// positions of both actors.
+//
+//==========================================================================
+
+static bool SightCheckGeometry(AActor *t1, AActor *t2, int flags)
+{
+	auto s1 = t1->Sector;
+	auto s2 = t2->Sector;
 
 	// killough 4/19/98: make fake floors and ceilings block monster view
 
@@ -899,14 +925,14 @@ sightcounts[0]++;
 			  (t2->Z() >= s2->heightsec->ceilingplane.ZatPoint(t2) &&
 			   t1->Top() <= s2->heightsec->ceilingplane.ZatPoint(t1)))))
 		{
-			res = false;
-			goto done;
+			return false;
 		}
 	}
 
 	// An unobstructed LOS is possible.
 	// Now look from eyes of t1 to any part of t2.
 
+	bool res;
 	validcount++;
 	portals.Clear();
 	{
@@ -937,18 +963,148 @@ sightcounts[0]++;
 			}
 		}
 	}
+	return res;
+}
+
+// [RH] Andy Baker's stealth monsters: cannot see an invisible object
+static bool SightTargetVisible(AActor *t2, int flags)
+{
+	return (flags & SF_IGNOREVISIBILITY) ||
+		!((t2->renderflags & RF_INVISIBLE) ||
+		(t2->flags8 & MF8_MINVISIBLE) ||
+		!t2->RenderStyle.IsVisible(t2->Alpha));
+}
+
+//==========================================================================
+//
+// CheckSightInternal
+//
+// P_CheckSight without the timing, shared with P_CheckSightBatch.
+// t2visible is the part of the stealth check that only depends on t2.
+//
+//==========================================================================
+
+static bool CheckSightInternal(AActor *t1, AActor *t2, int flags, bool t2visible)
+{
+	//
+	// check for trivial rejection
+	//
+	// A generated REJECT is only checked after the random check below,
+	// so that it does not change how often the RNG gets called.
+	if (!t1->Level->rejectgenerated && !t1->Level->CheckReject(t1->Sector, t2->Sector))
+	{
+sightcounts[0]++;
+		return false;			// can't possibly be connected
+	}
+
+//
+// check precisely
+//
+	// [RH] Andy Baker's stealth monsters:
+	// Cannot see an invisible object
+	if (!t2visible)
+	{ // small chance of an attack being made anyway
+		if ((t1->Level->BotInfo.m_Thinking ? pr_botchecksight() : pr_checksight()) > 50)
+		{
+			return false;
+		}
+	}
+
+	if (t1->Level->rejectgenerated && !t1->Level->CheckReject(t1->Sector, t2->Sector))
+	{
+sightcounts[0]++;
+sightgenrejects++;
+		return false;
+	}
+
+	if (!sv_sightcache)
+	{
+		return SightCheckGeometry(t1, t2, flags);
+	}
 
-done:
+	auto &entry = SightCacheSlot(t1, t2, flags);
+	if (SightCacheMatches(entry, t1, t2, flags))
+	{
+		sightcachehits++;
+		return entry.result;
+	}
+	sightcachemisses++;
+
+	bool res = SightCheckGeometry(t1, t2, flags);
+
+	// The traversal itself never runs any code that could change the level,
+	// so the generation cannot have changed since the lookup.
+	entry.Level = t1->Level;
+	entry.t1 = t1;
+	entry.t2 = t2;
+	entry.pos1 = t1->Pos();
+	entry.pos2 = t2->Pos();
+	entry.height1 = t1->Height;
+	entry.height2 = t2->Height;
+	entry.flags = flags;
+	entry.maptime = t1->Level->maptime;
+	entry.generation = SightCacheGeneration;
+	entry.result = res;
+	return res;
+}
+
+int P_CheckSight (AActor *t1, AActor *t2, int flags)
+{
+	if (t1 == nullptr || t2 == nullptr)
+	{
+		return false;
+	}
+
+	if ((t2->flags8 & MF8_MVISBLOCKED) && !(flags & SF_IGNOREVISIBILITY))
+	{
+		return false;
+	}
+
+	SightCycles.Clock();
+	bool res = CheckSightInternal(t1, t2, flags, SightTargetVisible(t2, flags));
 	SightCycles.Unclock();
 	return res;
 }
 
+//==========================================================================
+//
+// P_CheckSightBatch
+//
+// Checks whether each of the lookers can see the target. The results are
+// the same as calling P_CheckSight for each looker in order, including the
+// random number calls for invisible targets. Only the target's blocking and
+// visibility checks and the timing are shared; each looker still does its
+// own reject check and line traversal. The caller must not change the level
+// between collecting the lookers and using the results.
+//
+//==========================================================================
+
+void P_CheckSightBatch(AActor *target, const TArray<AActor *> &lookers, int flags, TArray<bool> &results)
+{
+	results.Resize(lookers.Size());
+
+	if (target == nullptr || ((target->flags8 & MF8_MVISBLOCKED) && !(flags & SF_IGNOREVISIBILITY)))
+	{
+		for (auto &res : results) res = false;
+		return;
+	}
+
+	bool visible = SightTargetVisible(target, flags);
+	SightCycles.Clock();
+	for (unsigned i = 0; i < lookers.Size(); i++)
+	{
+		results[i] = lookers[i] != nullptr && CheckSightInternal(lookers[i], target, flags, visible);
+	}
+	SightCycles.Unclock();
+}
+
 ADD_STAT (sight)
 {
 	FString out;
-	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d\n",
+	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d, cache %d/%d, generated reject %d\n",
 		SightCycles.TimeMS(), MaxSightCycles.TimeMS(),
-		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5]);
+		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5],
+		sightcachehits, sightcachehits + sightcachemisses, sightgenrejects);
 	return out;
 }
 
@@ -957,6 +1113,7 @@ void P_ResetSightCounters (bool full)
 	if (full)
 	{
 		MaxSightCycles.Reset();
+		P_InvalidateSightCache();
 	}
 	if (SightCycles.Time() > MaxSightCycles.Time())
 	{
@@ -964,4 +1121,6 @@ void P_ResetSightCounters (bool full)
 	}
 	SightCycles.Reset();
 	memset (sightcounts, 0, sizeof(sightcounts));
+	sightcachehits = sightcachemisses = 0;
+	sightgenrejects = 0;
 }
@@ -898,6 +898,7 @@ bool FPolyObj::MovePolyobj (const DVector2 &pos, bool force)
 
 void FPolyObj::DoMovePolyobj (const DVector2 &pos)
 {
+	P_InvalidateSightCache();
 	for(unsigned i=0;i < Vertices.Size(); i++)
 	{
 		Vertices[i]->set(Vertices[i]->fX() + pos.X, Vertices[i]->fY() + pos.Y);
@@ -944,6 +945,7 @@ bool FPolyObj::RotatePolyobj (DAngle angle, bool fromsave)
 	an = Angle + angle;
 
 	UnLinkPolyobj();
+	P_InvalidateSightCache();
 
 	for(unsigned i=0;i < Vertices.Size(); i++)
 	{
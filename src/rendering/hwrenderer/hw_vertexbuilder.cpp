@@ -22,11 +22,29 @@
 
 
 
+#include <algorithm>
+#include <future>
 #include "g_levellocals.h"
 #include "hw_vertexbuilder.h"
 #include "flatvertices.h"
 #include "earcut.hpp"
 #include "v_video.h"
+#include "ctpl.h"
+
+// Planes whose height changed get collected during BSP traversal and are written in one go afterward.
+struct FPlaneUpdate
+{
+	sector_t *sector;
+	int plane;
+};
+
+static TArray<FPlaneUpdate> PendingPlaneUpdates;
+
+enum
+{
+	MIN_PARALLEL_UPDATE_VERTICES = 16384,	// below this the threading overhead outweighs the gain.
+	MAX_UPLOAD_GAP = 256,					// ranges closer than this many vertices get uploaded together.
+};
 
 //=============================================================================
 //
@@ -429,8 +447,6 @@ static void UpdatePlaneVertices(FFlatVertexBuffer *fvb, sector_t* sec, int plane
 		if (plane == sector_t::floor && sec->transdoor) vt->z -= 1;
 		mapvt->z = vt->z;
 	}
-	
-	fvb->mVertexBuffer->Upload(startvt * sizeof(FFlatVertex), countvt * sizeof(FFlatVertex));
 }
 
 //==========================================================================
@@ -455,12 +471,12 @@ static void CheckPlanes(FFlatVertexBuffer* fvb, sector_t* sector)
 {
 	if (sector->GetPlaneTexZ(sector_t::ceiling) != sector->vboheight[screen->mVertexData->GetPipelinePos()][sector_t::ceiling])
 	{
-		UpdatePlaneVertices(fvb, sector, sector_t::ceiling);
+		PendingPlaneUpdates.Push({ sector, sector_t::ceiling });
 		sector->vboheight[screen->mVertexData->GetPipelinePos()][sector_t::ceiling] = sector->GetPlaneTexZ(sector_t::ceiling);
 	}
 	if (sector->GetPlaneTexZ(sector_t::floor) != sector->vboheight[screen->mVertexData->GetPipelinePos()][sector_t::floor])
 	{
-		UpdatePlaneVertices(fvb, sector, sector_t::floor);
+		PendingPlaneUpdates.Push({ sector, sector_t::floor });
 		sector->vboheight[screen->mVertexData->GetPipelinePos()][sector_t::floor] = sector->GetPlaneTexZ(sector_t::floor);
 	}
 }
@@ -481,6 +497,69 @@ void CheckUpdate(FFlatVertexBuffer* fvb, sector_t* sector)
 		CheckPlanes(fvb, sector->e->XFloor.ffloors[i]->model);
 }
 
+//==========================================================================
+//
+// Writes all planes queued by CheckUpdate and uploads the changed parts
+// of the buffer. The queue is sorted by buffer position so that planes
+// lying close together end up in a single upload.
+//
+//==========================================================================
+
+void FlushPlaneUpdates(FFlatVertexBuffer* fvb, ctpl::thread_pool* pool)
+{
+	auto &updates = PendingPlaneUpdates;
+	if (updates.Size() == 0) return;
+
+	std::sort(updates.begin(), updates.end(), [](const FPlaneUpdate &a, const FPlaneUpdate &b)
+	{
+		return a.sector->vboindex[a.plane] < b.sector->vboindex[b.plane];
+	});
+
+	unsigned numvertices = 0;
+	for (auto &u : updates) numvertices += u.sector->vbocount[u.plane];
+
+	// Each plane owns its own range of the buffer, so the writes can be split freely.
+	int numchunks = pool != nullptr && numvertices >= MIN_PARALLEL_UPDATE_VERTICES ? min<int>(pool->size() + 1, updates.Size()) : 1;
+	if (numchunks > 1)
+	{
+		auto process = [=](unsigned first, unsigned last)
+		{
+			for (unsigned i = first; i < last; i++) UpdatePlaneVertices(fvb, PendingPlaneUpdates[i].sector, PendingPlaneUpdates[i].plane);
+		};
+		TArray<std::future<void>> futures(numchunks - 1, true);
+		unsigned chunksize = (updates.Size() + numchunks - 1) / numchunks;
+		for (int i = 1; i < numchunks; i++)
+		{
+			unsigned first = min(i * chunksize, updates.Size());
+			unsigned last = min(first + chunksize, updates.Size());
+			futures[i - 1] = pool->push([=](int) { process(first, last); });
+		}
+		process(0, min(chunksize, updates.Size()));
+		for (auto &f : futures) f.wait();
+	}
+	else
+	{
+		for (auto &u : updates) UpdatePlaneVertices(fvb, u.sector, u.plane);
+	}
+
+	int start = updates[0].sector->vboindex[updates[0].plane];
+	int end = start;
+	for (auto &u : updates)
+	{
+		int ustart = u.sector->vboindex[u.plane];
+		int uend = ustart + u.sector->vbocount[u.plane];
+		if (ustart > end + MAX_UPLOAD_GAP)
+		{
+			fvb->mVertexBuffer->Upload(start * sizeof(FFlatVertex), (end - start) * sizeof(FFlatVertex));
+			start = ustart;
+		}
+		end = max(end, uend);
+	}
+	fvb->mVertexBuffer->Upload(start * sizeof(FFlatVertex), (end - start) * sizeof(FFlatVertex));
+
+	updates.Clear();
+}
+
 //==========================================================================
 //
 //
@@ -489,6 +568,7 @@ void CheckUpdate(FFlatVertexBuffer* fvb, sector_t* sector)
 
 void CreateVBO(FFlatVertexBuffer* fvb, TArray<sector_t>& sectors)
 {
+	PendingPlaneUpdates.Clear();
 	fvb->vbo_shadowdata.Resize(fvb->mNumReserved);
 	CreateVertices(fvb, sectors);
 	fvb->mCurIndex = fvb->mIndex = fvb->vbo_shadowdata.Size();
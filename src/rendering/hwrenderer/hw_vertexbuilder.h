@@ -68,6 +68,8 @@ using VertexContainers = TArray<VertexContainer>;
 VertexContainers BuildVertices(TArray<sector_t> &sectors);
 
 class FFlatVertexBuffer;
+namespace ctpl { class thread_pool; }
 void CheckUpdate(FFlatVertexBuffer* fvb, sector_t* sector);
+void FlushPlaneUpdates(FFlatVertexBuffer* fvb, ctpl::thread_pool* pool);
 void CreateVBO(FFlatVertexBuffer* fvb, TArray<sector_t>& sectors);
 
@@ -49,13 +49,20 @@
 #endif // ARCH_IA32
 
 CVAR(Bool, gl_multithread, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVAR(Int, gl_multithread_workers, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// 0 picks a count from the number of cores
 
 EXTERN_CVAR(Float, r_actorspriteshadowdist)
+EXTERN_CVAR(Bool, gl_seamless)
 
 thread_local bool isWorkerThread;
 ctpl::thread_pool renderPool(1);
 bool inited = false;
 
+enum
+{
+	MAX_RENDER_WORKERS = 8,
+};
+
 struct RenderJob
 {
 	enum
@@ -65,56 +72,134 @@ struct RenderJob
 		SpriteJob,
 		ParticleJob,
 		PortalJob,
-		TerminateJob	// inserted when all work is done so that the worker can return.
 	};
 	
 	int type;
 	subsector_t *sub;
 	seg_t *seg;
+
+	// Set by the worker which processed the job so that the output can be merged in job order.
+	int worker;
+	unsigned firstentry;
+	unsigned numentries;
 };
 
 
 class RenderJobQueue
 {
-	RenderJob pool[300000];	// Way more than ever needed. The largest ever seen on a single viewpoint is around 40000.
+	// Jobs are stored in blocks that get allocated as needed and are kept for the following frames.
+	// Blocks never move, so the workers can read from them while the main thread adds new ones.
+	enum
+	{
+		BLOCKSHIFT = 12,
+		BLOCKSIZE = 1 << BLOCKSHIFT,
+		MAXBLOCKS = 1024,	// The largest number of jobs ever seen on a single viewpoint is around 40000.
+	};
+
+	RenderJob *blocks[MAXBLOCKS] = {};
 	std::atomic<int> readindex{};
 	std::atomic<int> writeindex{};
+	std::atomic<bool> finished{};
 public:
-	void AddJob(int type, subsector_t *sub, seg_t *seg = nullptr)
+	~RenderJobQueue()
 	{
-		// This does not check for array overflows. The pool should be large enough that it never hits the limit.
+		for (auto block : blocks) delete[] block;
+	}
 
-		pool[writeindex] = { type, sub, seg };
-		writeindex++;	// update index only after the value has been written.
+	// Only called by the main thread.
+	void AddJob(int type, subsector_t *sub, seg_t *seg = nullptr)
+	{
+		int index = writeindex.load(std::memory_order_relaxed);
+		int blockindex = index >> BLOCKSHIFT;
+		if (blockindex >= MAXBLOCKS) I_FatalError("Render job queue overflow");
+
+		auto &block = blocks[blockindex];
+		if (block == nullptr) block = new RenderJob[BLOCKSIZE];
+		block[index & (BLOCKSIZE - 1)] = { type, sub, seg, 0, 0, 0 };
+		writeindex.store(index + 1, std::memory_order_release);	// update index only after the value has been written.
 	}
 
+	// Called by all workers. Each job is claimed by exactly one of them.
 	RenderJob *GetJob()
 	{
-		if (readindex < writeindex) return &pool[readindex++];
+		int index = readindex.load(std::memory_order_relaxed);
+		while (index < writeindex.load(std::memory_order_acquire))
+		{
+			if (readindex.compare_exchange_weak(index, index + 1)) return &Job(index);
+		}
 		return nullptr;
 	}
+
+	RenderJob &Job(int index)
+	{
+		return blocks[index >> BLOCKSHIFT][index & (BLOCKSIZE - 1)];
+	}
+
+	int Size() const
+	{
+		return writeindex;
+	}
+
+	void Finish()
+	{
+		finished = true;
+	}
+
+	bool IsFinished() const
+	{
+		return finished;
+	}
 	
 	void ReleaseAll()
 	{
 		readindex = 0;
 		writeindex = 0;
+		finished = false;
 	}
 };
 
 static RenderJobQueue jobQueue;	// One static queue is sufficient here. This code will never be called recursively.
 
-void HWDrawInfo::WorkerThread()
+static int GetRenderWorkerCount()
+{
+	int count = gl_multithread_workers;
+	if (count <= 0)
+	{
+		// Leave one core for the main thread which traverses the BSP.
+		count = clamp<int>(std::thread::hardware_concurrency() - 1, 1, 4);
+	}
+	return min<int>(count, MAX_RENDER_WORKERS);
+}
+
+//==========================================================================
+//
+// Processes jobs until the main thread is done with the BSP.
+// Everything a job produces goes into this worker's output and is added
+// to the draw lists by MergeWorkerOutput, so the result does not depend
+// on which worker got which job.
+//
+// Only the first worker runs the setup clocks because they are not thread safe.
+//
+//==========================================================================
+
+void HWDrawInfo::WorkerThread(int index)
 {
 	sector_t *front, *back;
 	HWWallDispatcher disp(this);
+	auto output = WorkerOutputs[index];
+	bool timing = index == 0;
 
-	WTTotal.Clock();
+	if (timing) WTTotal.Clock();
 	isWorkerThread = true;	// for adding asserts in GL API code. The worker thread may never call any GL API.
+	WorkerOutput = output;
 	while (true)
 	{
+		// This must be checked before looking for a new job, otherwise a job added in between could be missed.
+		bool finished = jobQueue.IsFinished();
 		auto job = jobQueue.GetJob();
 		if (job == nullptr)
 		{
+			if (finished) break;
 #ifdef ARCH_IA32
 			// The queue is empty. But yielding would be too costly here and possibly cause further delays down the line if the thread is halted.
 			// So instead add a few pause instructions and retry immediately.
@@ -129,19 +214,20 @@ void HWDrawInfo::WorkerThread()
 			_mm_pause();
 			_mm_pause();
 #endif // ARCH_IA32
+			continue;
 		}
+
+		job->worker = index;
+		job->firstentry = output->Entries.Size();
+
 		// Note that the main thread MUST have prepared the fake sectors that get used below!
 		// This worker thread cannot prepare them itself without costly synchronization.
-		else switch (job->type)
+		switch (job->type)
 		{
-		case RenderJob::TerminateJob:
-			WTTotal.Unclock();
-			return;
-
 		case RenderJob::WallJob:
 		{
 			HWWall wall;
-			SetupWall.Clock();
+			if (timing) SetupWall.Clock();
 			wall.sub = job->sub;
 
 			front = hw_FakeFlat(job->sub->sector, in_area, false);
@@ -173,46 +259,117 @@ void HWDrawInfo::WorkerThread()
 
 			wall.Process(&disp, job->seg, front, back);
 			rendered_lines++;
-			SetupWall.Unclock();
+			if (timing) SetupWall.Unclock();
 			break;
 		}
 
 		case RenderJob::FlatJob:
 		{
 			HWFlat flat;
-			SetupFlat.Clock();
+			if (timing) SetupFlat.Clock();
 			flat.section = job->sub->section;
 			front = hw_FakeFlat(job->sub->render_sector, in_area, false);
 			flat.ProcessSector(this, front);
-			SetupFlat.Unclock();
+			if (timing) SetupFlat.Unclock();
 			break;
 		}
 
 		case RenderJob::SpriteJob:
-			SetupSprite.Clock();
+			if (timing) SetupSprite.Clock();
 			front = hw_FakeFlat(job->sub->sector, in_area, false);
 			RenderThings(job->sub, front);
-			SetupSprite.Unclock();
+			if (timing) SetupSprite.Unclock();
 			break;
 
 		case RenderJob::ParticleJob:
-			SetupSprite.Clock();
+			if (timing) SetupSprite.Clock();
 			front = hw_FakeFlat(job->sub->sector, in_area, false);
 			RenderParticles(job->sub, front);
-			SetupSprite.Unclock();
+			if (timing) SetupSprite.Unclock();
 			break;
 
 		case RenderJob::PortalJob:
-			AddSubsectorToPortal((FSectorPortalGroup *)job->seg, job->sub);
+			// handled by MergeWorkerOutput because it needs the portal state.
 			break;
 		}
-
+		job->numentries = output->Entries.Size() - job->firstentry;
 	}
+	WorkerOutput = nullptr;
+	if (timing) WTTotal.Unclock();
 }
 
+//==========================================================================
+//
+// Adds everything the workers produced, in the order the jobs were
+// queued. This is the same order in which the single threaded code
+// would have added the items.
+//
+//==========================================================================
+
+void HWDrawInfo::MergeWorkerOutput()
+{
+	HWWallDispatcher disp(this);
+	bool thingvisible = true;
+
+	for (int i = 0; i < jobQueue.Size(); i++)
+	{
+		auto &job = jobQueue.Job(i);
+		if (job.type == RenderJob::PortalJob)
+		{
+			AddSubsectorToPortal((FSectorPortalGroup *)job.seg, job.sub);
+			continue;
+		}
+
+		auto &entries = WorkerOutputs[job.worker]->Entries;
+		for (unsigned j = job.firstentry; j < job.firstentry + job.numentries; j++)
+		{
+			auto &entry = entries[j];
+			switch (entry.type)
+			{
+			case HWWorkerOutput::Wall:
+				drawlists[entry.list].AddWall((HWWall *)entry.item);
+				break;
+
+			case HWWorkerOutput::Flat:
+				drawlists[entry.list].AddFlat((HWFlat *)entry.item);
+				break;
+
+			case HWWorkerOutput::Sprite:
+				// Sprites of an actor that was already added by an earlier job must be skipped.
+				if (entry.aux == nullptr || thingvisible) drawlists[entry.list].AddSprite((HWSprite *)entry.item);
+				break;
+
+			case HWWorkerOutput::Decal:
+				Decals[entry.list].Push((HWDecal *)entry.item);
+				break;
+
+			case HWWorkerOutput::Portal:
+			{
+				auto wall = (HWWall *)entry.item;
+				wall->PutPortal(&disp, entry.list, entry.plane);
+				break;
+			}
 
+			case HWWorkerOutput::UpperMissing:
+				AddUpperMissingTexture((side_t *)entry.item, (subsector_t *)entry.aux, entry.height);
+				break;
 
+			case HWWorkerOutput::LowerMissing:
+				AddLowerMissingTexture((side_t *)entry.item, (subsector_t *)entry.aux, entry.height);
+				break;
 
+			case HWWorkerOutput::Thing:
+			{
+				// Actors touching several sectors can be processed by more than one worker. The first job wins.
+				auto thing = (AActor *)entry.item;
+				thingvisible = thing->validcount != validcount;
+				thing->validcount = validcount;
+				break;
+			}
+			}
+		}
+	}
+}
 
 EXTERN_CVAR(Bool, gl_render_segs)
 
@@ -530,8 +687,16 @@ void HWDrawInfo::RenderThings(subsector_t * sub, sector_t * sector)
 	for (auto p = sec->touching_renderthings; p != nullptr; p = p->m_snext)
 	{
 		auto thing = p->m_thing;
-		if (thing->validcount == validcount) continue;
-		thing->validcount = validcount;
+		if (WorkerOutput)
+		{
+			// validcount cannot be used from several threads, so this gets sorted out when merging.
+			WorkerOutput->Add(HWWorkerOutput::Thing, thing, nullptr);
+		}
+		else
+		{
+			if (thing->validcount == validcount) continue;
+			thing->validcount = validcount;
+		}
 
 		FIntCVar *cvar = thing->GetInfo()->distancecheck;
 		if (cvar != nullptr && *cvar >= 0)
@@ -547,6 +712,7 @@ void HWDrawInfo::RenderThings(subsector_t * sub, sector_t * sector)
 		if (CurrentMapSections[thing->subsector->mapsection])
 		{
 			HWSprite sprite;
+			if (WorkerOutput) WorkerOutput->CurrentThing = thing;
 
 			// [Nash] draw sprite shadow
 			if (R_ShouldDrawSpriteShadow(thing))
@@ -560,6 +726,7 @@ void HWDrawInfo::RenderThings(subsector_t * sub, sector_t * sector)
 			}
 
 			sprite.Process(this, thing, sector, in_area, false);
+			if (WorkerOutput) WorkerOutput->CurrentThing = nullptr;
 		}
 	}
 	
@@ -596,7 +763,6 @@ void HWDrawInfo::RenderThings(subsector_t * sub, sector_t * sector)
 
 void HWDrawInfo::RenderParticles(subsector_t *sub, sector_t *front)
 {
-	SetupSprite.Clock();
 	for (uint32_t i = 0; i < sub->sprites.Size(); i++)
 	{
 		DVisualThinker *sp = sub->sprites[i];
@@ -612,7 +778,7 @@ void HWDrawInfo::RenderParticles(subsector_t *sub, sector_t *front)
 
 		sp->spr->ProcessParticle(this, &sp->PT, front, sp);
 	}
-	for (int i = Level->ParticlesInSubsec[sub->Index()]; i != NO_PARTICLE; i = Level->Particles[i].snext)
+	for (uint32_t i = Level->ParticlesInSubsec[sub->Index()]; i != NO_PARTICLE; i = Level->Particles[i].snext)
 	{
 		if (mClipPortal)
 		{
@@ -623,7 +789,6 @@ void HWDrawInfo::RenderParticles(subsector_t *sub, sector_t *front)
 		HWSprite sprite;
 		sprite.ProcessParticle(this, &Level->Particles[i], front, nullptr);
 	}
-	SetupSprite.Unclock();
 }
 
 
@@ -862,23 +1027,49 @@ void HWDrawInfo::RenderBSP(void *node, bool drawpsprites)
 	multithread = gl_multithread;
 	if (multithread)
 	{
+		int numworkers = GetRenderWorkerCount();
+		if (renderPool.size() != numworkers) renderPool.resize(numworkers);
+		while ((int)WorkerOutputs.Size() < numworkers) WorkerOutputs.Push(new HWWorkerOutput);
+		for (int i = 0; i < numworkers; i++) WorkerOutputs[i]->Entries.Clear();
+
+		// The vertex height lists are shared between walls, so the workers may not
+		// recalculate them while others read them.
+		if (gl_seamless)
+		{
+			for (auto &vert : Level->vertexes)
+			{
+				if (vert.dirty) vert.RecalcVertexHeights();
+			}
+		}
+
 		jobQueue.ReleaseAll();
-		auto future = renderPool.push([&](int id) {
-			WorkerThread();
-		});
+		std::future<void> futures[MAX_RENDER_WORKERS];
+		for (int i = 0; i < numworkers; i++)
+		{
+			futures[i] = renderPool.push([=](int id) {
+				WorkerThread(i);
+			});
+		}
 		RenderBSPNode(node);
 
-		jobQueue.AddJob(RenderJob::TerminateJob, nullptr, nullptr);
+		jobQueue.Finish();
 		Bsp.Unclock();
 		MTWait.Clock();
-		future.wait();
+		for (int i = 0; i < numworkers; i++) futures[i].wait();
 		MTWait.Unclock();
+
+		Bsp.Clock();
+		MergeWorkerOutput();
+		Bsp.Unclock();
 	}
 	else
 	{
 		RenderBSPNode(node);
 		Bsp.Unclock();
 	}
+	// Write the vertices of all planes that moved since they were last seen.
+	FlushPlaneUpdates(screen->mVertexData, multithread ? &renderPool : nullptr);
+
 	// Process all the sprites on the current portal's back side which touch the portal.
 	if (mCurrentPortal != nullptr) mCurrentPortal->RenderAttached(this);
 
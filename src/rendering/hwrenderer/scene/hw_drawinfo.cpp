@@ -422,6 +422,7 @@ HWPortal * HWDrawInfo::FindPortal(const void * src)
 
 HWDecal *HWDrawInfo::AddDecal(bool onmirror)
 {
+	if (WorkerOutput) return (HWDecal*)WorkerOutput->Alloc(HWWorkerOutput::Decal, onmirror, sizeof(HWDecal));
 	auto decal = (HWDecal*)RenderDataAllocator.Alloc(sizeof(HWDecal));
 	Decals[onmirror ? 1 : 0].Push(decal);
 	return decal;
@@ -41,9 +41,13 @@
 
 FMemArena RenderDataAllocator(1024*1024);	// Use large blocks to reduce allocation time.
 
+thread_local HWWorkerOutput *WorkerOutput;
+TDeletingArray<HWWorkerOutput *> WorkerOutputs;
+
 void ResetRenderDataAllocator()
 {
 	RenderDataAllocator.FreeAll();
+	for (auto output : WorkerOutputs) output->Arena.FreeAll();
 }
 
 //==========================================================================
@@ -764,10 +768,15 @@ void HWDrawList::SortFlats()
 HWWall *HWDrawList::NewWall()
 {
 	auto wall = (HWWall*)RenderDataAllocator.Alloc(sizeof(HWWall));
-	drawitems.Push(HWDrawItem(DrawType_WALL, walls.Push(wall)));
+	AddWall(wall);
 	return wall;
 }
 
+void HWDrawList::AddWall(HWWall *wall)
+{
+	drawitems.Push(HWDrawItem(DrawType_WALL, walls.Push(wall)));
+}
+
 //==========================================================================
 //
 //
@@ -776,10 +785,15 @@ HWWall *HWDrawList::NewWall()
 HWFlat *HWDrawList::NewFlat()
 {
 	auto flat = (HWFlat*)RenderDataAllocator.Alloc(sizeof(HWFlat));
-	drawitems.Push(HWDrawItem(DrawType_FLAT,flats.Push(flat)));
+	AddFlat(flat);
 	return flat;
 }
 
+void HWDrawList::AddFlat(HWFlat *flat)
+{
+	drawitems.Push(HWDrawItem(DrawType_FLAT,flats.Push(flat)));
+}
+
 //==========================================================================
 //
 //
@@ -788,10 +802,15 @@ HWFlat *HWDrawList::NewFlat()
 HWSprite *HWDrawList::NewSprite()
 {	
 	auto sprite = (HWSprite*)RenderDataAllocator.Alloc(sizeof(HWSprite));
-	drawitems.Push(HWDrawItem(DrawType_SPRITE, sprites.Push(sprite)));
+	AddSprite(sprite);
 	return sprite;
 }
 
+void HWDrawList::AddSprite(HWSprite *sprite)
+{
+	drawitems.Push(HWDrawItem(DrawType_SPRITE, sprites.Push(sprite)));
+}
+
 //==========================================================================
 //
 //
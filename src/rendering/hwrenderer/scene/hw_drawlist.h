@@ -10,6 +10,78 @@ class HWFlat;
 class HWSprite;
 class FRenderState;
 
+//==========================================================================
+//
+// Output of one BSP worker thread
+//
+// The workers may not touch the draw info's lists directly, so they
+// copy everything into their own arena and log what the main thread
+// has to add once the BSP has been traversed.
+//
+//==========================================================================
+
+struct HWWorkerOutput
+{
+	enum EType : uint8_t
+	{
+		Wall,
+		Flat,
+		Sprite,
+		Decal,
+		Portal,			// HWWall::PutPortal, which needs the portal manager
+		UpperMissing,
+		LowerMissing,
+		Thing,			// starts the sprites of an actor, which may be seen by several workers.
+	};
+
+	struct Entry
+	{
+		uint8_t type;
+		uint8_t list;		// draw list, or the portal type for Portal
+		int16_t plane;		// sky plane for Portal
+		float height;
+		void *item;
+		void *aux;
+	};
+
+	FMemArena Arena{ 1024 * 1024 };
+	TArray<Entry> Entries;
+	void *CurrentThing = nullptr;
+
+	template<class T> T *Add(EType type, int list, const T *item)
+	{
+		auto copy = (T*)Arena.Alloc(sizeof(T));
+		*copy = *item;
+		Entries.Push({ type, (uint8_t)list, 0, 0.f, copy, CurrentThing });
+		return copy;
+	}
+
+	// The portal type and plane are kept here and not in the wall, where
+	// they would share a union with the pointers the main thread needs.
+	template<class T> T *AddPortal(const T *item, int ptype, int plane)
+	{
+		auto copy = (T*)Arena.Alloc(sizeof(T));
+		*copy = *item;
+		Entries.Push({ Portal, (uint8_t)ptype, (int16_t)plane, 0.f, copy, nullptr });
+		return copy;
+	}
+
+	void *Alloc(EType type, int list, size_t size)
+	{
+		auto p = Arena.Alloc(size);
+		Entries.Push({ type, (uint8_t)list, 0, 0.f, p, nullptr });
+		return p;
+	}
+
+	void Add(EType type, void *item, void *aux, float height = 0.f)
+	{
+		Entries.Push({ type, 0, 0, height, item, aux });
+	}
+};
+
+extern thread_local HWWorkerOutput *WorkerOutput;	// only set on BSP worker threads
+extern TDeletingArray<HWWorkerOutput *> WorkerOutputs;
+
 //==========================================================================
 //
 // Intermediate struct to link one draw item into a draw list
@@ -91,6 +163,9 @@ public:
 	HWWall *NewWall();
 	HWFlat *NewFlat();
 	HWSprite *NewSprite();
+	void AddWall(HWWall *wall);
+	void AddFlat(HWFlat *flat);
+	void AddSprite(HWSprite *sprite);
 	void Reset();
 	void SortWalls();
 	void SortFlats();
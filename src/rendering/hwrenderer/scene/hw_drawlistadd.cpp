@@ -39,15 +39,15 @@ EXTERN_CVAR(Bool, gl_seamless)
 
 void HWDrawInfo::AddWall(HWWall *wall)
 {
+	int list;
+
 	if (wall->flags & HWWall::HWF_TRANSLUCENT)
 	{
-		auto newwall = drawlists[GLDL_TRANSLUCENT].NewWall();
-		*newwall = *wall;
+		list = GLDL_TRANSLUCENT;
 	}
 	else
 	{
 		bool masked = HWWall::passflag[wall->type] == 1 ? false : (wall->texture && wall->texture->isMasked());
-		int list;
 
 		if (wall->flags & HWWall::HWF_SKYHACK && wall->type == RENDERWALL_M2S)
 		{
@@ -57,9 +57,14 @@ void HWDrawInfo::AddWall(HWWall *wall)
 		{
 			list = masked ? GLDL_MASKEDWALLS : GLDL_PLAINWALLS;
 		}
-		auto newwall = drawlists[list].NewWall();
-		*newwall = *wall;
 	}
+	if (WorkerOutput)
+	{
+		WorkerOutput->Add(HWWorkerOutput::Wall, list, wall);
+		return;
+	}
+	auto newwall = drawlists[list].NewWall();
+	*newwall = *wall;
 }
 
 //==========================================================================
@@ -130,6 +135,11 @@ void HWDrawInfo::AddFlat(HWFlat *flat, bool fog)
 		bool masked = flat->texture->isMasked() && ((flat->renderflags&SSRF_RENDER3DPLANES) || flat->stack);
 		list = masked ? GLDL_MASKEDFLATS : GLDL_PLAINFLATS;
 	}
+	if (WorkerOutput)
+	{
+		WorkerOutput->Add(HWWorkerOutput::Flat, list, flat);
+		return;
+	}
 	auto newflat = drawlists[list].NewFlat();
 	*newflat = *flat;
 }
@@ -153,6 +163,11 @@ void HWDrawInfo::AddSprite(HWSprite *sprite, bool translucent)
 		list = GLDL_MODELS;
 	}
 
+	if (WorkerOutput)
+	{
+		WorkerOutput->Add(HWWorkerOutput::Sprite, list, sprite);
+		return;
+	}
 	auto newsprt = drawlists[list].NewSprite();
 	*newsprt = *sprite;
 }
@@ -147,7 +147,7 @@ void HWFlat::CreateSkyboxVertices(FFlatVertex *vert)
 //
 //==========================================================================
 
-void HWFlat::SetupLights(HWDrawInfo *di, FLightNode * node, FDynLightData &lightdata, int portalgroup)
+void HWFlat::SetupLights(HWDrawInfo *di, FLightList lights, FDynLightData &lightdata, int portalgroup)
 {
 	Plane p;
 
@@ -157,13 +157,10 @@ void HWFlat::SetupLights(HWDrawInfo *di, FLightNode * node, FDynLightData &light
 		dynlightindex = -1;
 		return;	// no lights on additively blended surfaces.
 	}
-	while (node)
+	for (auto light : lights)
 	{
-		FDynamicLight * light = node->lightsource;
-
 		if (!light->IsActive() || light->DontLightMap())
 		{
-			node = node->nextLight;
 			continue;
 		}
 		iter_dlightf++;
@@ -173,13 +170,11 @@ void HWFlat::SetupLights(HWDrawInfo *di, FLightNode * node, FDynLightData &light
 		double planeh = plane.plane.ZatPoint(light->Pos);
 		if ((planeh<light->Z() && ceiling) || (planeh>light->Z() && !ceiling))
 		{
-			node = node->nextLight;
 			continue;
 		}
 
 		p.Set(plane.plane.Normal(), plane.plane.fD());
 		draw_dlightf += GetLight(lightdata, portalgroup, p, light, false);
-		node = node->nextLight;
 	}
 
 	dynlightindex = screen->mLights->UploadLights(lightdata);
@@ -195,7 +190,7 @@ void HWFlat::DrawSubsectors(HWDrawInfo *di, FRenderState &state)
 {
 	if (di->Level->HasDynamicLights && screen->BuffersArePersistent() && !di->isFullbrightScene())
 	{
-		SetupLights(di, section->lighthead, lightdata, sector->PortalGroup);
+		SetupLights(di, section->lights, lightdata, sector->PortalGroup);
 	}
 	state.SetLightIndex(dynlightindex);
 
@@ -392,7 +387,7 @@ inline void HWFlat::PutFlat(HWDrawInfo *di, bool fog)
 	{
 		if (di->Level->HasDynamicLights && texture != nullptr && !di->isFullbrightScene() && !(hacktype & (SSRF_PLANEHACK|SSRF_FLOODHACK)) )
 		{
-			SetupLights(di, section->lighthead, lightdata, sector->PortalGroup);
+			SetupLights(di, section->lights, lightdata, sector->PortalGroup);
 		}
 	}
 	di->AddFlat(this, fog);
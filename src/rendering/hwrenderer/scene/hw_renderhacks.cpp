@@ -115,23 +115,17 @@ int HWDrawInfo::SetupLightsForOtherPlane(subsector_t * sub, FDynLightData &light
 	{
 		Plane p;
 
-		FLightNode * node = sub->section->lighthead;
-
 		lightdata.Clear();
-		while (node)
+		for (auto light : sub->section->lights)
 		{
-			FDynamicLight * light = node->lightsource;
-
 			if (!light->IsActive())
 			{
-				node = node->nextLight;
 				continue;
 			}
 			iter_dlightf++;
 
 			p.Set(plane->Normal(), plane->fD());
 			draw_dlightf += GetLight(lightdata, sub->sector->PortalGroup, p, light, true);
-			node = node->nextLight;
 		}
 
 		return screen->mLights->UploadLights(lightdata);
@@ -196,6 +190,11 @@ void HWDrawInfo::AddOtherCeilingPlane(int sector, gl_subsectorrendernode * node)
 void HWDrawInfo::AddUpperMissingTexture(side_t * side, subsector_t *sub, float Backheight)
 {
 	if (!side->segs[0]->backsector) return;
+	if (WorkerOutput)
+	{
+		WorkerOutput->Add(HWWorkerOutput::UpperMissing, side, sub, Backheight);
+		return;
+	}
 
 	for (int i = 0; i < side->numsegs; i++)
 	{
@@ -249,6 +248,11 @@ void HWDrawInfo::AddLowerMissingTexture(side_t * side, subsector_t *sub, float B
 {
 	sector_t *backsec = side->segs[0]->backsector;
 	if (!backsec) return;
+	if (WorkerOutput)
+	{
+		WorkerOutput->Add(HWWorkerOutput::LowerMissing, side, sub, Backheight);
+		return;
+	}
 	if (backsec->transdoor)
 	{
 		// Transparent door hacks alter the backsector's floor height so we should not
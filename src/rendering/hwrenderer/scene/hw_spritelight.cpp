@@ -107,9 +107,8 @@ LightProbe* FindLightProbe(FLevelLocals* level, float x, float y, float z)
 //
 //==========================================================================
 
-void HWDrawInfo::GetDynSpriteLight(AActor *self, float x, float y, float z, FLightNode *node, int portalgroup, float *out)
+void HWDrawInfo::GetDynSpriteLight(AActor *self, float x, float y, float z, FLightList lights, int portalgroup, float *out)
 {
-	FDynamicLight *light;
 	float frac, lr, lg, lb;
 	float radius;
 	
@@ -123,10 +122,8 @@ void HWDrawInfo::GetDynSpriteLight(AActor *self, float x, float y, float z, FLig
 		out[2] = probe->Blue;
 	}
 
-	// Go through both light lists
-	while (node)
+	for (auto light : lights)
 	{
-		light=node->lightsource;
 		if (light->ShouldLightActor(self))
 		{
 			float dist;
@@ -191,7 +188,6 @@ void HWDrawInfo::GetDynSpriteLight(AActor *self, float x, float y, float z, FLig
 				}
 			}
 		}
-		node = node->nextLight;
 	}
 }
 
@@ -199,11 +195,11 @@ void HWDrawInfo::GetDynSpriteLight(AActor *thing, particle_t *particle, float *o
 {
 	if (thing != NULL)
 	{
-		GetDynSpriteLight(thing, (float)thing->X(), (float)thing->Y(), (float)thing->Center(), thing->section->lighthead, thing->Sector->PortalGroup, out);
+		GetDynSpriteLight(thing, (float)thing->X(), (float)thing->Y(), (float)thing->Center(), thing->section->lights, thing->Sector->PortalGroup, out);
 	}
 	else if (particle != NULL)
 	{
-		GetDynSpriteLight(NULL, (float)particle->Pos.X, (float)particle->Pos.Y, (float)particle->Pos.Z, particle->subsector->section->lighthead, particle->subsector->sector->PortalGroup, out);
+		GetDynSpriteLight(NULL, (float)particle->Pos.X, (float)particle->Pos.Y, (float)particle->Pos.Z, particle->subsector->section->lights, particle->subsector->sector->PortalGroup, out);
 	}
 }
 
@@ -232,10 +228,8 @@ void hw_GetDynModelLight(AActor *self, FDynLightData &modellightdata)
 		{
 			auto section = subsector->section;
 			if (section->validcount == dl_validcount) return;	// already done from a previous subsector.
-			FLightNode * node = section->lighthead;
-			while (node) // check all lights touching a subsector
+			for (auto light : section->lights) // check all lights touching a subsector
 			{
-				FDynamicLight *light = node->lightsource;
 				if (light->ShouldLightActor(self))
 				{
 					int group = subsector->sector->PortalGroup;
@@ -254,7 +248,6 @@ void hw_GetDynModelLight(AActor *self, FDynLightData &modellightdata)
 						}
 					}
 				}
-				node = node->nextLight;
 			}
 		});
 	}
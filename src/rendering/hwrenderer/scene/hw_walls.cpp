@@ -402,35 +402,35 @@ void HWWall::SetupLights(HWDrawInfo*di, FDynLightData &lightdata)
 	auto normal = glseg.Normal();
 	p.Set(normal, -normal.X * glseg.x1 - normal.Z * glseg.y1);
 
-	FLightNode *node;
+	FLightList lights;
 	if (seg->sidedef == NULL)
 	{
-		node = NULL;
+		lights = {};
 	}
 	else if (!(seg->sidedef->Flags & WALLF_POLYOBJ))
 	{
-		node = seg->sidedef->lighthead;
+		lights = seg->sidedef->lights;
 	}
 	else if (sub)
 	{
 		// Polobject segs cannot be checked per sidedef so use the subsector instead.
-		node = sub->section->lighthead;
+		lights = sub->section->lights;
 	}
-	else node = NULL;
+	else lights = {};
 
 	// Iterate through all dynamic lights which touch this wall and render them
-	while (node)
+	for (auto light : lights)
 	{
-		if (node->lightsource->IsActive() && !node->lightsource->DontLightMap())
+		if (light->IsActive() && !light->DontLightMap())
 		{
 			iter_dlight++;
 
-			DVector3 posrel = node->lightsource->PosRelative(seg->frontsector->PortalGroup);
+			DVector3 posrel = light->PosRelative(seg->frontsector->PortalGroup);
 			float x = posrel.X;
 			float y = posrel.Y;
 			float z = posrel.Z;
 			float dist = fabsf(p.DistToPoint(x, z, y));
-			float radius = node->lightsource->GetRadius();
+			float radius = light->GetRadius();
 			float scale = 1.0f / ((2.f * radius) - dist);
 			FVector3 fn, pos;
 
@@ -466,11 +466,10 @@ void HWWall::SetupLights(HWDrawInfo*di, FDynLightData &lightdata)
 				}
 				if (outcnt[0]!=4 && outcnt[1]!=4 && outcnt[2]!=4 && outcnt[3]!=4) 
 				{
-					draw_dlight += GetLight(lightdata, seg->frontsector->PortalGroup, p, node->lightsource, true);
+					draw_dlight += GetLight(lightdata, seg->frontsector->PortalGroup, p, light, true);
 				}
 			}
 		}
-		node = node->nextLight;
 	}
 	dynlightindex = screen->mLights->UploadLights(lightdata);
 }
@@ -578,7 +577,12 @@ void HWWall::PutPortal(HWWallDispatcher *di, int ptype, int plane)
 	HWPortal * portal = nullptr;
 
 	auto ddi = di->di;
-	if (ddi)
+	if (ddi && WorkerOutput)
+	{
+		// The portal manager is not thread safe so this has to be done by the main thread.
+		WorkerOutput->AddPortal(this, ptype, plane);
+	}
+	else if (ddi)
 	{
 		MakeVertices(false);
 		switch (ptype)
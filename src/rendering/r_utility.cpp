@@ -848,6 +848,7 @@ void R_SetupFrame(FRenderViewpoint& viewPoint, const FViewWindow& viewWindow, AA
 		I_Error("Tried to render from a null actor.");
 
 	viewPoint.ViewLevel = actor->Level;
+	viewPoint.ViewLevel->UpdateLightLinks();
 
 	player_t* player = actor->player;
 	if (player != nullptr && player->mo == actor)
@@ -242,45 +242,42 @@ namespace swrenderer
 		drawerargs.dc_num_lights = 0;
 
 		// Setup lights for column
-		FLightNode* cur_node = drawerargs.LightList();
-		while (cur_node)
+		for (auto lightsource : drawerargs.LightList())
 		{
-			if (cur_node->lightsource->IsActive())
+			if (lightsource->IsActive())
 			{
-				double lightX = cur_node->lightsource->X() - wallargs.ViewpointPos.X;
-				double lightY = cur_node->lightsource->Y() - wallargs.ViewpointPos.Y;
-				double lightZ = cur_node->lightsource->Z() - wallargs.ViewpointPos.Z;
+				double lightX = lightsource->X() - wallargs.ViewpointPos.X;
+				double lightY = lightsource->Y() - wallargs.ViewpointPos.Y;
+				double lightZ = lightsource->Z() - wallargs.ViewpointPos.Z;
 
 				float lx = (float)(lightX * wallargs.Sin - lightY * wallargs.Cos) - drawerargs.dc_viewpos.X;
 				float ly = (float)(lightX * wallargs.TanCos + lightY * wallargs.TanSin) - drawerargs.dc_viewpos.Y;
 				float lz = (float)lightZ;
 
 				// Precalculate the constant part of the dot here so the drawer doesn't have to.
-				bool is_point_light = cur_node->lightsource->IsAttenuated();
+				bool is_point_light = lightsource->IsAttenuated();
 				float lconstant = lx * lx + ly * ly;
 				float nlconstant = is_point_light ? lx * drawerargs.dc_normal.X + ly * drawerargs.dc_normal.Y : 0.0f;
 
 				// Include light only if it touches this column
-				float radius = cur_node->lightsource->GetRadius();
+				float radius = lightsource->GetRadius();
 				if (radius * radius >= lconstant && nlconstant >= 0.0f)
 				{
-					uint32_t red = cur_node->lightsource->GetRed();
-					uint32_t green = cur_node->lightsource->GetGreen();
-					uint32_t blue = cur_node->lightsource->GetBlue();
+					uint32_t red = lightsource->GetRed();
+					uint32_t green = lightsource->GetGreen();
+					uint32_t blue = lightsource->GetBlue();
 
 					auto& light = drawerargs.dc_lights[drawerargs.dc_num_lights++];
 					light.x = lconstant;
 					light.y = nlconstant;
 					light.z = lz;
-					light.radius = 256.0f / cur_node->lightsource->GetRadius();
+					light.radius = 256.0f / lightsource->GetRadius();
 					light.color = (red << 16) | (green << 8) | blue;
 
 					if (drawerargs.dc_num_lights == WallColumnDrawerArgs::MAX_DRAWER_LIGHTS)
 						break;
 				}
 			}
-
-			cur_node = cur_node->nextLight;
 		}
 	}
 
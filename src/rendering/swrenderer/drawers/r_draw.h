@@ -6,7 +6,6 @@
 #include <memory>
 
 struct FSWColormap;
-struct FLightNode;
 
 EXTERN_CVAR(Int, r_multithreaded);
 EXTERN_CVAR(Bool, r_magfilter);
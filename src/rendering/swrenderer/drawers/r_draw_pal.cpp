@@ -3127,7 +3127,7 @@ namespace swrenderer
 	{
 		wallcolargs.wallargs = &wallargs;
 
-		bool haslights = r_dynlights && wallargs.lightlist;
+		bool haslights = r_dynlights && wallargs.lightlist.Size() > 0;
 		if (haslights)
 		{
 			float dx = wallargs.WallC.tright.X - wallargs.WallC.tleft.X;
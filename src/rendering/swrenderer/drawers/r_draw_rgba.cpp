@@ -59,6 +59,11 @@
 #include "r_draw_sprite32_sse2.h"
 #include "r_draw_span32_sse2.h"
 #include "r_draw_sky32_sse2.h"
+#ifdef HAVE_AVX2_DRAWERS
+#include "r_draw_wall32_avx2.h"
+#include "r_draw_span32_avx2.h"
+#include "x86.h"
+#endif
 #endif
 
 #include "gi.h"
@@ -78,35 +83,102 @@ CVAR(Bool, r_mipmap, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 // Level of detail texture bias
 CVAR(Float, r_lod_bias, -1.5, 0); // To do: add CVAR_ARCHIVE | CVAR_GLOBALCONFIG when a good default has been decided
 
+#ifdef HAVE_AVX2_DRAWERS
+// Use the AVX2 wall and span drawers if the CPU supports them
+CVAR(Bool, r_avx2drawers, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+
+static bool CheckAVX2Drawers()
+{
+	// The OS must also save the YMM registers on context switches
+	if (!CPU.bAVX2 || !CPU.bOSXSAVE)
+		return false;
+#if defined(_MSC_VER)
+	return (_xgetbv(0) & 6) == 6;
+#else
+	uint32_t eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return (eax & 6) == 6;
+#endif
+}
+
+static bool UseAVX2Drawers()
+{
+	static const bool supported = CheckAVX2Drawers();
+	return supported && r_avx2drawers;
+}
+#endif
+
 namespace swrenderer
 {
 	void SWTruecolorDrawers::DrawWall(const WallDrawerArgs &args)
 	{
+#ifdef HAVE_AVX2_DRAWERS
+		if (UseAVX2Drawers())
+		{
+			DrawWallColumns<DrawWall32AVX2Command>(args);
+			return;
+		}
+#endif
 		DrawWallColumns<DrawWall32Command>(args);
 	}
 	
 	void SWTruecolorDrawers::DrawWallMasked(const WallDrawerArgs &args)
 	{
+#ifdef HAVE_AVX2_DRAWERS
+		if (UseAVX2Drawers())
+		{
+			DrawWallColumns<DrawWallMasked32AVX2Command>(args);
+			return;
+		}
+#endif
 		DrawWallColumns<DrawWallMasked32Command>(args);
 	}
 	
 	void SWTruecolorDrawers::DrawWallAdd(const WallDrawerArgs &args)
 	{
+#ifdef HAVE_AVX2_DRAWERS
+		if (UseAVX2Drawers())
+		{
+			DrawWallColumns<DrawWallAddClamp32AVX2Command>(args);
+			return;
+		}
+#endif
 		DrawWallColumns<DrawWallAddClamp32Command>(args);
 	}
 	
 	void SWTruecolorDrawers::DrawWallAddClamp(const WallDrawerArgs &args)
 	{
+#ifdef HAVE_AVX2_DRAWERS
+		if (UseAVX2Drawers())
+		{
+			DrawWallColumns<DrawWallAddClamp32AVX2Command>(args);
+			return;
+		}
+#endif
 		DrawWallColumns<DrawWallAddClamp32Command>(args);
 	}
 	
 	void SWTruecolorDrawers::DrawWallSubClamp(const WallDrawerArgs &args)
 	{
+#ifdef HAVE_AVX2_DRAWERS
+		if (UseAVX2Drawers())
+		{
+			DrawWallColumns<DrawWallSubClamp32AVX2Command>(args);
+			return;
+		}
+#endif
 		DrawWallColumns<DrawWallSubClamp32Command>(args);
 	}
 	
 	void SWTruecolorDrawers::DrawWallRevSubClamp(const WallDrawerArgs &args)
 	{
+#ifdef HAVE_AVX2_DRAWERS
+		if (UseAVX2Drawers())
+		{
+			DrawWallColumns<DrawWallRevSubClamp32AVX2Command>(args);
+			return;
+		}
+#endif
 		DrawWallColumns<DrawWallRevSubClamp32Command>(args);
 	}
 	
@@ -206,31 +278,73 @@ namespace swrenderer
 
 	void SWTruecolorDrawers::DrawSpan(const SpanDrawerArgs &args)
 	{
+#ifdef HAVE_AVX2_DRAWERS
+		if (UseAVX2Drawers())
+		{
+			DrawSpan32AVX2Command::DrawColumn(args);
+			return;
+		}
+#endif
 		DrawSpan32Command::DrawColumn(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanMasked(const SpanDrawerArgs &args)
 	{
+#ifdef HAVE_AVX2_DRAWERS
+		if (UseAVX2Drawers())
+		{
+			DrawSpanMasked32AVX2Command::DrawColumn(args);
+			return;
+		}
+#endif
 		DrawSpanMasked32Command::DrawColumn(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanTranslucent(const SpanDrawerArgs &args)
 	{
+#ifdef HAVE_AVX2_DRAWERS
+		if (UseAVX2Drawers())
+		{
+			DrawSpanTranslucent32AVX2Command::DrawColumn(args);
+			return;
+		}
+#endif
 		DrawSpanTranslucent32Command::DrawColumn(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanMaskedTranslucent(const SpanDrawerArgs &args)
 	{
+#ifdef HAVE_AVX2_DRAWERS
+		if (UseAVX2Drawers())
+		{
+			DrawSpanAddClamp32AVX2Command::DrawColumn(args);
+			return;
+		}
+#endif
 		DrawSpanAddClamp32Command::DrawColumn(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanAddClamp(const SpanDrawerArgs &args)
 	{
+#ifdef HAVE_AVX2_DRAWERS
+		if (UseAVX2Drawers())
+		{
+			DrawSpanTranslucent32AVX2Command::DrawColumn(args);
+			return;
+		}
+#endif
 		DrawSpanTranslucent32Command::DrawColumn(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanMaskedAddClamp(const SpanDrawerArgs &args)
 	{
+#ifdef HAVE_AVX2_DRAWERS
+		if (UseAVX2Drawers())
+		{
+			DrawSpanAddClamp32AVX2Command::DrawColumn(args);
+			return;
+		}
+#endif
 		DrawSpanAddClamp32Command::DrawColumn(args);
 	}
 	
@@ -1027,7 +1141,7 @@ namespace swrenderer
 	{
 		wallcolargs.wallargs = &wallargs;
 
-		bool haslights = r_dynlights && wallargs.lightlist;
+		bool haslights = r_dynlights && wallargs.lightlist.Size() > 0;
 		if (haslights)
 		{
 			float dx = wallargs.WallC.tright.X - wallargs.WallC.tleft.X;
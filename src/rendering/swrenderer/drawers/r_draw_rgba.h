@@ -71,6 +71,16 @@ namespace swrenderer
 	#define VECTORCALL
 	#endif
 
+	// The AVX2 drawers are compiled for AVX2 per function, so the rest of the file can still run on SSE2 only CPUs
+	#if !defined(NO_SSE) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+	#define HAVE_AVX2_DRAWERS
+	#if defined(__GNUC__)
+	#define AVX2_TARGET __attribute__((target("avx2")))
+	#else
+	#define AVX2_TARGET
+	#endif
+	#endif
+
 	template<typename CommandType, typename BlendMode>
 	class DrawerBlendCommand : public CommandType
 	{
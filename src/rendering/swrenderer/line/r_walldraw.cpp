@@ -131,11 +131,11 @@ namespace swrenderer
 		// Textures that aren't masked can use the faster opaque drawer
 		if (!pic->isMasked() && mask && alpha >= OPAQUE && !additive)
 		{
-			drawerargs.SetStyle(true, false, OPAQUE, light_list);
+			drawerargs.SetStyle(true, false, OPAQUE, light_list.Size() > 0);
 		}
 		else
 		{
-			drawerargs.SetStyle(mask, additive, alpha, light_list);
+			drawerargs.SetStyle(mask, additive, alpha, light_list.Size() > 0);
 		}
 
 		if (cameraLight->FixedLightLevel() >= 0)
@@ -207,14 +207,14 @@ namespace swrenderer
 		drawerargs.DrawWall(Thread);
 	}
 
-	FLightNode* RenderWallPart::GetLightList()
+	FLightList RenderWallPart::GetLightList()
 	{
 		CameraLight* cameraLight = CameraLight::Instance();
 		if ((cameraLight->FixedLightLevel() >= 0) || cameraLight->FixedColormap())
-			return nullptr; // [SP] Don't draw dynlights if invul/lightamp active
+			return {}; // [SP] Don't draw dynlights if invul/lightamp active
 		else if (curline && curline->sidedef)
-			return curline->sidedef->lighthead;
+			return curline->sidedef->lights;
 		else
-			return nullptr;
+			return {};
 	}
 }
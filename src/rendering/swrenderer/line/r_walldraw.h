@@ -25,9 +25,7 @@
 #include "swrenderer/viewport/r_walldrawer.h"
 #include "r_line.h"
 
-struct FLightNode;
 struct seg_t;
-struct FLightNode;
 struct FDynamicColormap;
 
 namespace swrenderer
@@ -62,7 +60,7 @@ namespace swrenderer
 	private:
 		void ProcessStripedWall(const short *uwal, const short *dwal, const ProjectedWallTexcoords& texcoords);
 		void ProcessNormalWall(const short *uwal, const short *dwal, const ProjectedWallTexcoords& texcoords);
-		FLightNode* GetLightList();
+		FLightList GetLightList();
 
 		RenderThread* Thread = nullptr;
 
@@ -76,7 +74,7 @@ namespace swrenderer
 
 		ProjectedWallLight mLight;
 
-		FLightNode *light_list = nullptr;
+		FLightList light_list = {};
 		bool mask = false;
 		bool additive = false;
 		fixed_t alpha = 0;
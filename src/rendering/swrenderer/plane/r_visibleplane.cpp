@@ -66,7 +66,7 @@ namespace swrenderer
 		fillshort(top, viewwidth, 0x7fff);
 	}
 
-	void VisiblePlane::AddLights(RenderThread *thread, FLightNode *node)
+	void VisiblePlane::AddLights(RenderThread *thread, FLightList lightlist)
 	{
 		if (!r_dynlights)
 			return;
@@ -75,15 +75,15 @@ namespace swrenderer
 		if (cameraLight->FixedColormap() != NULL || cameraLight->FixedLightLevel() >= 0)
 			return; // [SP] no dynlights if invul or lightamp
 
-		while (node)
+		for (auto lightsource : lightlist)
 		{
-			if (node->lightsource->IsActive() && (height.PointOnSide(node->lightsource->Pos) > 0))
+			if (lightsource->IsActive() && (height.PointOnSide(lightsource->Pos) > 0))
 			{
 				bool found = false;
 				VisiblePlaneLight *light_node = lights;
 				while (light_node)
 				{
-					if (light_node->lightsource == node->lightsource)
+					if (light_node->lightsource == lightsource)
 					{
 						found = true;
 						break;
@@ -94,11 +94,10 @@ namespace swrenderer
 				{
 					VisiblePlaneLight *newlight = thread->FrameMemory->NewObject<VisiblePlaneLight>();
 					newlight->next = lights;
-					newlight->lightsource = node->lightsource;
+					newlight->lightsource = lightsource;
 					lights = newlight;
 				}
 			}
-			node = node->nextLight;
 		}
 	}
 
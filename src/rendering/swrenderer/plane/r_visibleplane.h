@@ -28,7 +28,6 @@
 #include "r_memory.h"
 
 struct FDynamicLight;
-struct FLightNode;
 struct FDynamicColormap;
 struct FSectorPortal;
 
@@ -46,7 +45,7 @@ namespace swrenderer
 	{
 		VisiblePlane(RenderThread *thread);
 
-		void AddLights(RenderThread *thread, FLightNode *node);
+		void AddLights(RenderThread *thread, FLightList lightlist);
 		void Render(RenderThread *thread, fixed_t alpha, bool additive, bool masked);
 
 		VisiblePlane *next = nullptr;		// Next visplane in hash chain -- killough
@@ -336,6 +336,22 @@ namespace swrenderer
 	// Checks BSP node/subtree bounding box.
 	// Returns true if some part of the bbox might be visible.
 	bool RenderOpaquePass::CheckBBox(float *bspcoord)
+	{
+		int sx1, sx2;
+		switch (ProjectBBox(bspcoord, !!(Thread->Portal->MirrorFlags & RF_XFLIP), sx1, sx2))
+		{
+		case BBoxVisibility::Outside:
+			return false;
+		case BBoxVisibility::Always:
+			return true;
+		default:
+			// Find the first clippost that touches the source post
+			//	(adjacent pixels are touching).
+			return Thread->ClipSegments->IsVisible(sx1, sx2);
+		}
+	}
+
+	BBoxVisibility RenderOpaquePass::ProjectBBox(float *bspcoord, bool xflip, int &sx1, int &sx2)
 	{
 		static const int checkcoord[12][4] =
 		{
@@ -358,7 +374,6 @@ namespace swrenderer
 
 		double	 			x1, y1, x2, y2;
 		double				rx1, ry1, rx2, ry2;
-		int					sx1, sx2;
 
 		// Find the corners of the box
 		// that define the edges from current viewpoint.
@@ -378,7 +393,7 @@ namespace swrenderer
 
 		boxpos = (boxy << 2) + boxx;
 		if (boxpos == 5)
-			return true;
+			return BBoxVisibility::Always;
 
 		x1 = bspcoord[checkcoord[boxpos][0]] - Thread->Viewport->viewpoint.Pos.X;
 		y1 = bspcoord[checkcoord[boxpos][1]] - Thread->Viewport->viewpoint.Pos.Y;
@@ -389,14 +404,14 @@ namespace swrenderer
 
 		// Sitting on a line?
 		if (y1 * (x1 - x2) + x1 * (y2 - y1) >= -EQUAL_EPSILON)
-			return true;
+			return BBoxVisibility::Always;
 
 		rx1 = x1 * Thread->Viewport->viewpoint.Sin - y1 * Thread->Viewport->viewpoint.Cos;
 		rx2 = x2 * Thread->Viewport->viewpoint.Sin - y2 * Thread->Viewport->viewpoint.Cos;
 		ry1 = x1 * Thread->Viewport->viewpoint.TanCos + y1 * Thread->Viewport->viewpoint.TanSin;
 		ry2 = x2 * Thread->Viewport->viewpoint.TanCos + y2 * Thread->Viewport->viewpoint.TanSin;
 
-		if (Thread->Portal->MirrorFlags & RF_XFLIP)
+		if (xflip)
 		{
 			double t = -rx1;
 			rx1 = -rx2;
@@ -408,34 +423,31 @@ namespace swrenderer
 
 		if (rx1 >= -ry1)
 		{
-			if (rx1 > ry1) return false;	// left edge is off the right side
-			if (ry1 == 0) return false;
+			if (rx1 > ry1) return BBoxVisibility::Outside;	// left edge is off the right side
+			if (ry1 == 0) return BBoxVisibility::Outside;
 			sx1 = xs_RoundToInt(viewport->CenterX + rx1 * viewport->CenterX / ry1);
 		}
 		else
 		{
-			if (rx2 < -ry2) return false;	// wall is off the left side
-			if (rx1 - rx2 - ry2 + ry1 == 0) return false;	// wall does not intersect view volume
+			if (rx2 < -ry2) return BBoxVisibility::Outside;	// wall is off the left side
+			if (rx1 - rx2 - ry2 + ry1 == 0) return BBoxVisibility::Outside;	// wall does not intersect view volume
 			sx1 = 0;
 		}
 
 		if (rx2 <= ry2)
 		{
-			if (rx2 < -ry2) return false;	// right edge is off the left side
-			if (ry2 == 0) return false;
+			if (rx2 < -ry2) return BBoxVisibility::Outside;	// right edge is off the left side
+			if (ry2 == 0) return BBoxVisibility::Outside;
 			sx2 = xs_RoundToInt(viewport->CenterX + rx2 * viewport->CenterX / ry2);
 		}
 		else
 		{
-			if (rx1 > ry1) return false;	// wall is off the right side
-			if (ry2 - ry1 - rx2 + rx1 == 0) return false;	// wall does not intersect view volume
+			if (rx1 > ry1) return BBoxVisibility::Outside;	// wall is off the right side
+			if (ry2 - ry1 - rx2 + rx1 == 0) return BBoxVisibility::Outside;	// wall does not intersect view volume
 			sx2 = viewwidth;
 		}
 
-		// Find the first clippost that touches the source post
-		//	(adjacent pixels are touching).
-
-		return Thread->ClipSegments->IsVisible(sx1, sx2);
+		return BBoxVisibility::Columns;
 	}
 
 	void RenderOpaquePass::AddPolyobjs(subsector_t *sub)
@@ -561,7 +573,7 @@ namespace swrenderer
 				Fake3DOpaque::Normal,
 				0);
 
-			ceilingplane->AddLights(Thread, sub->section->lighthead);
+			ceilingplane->AddLights(Thread, sub->section->lights);
 		}
 
 		int adjusted_floorlightlevel = floorlightlevel;
@@ -601,7 +613,7 @@ namespace swrenderer
 				Fake3DOpaque::Normal,
 				0);
 
-			floorplane->AddLights(Thread, sub->section->lighthead);
+			floorplane->AddLights(Thread, sub->section->lights);
 		}
 
 		Add3DFloorPlanes(sub, frontsector, basecolormap, foggy, adjusted_ceilinglightlevel, adjusted_floorlightlevel);
@@ -612,7 +624,7 @@ namespace swrenderer
 		if ((unsigned int)(sub->Index()) < Level->subsectors.Size())
 		{ // Only do it for the main BSP.
 			int lightlevel = (floorlightlevel + ceilinglightlevel) / 2;
-			for (int i = frontsector->Level->ParticlesInSubsec[sub->Index()]; i != NO_PARTICLE; i = frontsector->Level->Particles[i].snext)
+			for (uint32_t i = frontsector->Level->ParticlesInSubsec[sub->Index()]; i != NO_PARTICLE; i = frontsector->Level->Particles[i].snext)
 			{
 				RenderParticle::Project(Thread, &frontsector->Level->Particles[i], sub->sector, lightlevel, FakeSide, foggy);
 			}
@@ -738,7 +750,7 @@ namespace swrenderer
 						Fake3DOpaque::FakeFloor,
 						fakeAlpha);
 
-					floorplane3d->AddLights(Thread, sub->section->lighthead);
+					floorplane3d->AddLights(Thread, sub->section->lights);
 
 					FakeDrawLoop(sub, &tempsec, floorplane3d, nullptr, Fake3DOpaque::FakeFloor);
 				}
@@ -806,7 +818,7 @@ namespace swrenderer
 						Fake3DOpaque::FakeCeiling,
 						fakeAlpha);
 
-					ceilingplane3d->AddLights(Thread, sub->section->lighthead);
+					ceilingplane3d->AddLights(Thread, sub->section->lights);
 
 					FakeDrawLoop(sub, &tempsec, nullptr, ceilingplane3d, Fake3DOpaque::FakeCeiling);
 				}
@@ -815,7 +827,7 @@ namespace swrenderer
 		}
 	}
 
-	void RenderOpaquePass::RenderScene(FLevelLocals *Level)
+	void RenderOpaquePass::RenderScene(FLevelLocals *Level, const std::vector<SharedBSPEntry> *sharedbsp)
 	{
 		if (Thread->MainThread)
 			WallCycles.Clock();
@@ -829,17 +841,51 @@ namespace swrenderer
 		SeenActors.clear();
 
 		InSubsector = nullptr;
-		RenderBSPNode(Level->HeadNode());	// The head node is the last node output.
+		if (sharedbsp)
+			RenderSharedBSP(*sharedbsp);
+		else
+			RenderBSPNode(Level->HeadNode());	// The head node is the last node output.
 
 		if (Thread->MainThread)
 			WallCycles.Unclock();
 	}
 
+	//
+	// TraverseBSP
+	// Walks the BSP front to back as seen from the view point. The visitor gets every
+	// subsector in order. Back sides are only entered if the visitor's EnterBack
+	// returns a value >= 0, which is passed to LeaveBack once the back side is done.
+
+	template<class Visitor>
+	void RenderOpaquePass::TraverseBSP(void *node, Visitor &visitor)
+	{
+		if ((size_t)node & 1)
+		{
+			visitor.Subsector((subsector_t *)((uint8_t *)node - 1));
+			return;
+		}
+
+		node_t *bsp = (node_t *)node;
+
+		// Decide which side the view point is on.
+		int side = R_PointOnSide(Thread->Viewport->viewpoint.Pos.XY(), bsp);
+
+		// Recursively divide front space (toward the viewer).
+		TraverseBSP(bsp->children[side], visitor);
+
+		// Possibly divide back space (away from the viewer).
+		side ^= 1;
+		int token = visitor.EnterBack(bsp->bbox[side]);
+		if (token >= 0)
+		{
+			TraverseBSP(bsp->children[side], visitor);
+			visitor.LeaveBack(token);
+		}
+	}
+
 	//
 	// RenderBSPNode
 	// Renders all subsectors below a given node, traversing subtree recursively.
-	// Just call with BSP root and -1.
-	// killough 5/2/98: reformatted, removed tail recursion
 
 	void RenderOpaquePass::RenderBSPNode(void *node)
 	{
@@ -848,24 +894,80 @@ namespace swrenderer
 			RenderSubsector(&Thread->Viewport->Level()->subsectors[0]);
 			return;
 		}
-		while (!((size_t)node & 1))  // Keep going until found a subsector
+
+		struct RenderVisitor
 		{
-			node_t *bsp = (node_t *)node;
+			RenderOpaquePass *Pass;
+			void Subsector(subsector_t *sub) { Pass->RenderSubsector(sub); }
+			int EnterBack(float *bbox) { return Pass->CheckBBox(bbox) ? 0 : -1; }
+			void LeaveBack(int token) { }
+		} visitor = { this };
+		TraverseBSP(node, visitor);
+	}
 
-			// Decide which side the view point is on.
-			int side = R_PointOnSide(Thread->Viewport->viewpoint.Pos.XY(), bsp);
+	// Flattens the main view's BSP traversal into a list that all slice threads can share.
+	// Only the frustum tests are done here since they are the same for every thread.
+	// The occlusion tests depend on each thread's clip segments and are left as
+	// check entries in the list.
+	void RenderOpaquePass::BuildSharedBSP(FLevelLocals *Level, std::vector<SharedBSPEntry> &list)
+	{
+		list.clear();
+		if (Level->nodes.Size() == 0)
+		{
+			list.push_back({ &Level->subsectors[0], 0, 0, 0 });
+			return;
+		}
 
-			// Recursively divide front space (toward the viewer).
-			RenderBSPNode(bsp->children[side]);
+		struct ListVisitor
+		{
+			RenderOpaquePass *Pass;
+			std::vector<SharedBSPEntry> &List;
 
-			// Possibly divide back space (away from the viewer).
-			side ^= 1;
-			if (!CheckBBox(bsp->bbox[side]))
-				return;
+			void Subsector(subsector_t *sub) { List.push_back({ sub, 0, 0, 0 }); }
 
-			node = bsp->children[side];
+			int EnterBack(float *bbox)
+			{
+				int sx1, sx2;
+				switch (Pass->ProjectBBox(bbox, false, sx1, sx2))
+				{
+				case BBoxVisibility::Outside:
+					return -1;
+				case BBoxVisibility::Always:
+					return 0;
+				default:
+					List.push_back({ nullptr, sx1, sx2, 0 });
+					return (int)List.size();
+				}
+			}
+
+			void LeaveBack(int token)
+			{
+				if (token > 0) List[token - 1].skip = (uint32_t)List.size();
+			}
+		} visitor = { this, list };
+		TraverseBSP(Level->HeadNode(), visitor);
+	}
+
+	void RenderOpaquePass::RenderSharedBSP(const std::vector<SharedBSPEntry> &list)
+	{
+		size_t i = 0;
+		while (i < list.size())
+		{
+			const SharedBSPEntry &entry = list[i];
+			if (entry.sub)
+			{
+				RenderSubsector(entry.sub);
+				i++;
+			}
+			else if (Thread->ClipSegments->IsVisible(entry.sx1, entry.sx2))
+			{
+				i++;
+			}
+			else
+			{
+				i = entry.skip;
+			}
 		}
-		RenderSubsector((subsector_t *)((uint8_t *)node - 1));
 	}
 
 	void RenderOpaquePass::ClearClip()
@@ -58,13 +58,30 @@ namespace swrenderer
 		int renderflags;
 	};
 
+	// One step of the main view's front-to-back BSP traversal. The list is built once per frame
+	// and then walked read-only by all render threads.
+	struct SharedBSPEntry
+	{
+		subsector_t *sub;	// Subsector to render, or nullptr for a back side visibility check
+		int sx1, sx2;		// Screen columns covered by the back side's bounding box
+		uint32_t skip;		// Where to continue if the back side is occluded
+	};
+
+	enum class BBoxVisibility
+	{
+		Outside,	// Not in the view frustum
+		Always,		// Viewer is inside or right on the edge of the box
+		Columns		// Visible if any column between sx1 and sx2 is still open
+	};
+
 	class RenderOpaquePass
 	{
 	public:
 		RenderOpaquePass(RenderThread *thread);
 
 		void ClearClip();
-		void RenderScene(FLevelLocals *Level);
+		void RenderScene(FLevelLocals *Level, const std::vector<SharedBSPEntry> *sharedbsp = nullptr);
+		void BuildSharedBSP(FLevelLocals *Level, std::vector<SharedBSPEntry> &list);
 
 		void ResetFakingUnderwater() { r_fakingunderwater = false; }
 		sector_t *FakeFlat(sector_t *sec, sector_t *tempsec, int *floorlightlevel, int *ceilinglightlevel, seg_t *backline, int backx1, int backx2, double frontcz1, double frontcz2);
@@ -79,9 +96,12 @@ namespace swrenderer
 		RenderThread *Thread = nullptr;
 
 	private:
+		template<class Visitor> void TraverseBSP(void *node, Visitor &visitor);
 		void RenderBSPNode(void *node);
+		void RenderSharedBSP(const std::vector<SharedBSPEntry> &list);
 		void RenderSubsector(subsector_t *sub);
 		bool CheckBBox(float *bspcoord);
+		BBoxVisibility ProjectBBox(float *bspcoord, bool xflip, int &sx1, int &sx2);
 
 		void AddPolyobjs(subsector_t *sub);
 
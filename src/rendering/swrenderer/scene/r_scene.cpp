@@ -63,6 +63,7 @@ EXTERN_CVAR(Int, r_clearbuffer)
 EXTERN_CVAR(Int, r_debug_draw)
 
 CVAR(Int, r_scene_multithreaded, 1, 0);
+CVAR(Bool, r_scene_sharedbsp, false, 0);
 CVAR(Bool, r_models, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 
 namespace swrenderer
@@ -195,6 +196,15 @@ namespace swrenderer
 			Threads[i]->X1 = viewwidth * i / numThreads;
 			Threads[i]->X2 = viewwidth * (i + 1) / numThreads;
 		}
+
+		// Do the frustum culling part of the BSP traversal once for all slices
+		UseSharedBSP = r_scene_sharedbsp && numThreads > 1;
+		if (UseSharedBSP)
+		{
+			WallCycles.Clock();
+			MainThread()->OpaquePass->BuildSharedBSP(MainThread()->Viewport->Level(), SharedBSP);
+			WallCycles.Unclock();
+		}
 		run_id++;
 		FSoftwareTexture::CurrentUpdate = run_id;
 		start_lock.unlock();
@@ -247,7 +257,7 @@ namespace swrenderer
 		if (thread->X2 < viewwidth)
 			thread->ClipSegments->Clip(thread->X2, viewwidth, true, &visitor);
 
-		thread->OpaquePass->RenderScene(thread->Viewport->Level());
+		thread->OpaquePass->RenderScene(thread->Viewport->Level(), UseSharedBSP ? &SharedBSP : nullptr);
 		thread->Clip3D->ResetClip(); // reset clips (floor/ceiling)
 
 		if (viewactive)
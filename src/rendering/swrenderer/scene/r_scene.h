@@ -37,6 +37,7 @@ namespace swrenderer
 	extern cycle_t WallCycles, PlaneCycles, MaskedCycles, DrawerWaitCycles;
 
 	class RenderThread;
+	struct SharedBSPEntry;
 	
 	class RenderScene
 	{
@@ -75,5 +76,8 @@ namespace swrenderer
 		std::mutex end_mutex;
 		std::condition_variable end_condition;
 		size_t finished_threads = 0;
+
+		std::vector<SharedBSPEntry> SharedBSP;
+		bool UseSharedBSP = false;
 	};
 }
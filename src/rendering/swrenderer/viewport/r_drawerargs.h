@@ -12,7 +12,6 @@
 #include "swrenderer/scene/r_light.h"
 
 struct FSWColormap;
-struct FLightNode;
 
 namespace swrenderer
 {
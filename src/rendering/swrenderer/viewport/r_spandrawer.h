@@ -4,7 +4,6 @@
 #include "r_drawerargs.h"
 
 struct FSWColormap;
-struct FLightNode;
 
 namespace swrenderer
 {
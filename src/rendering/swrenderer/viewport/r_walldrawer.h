@@ -5,7 +5,6 @@
 #include "swrenderer/line/r_wallsetup.h"
 
 struct FSWColormap;
-struct FLightNode;
 
 namespace swrenderer
 {
@@ -31,7 +30,7 @@ namespace swrenderer
 		short* dwal;
 		FWallCoords WallC;
 		ProjectedWallTexcoords texcoords;
-		FLightNode* lightlist = nullptr;
+		FLightList lightlist = {};
 
 		float lightpos;
 		float lightstep;
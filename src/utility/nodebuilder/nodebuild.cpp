@@ -40,14 +40,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <atomic>
 
 #include "doomdata.h"
 #include "nodebuild.h"
+#include "ctpl.h"
 
 const int MaxSegs = 64;
 const int SplitCost = 8;
 const int AAPreference = 16;
 
+// Scoring is only spread over threads when the builder and the set are big
+// enough to pay for the synchronization.
+const unsigned int MinParallelSegs = 4096;
+const uint64_t MinParallelWork = 1 << 18;	// candidates * segs in set
+const unsigned int SplitterBatch = 4;
+
 #if 0
 #define D(x) x
 #else
@@ -55,7 +63,7 @@ const int AAPreference = 16;
 #endif
 
 FNodeBuilder::FNodeBuilder(FLevel &lev)
-: Level(lev), GLNodes(false), SegsStuffed(0)
+: SplitterPool(NULL), Level(lev), GLNodes(false), SegsStuffed(0)
 {
 	VertexMap = NULL;
 	OldVertexTable = NULL;
@@ -63,15 +71,25 @@ FNodeBuilder::FNodeBuilder(FLevel &lev)
 
 FNodeBuilder::FNodeBuilder (FLevel &lev,
 							TArray<FPolyStart> &polyspots, TArray<FPolyStart> &anchors,
-							bool makeGLNodes)
-	: Level(lev), GLNodes(makeGLNodes), SegsStuffed(0)
+							bool makeGLNodes, int threads)
+	: SplitterPool(NULL), Level(lev), GLNodes(makeGLNodes), SegsStuffed(0)
 {
 	VertexMap = new FVertexMap (*this, Level.MinX, Level.MinY, Level.MaxX, Level.MaxY);
 	FindUsedVertices (Level.Vertices, Level.NumVertices);
 	MakeSegsFromSides ();
 	FindPolyContainers (polyspots, anchors);
 	GroupSegPlanes ();
+	if (threads > 1 && Segs.Size() >= MinParallelSegs)
+	{
+		// The calling thread scores splitters, too.
+		SplitterPool = new ctpl::thread_pool (threads - 1);
+	}
 	BuildTree ();
+	if (SplitterPool != NULL)
+	{
+		delete SplitterPool;
+		SplitterPool = NULL;
+	}
 }
 
 FNodeBuilder::~FNodeBuilder()
@@ -428,7 +446,7 @@ bool FNodeBuilder::ShoveSegBehind (uint32_t set, node_t &node, uint32_t seg, uin
 		node.dx = -node.dx;
 		node.dy = -node.dy;
 	}
-	return Heuristic (node, set, false) > 0;
+	return Heuristic (node, set, false, Touched, Colinear) > 0;
 }
 
 // Splitters are chosen to coincide with segs in the given set. To reduce the
@@ -438,12 +456,18 @@ bool FNodeBuilder::ShoveSegBehind (uint32_t set, node_t &node, uint32_t seg, uin
 // each unique plane needs to be considered as a splitter. A result of 0 means
 // this set is a convex region. A result of -1 means that there were possible
 // splitters, but they all split segs we want to keep intact.
+//
+// Which segs get tried only depends on their planes, not on the scores, so
+// the candidates are collected first and scored by ScoreSplitters. Picking
+// the best one afterwards in candidate order keeps the result the same no
+// matter how the scoring was spread over threads.
 int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg, int step, bool nosplit)
 {
 	int stepleft;
 	int bestvalue;
 	uint32_t bestseg;
 	uint32_t seg;
+	unsigned int segsInSet = 0;
 	bool nosplitters = false;
 
 	bestvalue = 0;
@@ -453,6 +477,7 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 	stepleft = 0;
 
 	memset (&PlaneChecked[0], 0, PlaneChecked.Size());
+	SplitterCandidates.Clear();
 
 	D(Printf (PRINT_LOG, "Processing set %d\n", set));
 
@@ -473,28 +498,36 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 				}
 
 				stepleft = step;
-				SetNodeFromSeg (node, pseg);
-
-				int value = Heuristic (node, set, nosplit);
-
-				D(Printf (PRINT_LOG, "Seg %5d, ld %d (%5d,%5d)-(%5d,%5d) scores %d\n", seg, Segs[seg].linedef, node.x>>16, node.y>>16,
-					(node.x+node.dx)>>16, (node.y+node.dy)>>16, value));
-
-				if (value > bestvalue)
-				{
-					bestvalue = value;
-					bestseg = seg;
-				}
-				else if (value < 0)
-				{
-					nosplitters = true;
-				}
+				SplitterCandidates.Push (seg);
 			}
 		}
 
+		segsInSet++;
 		seg = pseg->next;
 	}
 
+	ScoreSplitters (set, segsInSet, nosplit);
+
+	for (unsigned int i = 0; i < SplitterCandidates.Size(); ++i)
+	{
+		int value = SplitterScores[i];
+
+		seg = SplitterCandidates[i];
+		D(SetNodeFromSeg (node, &Segs[seg]));
+		D(Printf (PRINT_LOG, "Seg %5d, ld %d (%5d,%5d)-(%5d,%5d) scores %d\n", seg, Segs[seg].linedef, node.x>>16, node.y>>16,
+			(node.x+node.dx)>>16, (node.y+node.dy)>>16, value));
+
+		if (value > bestvalue)
+		{
+			bestvalue = value;
+			bestseg = seg;
+		}
+		else if (value < 0)
+		{
+			nosplitters = true;
+		}
+	}
+
 	if (bestseg == UINT_MAX)
 	{
 		// No lines split any others into two sets, so this is a convex region.
@@ -509,13 +542,67 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 	return 1;
 }
 
+// Fills SplitterScores with the Heuristic of every seg in SplitterCandidates.
+// Heuristic only reads the builder's state, so the candidates can be scored
+// concurrently as long as every thread has its own Touched and Colinear lists.
+void FNodeBuilder::ScoreSplitters (uint32_t set, unsigned int segsInSet, bool nosplit)
+{
+	unsigned int count = SplitterCandidates.Size();
+	SplitterScores.Resize (count);
+
+	if (SplitterPool == NULL || count < 2 || (uint64_t)count * segsInSet < MinParallelWork)
+	{
+		node_t node;
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			SetNodeFromSeg (node, &Segs[SplitterCandidates[i]]);
+			SplitterScores[i] = Heuristic (node, set, nosplit, Touched, Colinear);
+		}
+		return;
+	}
+
+	// Scores vary a lot in cost because Heuristic gives up early on bad
+	// splitters, so the candidates are handed out in small batches.
+	std::atomic<unsigned int> next (0);
+	auto worker = [&](TArray<int> &touched, TArray<int> &colinear)
+	{
+		node_t node;
+		unsigned int first;
+		while ((first = next.fetch_add (SplitterBatch)) < count)
+		{
+			unsigned int last = min (first + SplitterBatch, count);
+			for (unsigned int i = first; i < last; ++i)
+			{
+				SetNodeFromSeg (node, &Segs[SplitterCandidates[i]]);
+				SplitterScores[i] = Heuristic (node, set, nosplit, touched, colinear);
+			}
+		}
+	};
+
+	int helpers = min<int>(SplitterPool->size(), (count - 1) / SplitterBatch);
+	std::vector<std::future<void>> futures;
+	for (int i = 0; i < helpers; ++i)
+	{
+		futures.push_back (SplitterPool->push ([&](int)
+		{
+			TArray<int> touched, colinear;
+			worker (touched, colinear);
+		}));
+	}
+	worker (Touched, Colinear);
+	for (auto &future : futures)
+	{
+		future.wait ();
+	}
+}
+
 // Given a splitter (node), returns a score based on how "good" the resulting
 // split in a set of segs is. Higher scores are better. -1 means this splitter
 // splits something it shouldn't and will only be returned if honorNoSplit is
 // true. A score of 0 means that the splitter does not split any of the segs
 // in the set.
 
-int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
+int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit, TArray<int> &touched, TArray<int> &colinear)
 {
 	// Set the initial score above 0 so that near vertex anti-weighting is less likely to produce a negative score.
 	int score = 1000000;
@@ -530,8 +617,8 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 	unsigned int max, m2, p, q;
 	double frac;
 
-	Touched.Clear ();
-	Colinear.Clear ();
+	touched.Clear ();
+	colinear.Clear ();
 
 	while (i != UINT_MAX)
 	{
@@ -557,32 +644,32 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 			{
 				if ((sidev[0] | sidev[1]) != 0)
 				{
-					max = Touched.Size();
+					max = touched.Size();
 					for (p = 0; p < max; ++p)
 					{
-						if (Touched[p] == test->loopnum)
+						if (touched[p] == test->loopnum)
 						{
 							break;
 						}
 					}
 					if (p == max)
 					{
-						Touched.Push (test->loopnum);
+						touched.Push (test->loopnum);
 					}
 				}
 				else
 				{
-					max = Colinear.Size();
+					max = colinear.Size();
 					for (p = 0; p < max; ++p)
 					{
-						if (Colinear[p] == test->loopnum)
+						if (colinear[p] == test->loopnum)
 						{
 							break;
 						}
 					}
 					if (p == max)
 					{
-						Colinear.Push (test->loopnum);
+						colinear.Push (test->loopnum);
 					}
 				}
 			}
@@ -699,8 +786,8 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 	// seg of that sector must be crossing the container's corner and does not
 	// actually split the container.
 
-	max = Touched.Size ();
-	m2 = Colinear.Size ();
+	max = touched.Size ();
+	m2 = colinear.Size ();
 
 	// If honorNoSplit is false, then both these lists will be empty.
 
@@ -713,10 +800,10 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 
 	for (p = 0; p < max; ++p)
 	{
-		int look = Touched[p];
+		int look = touched[p];
 		for (q = 0; q < m2; ++q)
 		{
-			if (look == Colinear[q])
+			if (look == colinear[q])
 			{
 				break;
 			}
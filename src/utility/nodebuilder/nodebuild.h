@@ -44,6 +44,12 @@
 struct FPolySeg;
 struct FMiniBSP;
 struct FLevelLocals;
+namespace ctpl { class thread_pool; }
+
+// x64 and SSE2-enabled x86 builds classify both vertices of a seg at once.
+#if !defined(NO_SSE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NODEBUILD_SSE2
+#endif
 
 struct FEventInfo
 {
@@ -229,13 +235,16 @@ public:
 	};
 
 	FNodeBuilder (FLevel &lev);
+	// With threads > 1, splitters for large sets are scored on that many threads.
+	// The output is the same as with a single thread.
 	FNodeBuilder (FLevel &lev,
 		TArray<FPolyStart> &polyspots, TArray<FPolyStart> &anchors,
-		bool makeGLNodes);
+		bool makeGLNodes, int threads = 1);
 	~FNodeBuilder ();
 
 	void Extract(FLevelLocals &lev);
 	const int *GetOldVertexTable();
+	uint64_t GetChecksum() const;
 
 	// These are used for building sub-BSP trees for polyobjects.
 	void Clear();
@@ -267,6 +276,9 @@ private:
 
 	TArray<int> Touched;	// Loops a splitter touches on a vertex
 	TArray<int> Colinear;	// Loops with edges colinear to a splitter
+	TArray<uint32_t> SplitterCandidates;	// Segs SelectSplitter wants scored
+	TArray<int> SplitterScores;			// Their scores, in the same order
+	ctpl::thread_pool *SplitterPool;		// Helpers for scoring, or NULL for single-threaded builds
 	FEventTree Events;		// Vertices intersected by the current splitter
 
 	TArray<uint32_t> UnsetSegs;			// Segs with no definitive side in current splitter
@@ -297,10 +309,11 @@ private:
 	bool CheckSubsectorOverlappingSegs (uint32_t set, node_t &node, uint32_t &splitseg);
 	bool ShoveSegBehind (uint32_t set, node_t &node, uint32_t seg, uint32_t mate);
 	int SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg, int step, bool nosplit);
+	void ScoreSplitters (uint32_t set, unsigned int segsInSet, bool nosplit);
 	void DoGLSegSplit (uint32_t set, node_t &node, uint32_t splitseg, uint32_t &outset0, uint32_t &outset1, int side, int sidev0, int sidev1, bool hack);
 	void SplitSegs (uint32_t set, node_t &node, uint32_t splitseg, uint32_t &outset0, uint32_t &outset1, unsigned int &count0, unsigned int &count1);
 	uint32_t SplitSeg (uint32_t segnum, int splitvert, int v1InFront);
-	int Heuristic (node_t &node, uint32_t set, bool honorNoSplit);
+	int Heuristic (node_t &node, uint32_t set, bool honorNoSplit, TArray<int> &touched, TArray<int> &colinear);
 
 	// Returns:
 	//	0 = seg is in front
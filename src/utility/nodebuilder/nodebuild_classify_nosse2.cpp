@@ -1,6 +1,8 @@
 #include "doomtype.h"
 #include "nodebuild.h"
 
+#ifndef NODEBUILD_SSE2
+
 #define FAR_ENOUGH 17179869184.f		// 4<<32
 
 int FNodeBuilder::ClassifyLine(node_t &node, const FPrivVert *v1, const FPrivVert *v2, int sidev[2])
@@ -134,3 +136,5 @@ int FNodeBuilder::ClassifyLine(node_t &node, const FPrivVert *v1, const FPrivVer
 	}
 	return -1;
 }
+
+#endif
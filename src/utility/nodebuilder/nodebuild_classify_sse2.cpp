@@ -0,0 +1,83 @@
+#include "doomtype.h"
+#include "nodebuild.h"
+
+#ifdef NODEBUILD_SSE2
+
+#include <emmintrin.h>
+
+#define FAR_ENOUGH 17179869184.f		// 4<<32
+
+// Same as the version in nodebuild_classify_nosse2.cpp, but both vertices
+// go through the same SSE2 lanes. The arithmetic is done in the same order,
+// so the results are identical.
+
+int FNodeBuilder::ClassifyLine(node_t &node, const FPrivVert *v1, const FPrivVert *v2, int sidev[2])
+{
+	double d_dx = double(node.dx);
+	double d_dy = double(node.dy);
+
+	__m128d x1 = _mm_set1_pd(double(node.x));
+	__m128d y1 = _mm_set1_pd(double(node.y));
+	__m128d dx = _mm_set1_pd(d_dx);
+	__m128d dy = _mm_set1_pd(d_dy);
+	__m128d xv = _mm_set_pd(double(v2->x), double(v1->x));
+	__m128d yv = _mm_set_pd(double(v2->y), double(v1->y));
+
+	__m128d s_num = _mm_sub_pd(_mm_mul_pd(_mm_sub_pd(y1, yv), dx), _mm_mul_pd(_mm_sub_pd(x1, xv), dy));
+
+	// Bit 0 is for v1, bit 1 for v2.
+	int far = _mm_movemask_pd(_mm_cmple_pd(s_num, _mm_set1_pd(-FAR_ENOUGH))) |
+		_mm_movemask_pd(_mm_cmpge_pd(s_num, _mm_set1_pd(FAR_ENOUGH)));
+	int front = _mm_movemask_pd(_mm_cmpgt_pd(s_num, _mm_setzero_pd()));
+	int online = 0;
+
+	if (far != 3)
+	{
+		double l = 1.f / (d_dx*d_dx + d_dy*d_dy);
+		__m128d dist = _mm_mul_pd(_mm_mul_pd(s_num, s_num), _mm_set1_pd(l));
+		online = _mm_movemask_pd(_mm_cmplt_pd(dist, _mm_set1_pd(SIDE_EPSILON*SIDE_EPSILON))) & ~far;
+	}
+
+	sidev[0] = (online & 1) ? 0 : (front & 1) ? -1 : 1;
+	sidev[1] = (online & 2) ? 0 : (front & 2) ? -1 : 1;
+
+	if ((sidev[0] | sidev[1]) == 0)
+	{ // seg is coplanar with the splitter, so use its orientation to determine
+	  // which child it ends up in. If it faces the same direction as the splitter,
+	  // it goes in front. Otherwise, it goes in back.
+
+		if (node.dx != 0)
+		{
+			if ((node.dx > 0 && v2->x > v1->x) || (node.dx < 0 && v2->x < v1->x))
+			{
+				return 0;
+			}
+			else
+			{
+				return 1;
+			}
+		}
+		else
+		{
+			if ((node.dy > 0 && v2->y > v1->y) || (node.dy < 0 && v2->y < v1->y))
+			{
+				return 0;
+			}
+			else
+			{
+				return 1;
+			}
+		}
+	}
+	else if (sidev[0] <= 0 && sidev[1] <= 0)
+	{
+		return 0;
+	}
+	else if (sidev[0] >= 0 && sidev[1] >= 0)
+	{
+		return 1;
+	}
+	return -1;
+}
+
+#endif
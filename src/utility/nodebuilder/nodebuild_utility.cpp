@@ -113,6 +113,42 @@ const int *FNodeBuilder::GetOldVertexTable()
 	return table;
 }
 
+// Hashes the built tree before Extract turns it into level data, so that
+// builds with different settings can be checked for identical output.
+
+uint64_t FNodeBuilder::GetChecksum() const
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	auto add = [&](int64_t v) { hash = (hash ^ uint64_t(v)) * 0x100000001b3ull; };
+
+	for (auto &node : Nodes)
+	{
+		add (node.x); add (node.y); add (node.dx); add (node.dy);
+		for (int i = 0; i < 4; ++i)
+		{
+			add (node.nb_bbox[0][i]); add (node.nb_bbox[1][i]);
+		}
+		add (node.intchildren[0]); add (node.intchildren[1]);
+	}
+	for (auto &sub : Subsectors)
+	{
+		add ((int64_t)(size_t)sub.firstline); add (sub.numlines);
+	}
+	for (auto &ptr : SegList)
+	{
+		add (ptr.SegNum);
+	}
+	for (auto &seg : Segs)
+	{
+		add (seg.v1); add (seg.v2); add (seg.linedef); add (seg.sidedef); add (seg.partner);
+	}
+	for (auto &vert : Vertices)
+	{
+		add (vert.x); add (vert.y);
+	}
+	return hash;
+}
+
 // For every sidedef in the map, create a corresponding seg.
 
 void FNodeBuilder::MakeSegsFromSides ()